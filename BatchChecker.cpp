@@ -0,0 +1,232 @@
+// Copyright 2022 Henrik Roth
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "./BatchChecker.h"
+#include "./Variant.h"
+
+namespace {
+// Input that is checked at once, and the least input a thread gets.
+constexpr size_t kBlockSize = 4 << 20;
+constexpr size_t kMinPieceSize = 64 << 10;
+
+// Return true if c separates the guess from the answer of a record.
+bool isSeparator(char c) { return c == ' ' || c == '\t' || c == ','; }
+
+// Write size bytes at data to the file descriptor fd. Return false on error.
+bool writeAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) { continue; }
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+}  // namespace
+
+// ____________________________________________________________________________
+BatchChecker::BatchChecker(ThreadPool* pool) : pool_(pool), numRecords_(0) {}
+
+// ____________________________________________________________________________
+size_t BatchChecker::checkRecord(const char* line, size_t length, char* out) {
+  while (length > 0 && (line[length - 1] == '\r'
+                        || isSeparator(line[length - 1]))) {
+    --length;
+  }
+  size_t guessLength = 0;
+  while (guessLength < length && !isSeparator(line[guessLength])) {
+    ++guessLength;
+  }
+  const char* answer = line + guessLength;
+  const char* end = line + length;
+  while (answer < end && isSeparator(*answer)) { ++answer; }
+
+  const VariantRules* rules = VariantRules::forLength(guessLength);
+  const bool syntactic = rules != nullptr && rules->isSyntactic(line);
+  const bool correct = syntactic && rules->isCorrect(line);
+  memcpy(out, line, guessLength);
+  char* pos = out + guessLength;
+  *pos++ = ' ';
+  *pos++ = syntactic ? '1' : '0';
+  *pos++ = ' ';
+  *pos++ = correct ? '1' : '0';
+  *pos++ = ' ';
+  if (rules != nullptr && static_cast<size_t>(end - answer) == guessLength) {
+    rules->compare(line, answer, pos);
+    pos += guessLength;
+  } else {
+    *pos++ = '-';
+  }
+  *pos++ = '\n';
+  return pos - out;
+}
+
+// ____________________________________________________________________________
+size_t BatchChecker::checkPieces(const char* data, size_t size) {
+  const size_t numPieces = std::max<size_t>(1, std::min<size_t>(
+      4 * pool_->numThreads(), size / kMinPieceSize));
+  // Pieces start after the first line break at or after an even split.
+  std::vector<size_t> begins(numPieces + 1, size);
+  begins[0] = 0;
+  for (size_t i = 1; i < numPieces; ++i) {
+    const size_t split = std::max(begins[i - 1], size * i / numPieces);
+    const void* lineEnd = memchr(data + split, '\n', size - split);
+    begins[i] = lineEnd == nullptr
+        ? size : static_cast<const char*>(lineEnd) - data + 1;
+  }
+  if (pieceOutput_.size() < numPieces) {
+    pieceOutput_.resize(numPieces);
+    pieceLength_.resize(numPieces);
+    pieceRecords_.resize(numPieces);
+  }
+
+  pool_->parallelFor(numPieces, 1, [&](size_t first, size_t last) {
+    for (size_t piece = first; piece < last; ++piece) {
+      const char* line = data + begins[piece];
+      const char* end = data + begins[piece + 1];
+      // Every record takes at least 2 bytes of input but the last one, so
+      // the output takes at most 5 bytes per input byte.
+      std::vector<char>& output = pieceOutput_[piece];
+      const size_t bound = 5 * (end - line) + 7;
+      if (output.size() < bound) { output.resize(bound); }
+      char* out = output.data();
+      size_t numRecords = 0;
+      while (line < end) {
+        const char* lineEnd = static_cast<const char*>(
+            memchr(line, '\n', end - line));
+        if (lineEnd == nullptr) { lineEnd = end; }
+        if (lineEnd > line && !(lineEnd == line + 1 && *line == '\r')) {
+          out += checkRecord(line, lineEnd - line, out);
+          ++numRecords;
+        }
+        line = lineEnd + 1;
+      }
+      pieceLength_[piece] = out - output.data();
+      pieceRecords_[piece] = numRecords;
+    }
+  });
+
+  size_t numRecords = 0;
+  for (size_t i = 0; i < numPieces; ++i) { numRecords += pieceRecords_[i]; }
+  // Pieces that were not used this time have no output.
+  for (size_t i = numPieces; i < pieceLength_.size(); ++i) {
+    pieceLength_[i] = 0;
+  }
+  numRecords_ += numRecords;
+  return numRecords;
+}
+
+// ____________________________________________________________________________
+size_t BatchChecker::check(const char* data, size_t size,
+                           std::vector<char>* out) {
+  const size_t numRecords = checkPieces(data, size);
+  for (size_t i = 0; i < pieceOutput_.size(); ++i) {
+    out->insert(out->end(), pieceOutput_[i].data(),
+                pieceOutput_[i].data() + pieceLength_[i]);
+  }
+  return numRecords;
+}
+
+// ____________________________________________________________________________
+int64_t BatchChecker::checkAndWrite(const char* data, size_t size,
+                                    bool final, int outFd) {
+  size_t begin = 0;
+  while (begin < size) {
+    // Blocks end after a line break, or with the input if it is final.
+    size_t end = std::min(size, begin + kBlockSize);
+    const void* lineEnd = memrchr(data + begin, '\n', end - begin);
+    if (lineEnd == nullptr) {
+      // a line longer than a block
+      lineEnd = memchr(data + end, '\n', size - end);
+    }
+    if (lineEnd != nullptr) {
+      end = static_cast<const char*>(lineEnd) - data + 1;
+    } else if (final) {
+      end = size;
+    } else {
+      break;
+    }
+    checkPieces(data + begin, end - begin);
+    for (size_t i = 0; i < pieceOutput_.size(); ++i) {
+      if (!writeAll(outFd, pieceOutput_[i].data(), pieceLength_[i])) {
+        return -1;
+      }
+    }
+    begin = end;
+  }
+  return begin;
+}
+
+// ____________________________________________________________________________
+bool BatchChecker::checkFile(const char* path, int outFd) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) { return false; }
+  struct stat status;
+  if (fstat(fd, &status) != 0) {
+    close(fd);
+    return false;
+  }
+  // Pipes and terminals can't be mapped.
+  if (!S_ISREG(status.st_mode)) {
+    const bool checked = checkStream(fd, outFd);
+    close(fd);
+    return checked;
+  }
+  const size_t size = status.st_size;
+  if (size == 0) {
+    close(fd);
+    return true;
+  }
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) { return false; }
+  madvise(mapped, size, MADV_SEQUENTIAL);
+  const bool checked = checkAndWrite(static_cast<const char*>(mapped), size,
+                                     true, outFd) >= 0;
+  munmap(mapped, size);
+  return checked;
+}
+
+// ____________________________________________________________________________
+bool BatchChecker::checkStream(int inFd, int outFd) {
+  std::vector<char> buffer(kBlockSize);
+  size_t filled = 0;
+  bool atEnd = false;
+  while (!atEnd) {
+    // Fill the buffer completely, so that the threads get large blocks even
+    // if the input comes in small reads.
+    while (filled < buffer.size()) {
+      const ssize_t numRead = read(inFd, buffer.data() + filled,
+                                   buffer.size() - filled);
+      if (numRead < 0) {
+        if (errno == EINTR) { continue; }
+        return false;
+      }
+      if (numRead == 0) {
+        atEnd = true;
+        break;
+      }
+      filled += numRead;
+    }
+    const int64_t consumed = checkAndWrite(buffer.data(), filled, atEnd,
+                                           outFd);
+    if (consumed < 0) { return false; }
+    filled -= consumed;
+    memmove(buffer.data(), buffer.data() + consumed, filled);
+    // a line longer than the buffer
+    if (filled == buffer.size()) { buffer.resize(2 * buffer.size()); }
+  }
+  return true;
+}
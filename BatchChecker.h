@@ -0,0 +1,81 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef BATCHCHECKER_H_
+#define BATCHCHECKER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "./ThreadPool.h"
+
+// Checks guesses that are submitted elsewhere against the rules of the
+// game, one record per line: a guess, optionally followed by a space, tab
+// or comma and the answer of the game. For every record one line is
+// written: the guess, 1 or 0 for whether it is syntactically correct (see
+// Nerdle::isEquationSyntactic) and whether it computes (see
+// Nerdle::isEquationCorrect), and the feedback on the guess as by
+// Nerdle::compareUserGuess, f.e.
+//
+//   48-32=16 11+11=22   ->   48-32=16 1 1 11113231
+//
+// The feedback is "-" if there is no answer or the guess is too short or
+// too long for the variant of the answer. The length of the guess picks
+// the variant (see Variant). Empty lines are skipped.
+//
+// Records are checked in place, without copying them into strings, and in
+// blocks that are split between the threads of a pool. The output keeps
+// the order of the input.
+class BatchChecker {
+ public:
+  // Check with the threads of the given pool.
+  explicit BatchChecker(ThreadPool* pool);
+
+  // Check the record at line (without the line break), write its output
+  // line to out and return the number of characters written. out must
+  // have room for maxOutput(length) characters.
+  static size_t checkRecord(const char* line, size_t length, char* out);
+
+  // Maximal length of the output of a record of the given length.
+  static size_t maxOutput(size_t length) { return 2 * length + 7; }
+
+  // Check the records of the complete lines in [data, data + size), in
+  // parallel, and append their output to out. A last record without a line
+  // break is checked too. Return the number of records.
+  size_t check(const char* data, size_t size, std::vector<char>* out);
+
+  // Check all records of the file at the given path, which is mapped into
+  // memory, and write the output to the file descriptor outFd. Return false
+  // if the file can't be read or the output can't be written.
+  bool checkFile(const char* path, int outFd);
+
+  // Same as above for records read from the file descriptor inFd, f.e. a
+  // pipe, in large blocks.
+  bool checkStream(int inFd, int outFd);
+
+  // Number of records checked so far.
+  size_t numRecords() const { return numRecords_; }
+
+ private:
+  // Check the records in [data, data + size) in pieces, in parallel. The
+  // output of piece i is the first pieceLength_[i] characters of
+  // pieceOutput_[i]. Return the number of records.
+  size_t checkPieces(const char* data, size_t size);
+
+  // Check [data, data + size) in blocks of kBlockSize and write the output
+  // after each one. If final is false, a last record without a line break
+  // is left unchecked. Return the number of bytes consumed or -1 if the
+  // output can't be written.
+  int64_t checkAndWrite(const char* data, size_t size, bool final,
+                        int outFd);
+
+  ThreadPool* pool_;
+  size_t numRecords_;
+
+  // Output of the pieces of the current block. The buffers only grow, so
+  // that they are allocated once for all blocks.
+  std::vector<std::vector<char>> pieceOutput_;
+  std::vector<size_t> pieceLength_;
+  std::vector<size_t> pieceRecords_;
+};
+
+#endif  // BATCHCHECKER_H_
@@ -0,0 +1,79 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "./BatchChecker.h"
+#include "./EquationIndex.h"
+#include "./Random.h"
+#include "./ThreadPool.h"
+
+namespace {
+// Return the output of the given input, checked by a pool of the given
+// number of threads.
+std::string check(const std::string& input, int numThreads) {
+  ThreadPool pool(numThreads);
+  BatchChecker checker(&pool);
+  std::vector<char> out;
+  checker.check(input.data(), input.size(), &out);
+  return std::string(out.begin(), out.end());
+}
+}  // namespace
+
+
+TEST(BatchCheckerTest, checkRecord) {
+  ASSERT_EQ(check("48-32=16 11+11=22\n", 1), "48-32=16 1 1 11113231\n");
+  ASSERT_EQ(check("48-32=16,48-32=16\r\n", 1), "48-32=16 1 1 22222222\n");
+  ASSERT_EQ(check("48-32=17\n", 1), "48-32=17 1 0 -\n");
+  ASSERT_EQ(check("48-32=+6\t11+11=22", 1), "48-32=+6 0 0 11113231\n");
+  ASSERT_EQ(check("4*3=12 1+1=20\n", 1), "4*3=12 1 1 111233\n");
+  ASSERT_EQ(check("4*3=12 11+11=22\n", 1), "4*3=12 1 1 -\n");
+  ASSERT_EQ(check("4*3=1\n", 1), "4*3=1 0 0 -\n");
+  ASSERT_EQ(check("\n\r\n\n", 1), "");
+}
+
+TEST(BatchCheckerTest, order) {
+  // Parallel checks give the same output as serial ones, in input order.
+  const EquationIndex& index = EquationIndex::classic();
+  Random random(3);
+  std::string input;
+  for (int i = 0; i < 100000; ++i) {
+    input += index.equation(random.uniform(index.size()));
+    if (i % 3 == 0) {
+      input += ' ';
+      input += index.equation(random.uniform(index.size()));
+    }
+    input += '\n';
+  }
+  const std::string serial = check(input, 1);
+  ASSERT_EQ(std::count(serial.begin(), serial.end(), '\n'), 100000);
+  ASSERT_EQ(check(input, 4), serial);
+
+  // The same through a pipe, written by another thread.
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  std::thread writer([&]() {
+    for (size_t i = 0; i < input.size(); i += 1000) {
+      ASSERT_GT(write(fds[1], input.data() + i,
+                      std::min<size_t>(1000, input.size() - i)), 0);
+    }
+    close(fds[1]);
+  });
+  FILE* output = tmpfile();
+  ThreadPool pool(4);
+  BatchChecker checker(&pool);
+  ASSERT_TRUE(checker.checkStream(fds[0], fileno(output)));
+  writer.join();
+  close(fds[0]);
+  ASSERT_EQ(checker.numRecords(), 100000u);
+  std::string streamed(serial.size() + 1, '\0');
+  rewind(output);
+  ASSERT_EQ(fread(&streamed[0], 1, streamed.size(), output), serial.size());
+  streamed.resize(serial.size());
+  ASSERT_EQ(streamed, serial);
+  fclose(output);
+}
@@ -0,0 +1,131 @@
+// Copyright 2022 Henrik Roth
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "./CandidateSet.h"
+#include "./Feedback.h"
+
+namespace {
+// Value of a magenta cell in the pattern id, green is twice as much.
+constexpr int kCellWeight[kEquationLength] = {2187, 729, 243, 81, 27, 9, 3, 1};
+
+// Bitset with all bits of equations in [0, size) set.
+std::vector<uint64_t> allOnes(size_t size) {
+  std::vector<uint64_t> bits((size + 63) / 64, ~0ull);
+  if (size % 64 != 0) { bits.back() = (1ull << (size % 64)) - 1; }
+  return bits;
+}
+
+// A bitset to AND into the candidates, negated if flip is all ones.
+struct Constraint {
+  const uint64_t* bits;
+  uint64_t flip;
+};
+}  // namespace
+
+// ____________________________________________________________________________
+CandidateIndex::CandidateIndex(const EquationIndex* equations)
+    : equations_(equations), numWords_((equations->size() + 63) / 64) {
+  bits_.assign(atLeastRow(kNumSymbols, 0) * numWords_, 0);
+  for (size_t e = 0; e < equations->size(); ++e) {
+    const uint64_t bit = 1ull << (e % 64);
+    int count[kNumSymbols] = {0};
+    for (int i = 0; i < kEquationLength; ++i) {
+      const int symbol = PackedEquation::cell(equations->packed(e), i);
+      bits_[atRow(i, symbol) * numWords_ + e / 64] |= bit;
+      ++count[symbol];
+    }
+    for (int symbol = 0; symbol < kNumSymbols; ++symbol) {
+      for (int k = 0; k <= count[symbol]; ++k) {
+        bits_[atLeastRow(symbol, k) * numWords_ + e / 64] |= bit;
+      }
+    }
+  }
+}
+
+// ____________________________________________________________________________
+CandidateSet::CandidateSet(const CandidateIndex* index) : index_(index) {
+  reset();
+}
+
+// ____________________________________________________________________________
+void CandidateSet::reset() {
+  bits_ = allOnes(index_->equations()->size());
+  size_ = index_->equations()->size();
+  undo_.clear();
+}
+
+// ____________________________________________________________________________
+void CandidateSet::apply(uint32_t guess, uint16_t pattern) {
+  undo_.insert(undo_.end(), bits_.begin(), bits_.end());
+
+  // Green cells must hold their symbol, the others must not. A symbol that
+  // is green or magenta in m cells occurs at least m times, exactly m times
+  // if it is also black somewhere.
+  Constraint constraints[3 * kEquationLength];
+  int numConstraints = 0;
+  int symbol[kEquationLength];
+  int color[kEquationLength];
+  for (int i = 0; i < kEquationLength; ++i) {
+    symbol[i] = PackedEquation::cell(guess, i);
+    color[i] = pattern / kCellWeight[i] % 3;
+    constraints[numConstraints++] = {index_->at(i, symbol[i]),
+                                     color[i] == 2 ? 0 : ~0ull};
+  }
+  bool possible = true;
+  for (int i = 0; i < kEquationLength; ++i) {
+    bool firstOccurrence = true;
+    for (int k = 0; k < i; ++k) { firstOccurrence &= symbol[k] != symbol[i]; }
+    if (!firstOccurrence) { continue; }
+    int matched = 0;
+    bool black = false;
+    for (int k = i; k < kEquationLength; ++k) {
+      if (symbol[k] != symbol[i]) { continue; }
+      // Magentas go to the leftmost cells that aren't green, so a magenta
+      // right of a black cell with the same symbol never happens.
+      possible &= !(black && color[k] == 1);
+      matched += color[k] != 0;
+      black |= color[k] == 0;
+    }
+    if (matched > 0) {
+      constraints[numConstraints++] = {index_->atLeast(symbol[i], matched), 0};
+    }
+    if (black) {
+      constraints[numConstraints++] = {
+          index_->atLeast(symbol[i], matched + 1), ~0ull};
+    }
+  }
+
+  size_ = 0;
+  for (size_t w = 0; w < bits_.size(); ++w) {
+    uint64_t word = possible ? bits_[w] : 0;
+    for (int c = 0; c < numConstraints; ++c) {
+      word &= constraints[c].bits[w] ^ constraints[c].flip;
+    }
+    bits_[w] = word;
+    size_ += __builtin_popcountll(word);
+  }
+}
+
+// ____________________________________________________________________________
+void CandidateSet::undo() {
+  if (undo_.empty()) { return; }
+  std::copy(undo_.end() - bits_.size(), undo_.end(), bits_.begin());
+  undo_.resize(undo_.size() - bits_.size());
+  size_ = 0;
+  for (uint64_t word : bits_) { size_ += __builtin_popcountll(word); }
+}
+
+// ____________________________________________________________________________
+std::vector<uint32_t> CandidateSet::positions() const {
+  std::vector<uint32_t> positions;
+  positions.reserve(size_);
+  for (size_t w = 0; w < bits_.size(); ++w) {
+    for (uint64_t word = bits_[w]; word != 0; word &= word - 1) {
+      positions.push_back(w * 64 + __builtin_ctzll(word));
+    }
+  }
+  return positions;
+}
@@ -0,0 +1,90 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef CANDIDATESET_H_
+#define CANDIDATESET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./PackedEquation.h"
+
+// Bitsets over the equations of an index (bit i = equation i) that describe
+// what feedback can tell about an equation: one per cell and symbol (the
+// cell holds the symbol) and one per symbol and count k (the symbol occurs
+// at least k times). Built once, shared by any number of CandidateSets.
+class CandidateIndex {
+ public:
+  // Build the bitsets of the given equations, which must outlive the index.
+  explicit CandidateIndex(const EquationIndex* equations);
+
+  // The equations and the number of 64-bit words per bitset.
+  const EquationIndex* equations() const { return equations_; }
+  size_t numWords() const { return numWords_; }
+
+  // Bitset of the equations with the given symbol code in the given cell.
+  const uint64_t* at(int cell, int symbol) const {
+    return &bits_[atRow(cell, symbol) * numWords_];
+  }
+
+  // Bitset of the equations in which the given symbol code occurs at least
+  // k times, 0 <= k <= kEquationLength + 1.
+  const uint64_t* atLeast(int symbol, int k) const {
+    return &bits_[atLeastRow(symbol, k) * numWords_];
+  }
+
+ private:
+  // Position of the bitsets above among all bitsets.
+  static size_t atRow(int cell, int symbol) {
+    return cell * kNumSymbols + symbol;
+  }
+  static size_t atLeastRow(int symbol, int k) {
+    return kEquationLength * kNumSymbols + symbol * (kEquationLength + 2) + k;
+  }
+
+  const EquationIndex* equations_;
+  size_t numWords_;
+  std::vector<uint64_t> bits_;
+};
+
+// The equations of an index that are still possible answers of a game,
+// as one bitset. Feedback on a guess is applied with a single pass of
+// ANDs and ANDNOTs over the words of the bitset, and can be taken back for
+// backtracking search.
+class CandidateSet {
+ public:
+  // Start with every equation of the given index, which must outlive the
+  // set.
+  explicit CandidateSet(const CandidateIndex* index);
+
+  // Keep only the equations for which the guess gets the given feedback
+  // pattern (see Feedback). The result is the same as comparing the guess
+  // with every candidate, also for patterns no answer can produce.
+  void apply(uint32_t guess, uint16_t pattern);
+
+  // Take back the last apply(). Does nothing if there is none.
+  void undo();
+
+  // Number of applies that can be taken back.
+  size_t depth() const { return undo_.size() / index_->numWords(); }
+
+  // Go back to every equation of the index and forget all applies.
+  void reset();
+
+  // Number of candidates and whether the i-th equation of the index is one.
+  size_t size() const { return size_; }
+  bool contains(size_t i) const { return (bits_[i / 64] >> (i % 64)) & 1; }
+
+  // Return the positions of the candidates in the index, ascending.
+  std::vector<uint32_t> positions() const;
+
+ private:
+  const CandidateIndex* index_;
+  std::vector<uint64_t> bits_;
+  size_t size_;
+
+  // The bitsets before each apply, one after the other.
+  std::vector<uint64_t> undo_;
+};
+
+#endif  // CANDIDATESET_H_
@@ -0,0 +1,77 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "./CandidateSet.h"
+#include "./EquationIndex.h"
+#include "./Feedback.h"
+#include "./Random.h"
+
+
+namespace {
+// Return the positions of the given candidates for which the guess gets the
+// given pattern.
+std::vector<uint32_t> filter(const std::vector<uint32_t>& candidates,
+                             uint32_t guess, uint16_t pattern) {
+  const EquationIndex& index = EquationIndex::classic();
+  std::vector<uint32_t> result;
+  for (uint32_t c : candidates) {
+    if (Feedback::pattern(guess, index.packed(c)) == pattern) {
+      result.push_back(c);
+    }
+  }
+  return result;
+}
+}  // namespace
+
+TEST(CandidateSetTest, apply) {
+  const EquationIndex& index = EquationIndex::classic();
+  const CandidateIndex candidateIndex(&index);
+  CandidateSet set(&candidateIndex);
+  ASSERT_EQ(set.size(), index.size());
+  const std::vector<uint32_t> all = set.positions();
+  ASSERT_EQ(all.size(), index.size());
+  ASSERT_EQ(all.back(), index.size() - 1);
+  Random random(8);
+  for (int game = 0; game < 50; ++game) {
+    const uint32_t answer = index.packed(random.uniform(index.size()));
+    std::vector<std::vector<uint32_t>> expected = {all};
+    for (int round = 0; round < 3; ++round) {
+      const uint32_t guess = index.packed(random.uniform(index.size()));
+      const uint16_t pattern = Feedback::pattern(guess, answer);
+      expected.push_back(filter(expected.back(), guess, pattern));
+      set.apply(guess, pattern);
+      ASSERT_EQ(set.size(), expected.back().size());
+      ASSERT_EQ(set.positions(), expected.back());
+      ASSERT_TRUE(set.contains(index.find(answer)));
+    }
+    ASSERT_EQ(set.depth(), 3);
+    for (int round = 3; round > 0; --round) {
+      set.undo();
+      ASSERT_EQ(set.positions(), expected[round - 1]);
+    }
+    ASSERT_EQ(set.depth(), 0);
+    set.undo();
+    ASSERT_EQ(set.size(), index.size());
+  }
+}
+
+TEST(CandidateSetTest, everyPattern) {
+  // Also patterns no answer can produce, f.e. "11+11=22" with the first 1
+  // black and the second magenta, must leave no candidate.
+  const EquationIndex& index = EquationIndex::classic();
+  const CandidateIndex candidateIndex(&index);
+  CandidateSet set(&candidateIndex);
+  for (size_t g : {0, 4711, 18289}) {
+    std::vector<uint16_t> patterns(index.size());
+    Feedback::patterns(index.packed(g), index.data(), index.size(),
+                       patterns.data());
+    std::vector<size_t> counts(kNumPatterns, 0);
+    for (uint16_t p : patterns) { ++counts[p]; }
+    for (int p = 0; p < kNumPatterns; ++p) {
+      set.apply(index.packed(g), p);
+      ASSERT_EQ(set.size(), counts[p]) << g << " " << p;
+      set.undo();
+    }
+  }
+}
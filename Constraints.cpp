@@ -0,0 +1,85 @@
+// Copyright 2022 Henrik Roth
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include "./Constraints.h"
+
+namespace {
+// Return "once", "twice" or "<n> times".
+std::string times(int n) {
+  if (n == 1) { return "once"; }
+  if (n == 2) { return "twice"; }
+  return std::to_string(n) + " times";
+}
+}  // namespace
+
+// ____________________________________________________________________________
+Constraints::Constraints(int length) : length_(length) {
+  memset(greens_, kAnySymbol, sizeof(greens_));
+  memset(minCounts_, 0, sizeof(minCounts_));
+  memset(maxCounts_, length, sizeof(maxCounts_));
+}
+
+// ____________________________________________________________________________
+void Constraints::add(const char* guess, uint32_t pattern) {
+  // Green and magenta cells of a symbol are uses of it in the answer, a
+  // black one means there are no more.
+  uint8_t found[kNumSymbols] = {};
+  bool black[kNumSymbols] = {};
+  for (int i = length_ - 1; i >= 0; --i) {
+    const int code = PackedEquation::symbolCode(guess[i]);
+    const int digit = pattern % 3;
+    pattern /= 3;
+    if (digit == 2) { greens_[i] = code; }
+    found[code] += digit > 0;
+    black[code] |= digit == 0;
+  }
+  for (int code = 0; code < kNumSymbols; ++code) {
+    minCounts_[code] = std::max(minCounts_[code], found[code]);
+    if (black[code]) { maxCounts_[code] = found[code]; }
+  }
+}
+
+// ____________________________________________________________________________
+Constraints::Violation Constraints::check(const char* guess) const {
+  uint8_t counts[kNumSymbols] = {};
+  for (int i = 0; i < length_; ++i) {
+    const int code = PackedEquation::symbolCode(guess[i]);
+    if (greens_[i] != kAnySymbol && greens_[i] != code) {
+      return {Violation::kGreenMoved,
+              PackedEquation::symbolChar(greens_[i]), i, 1};
+    }
+    ++counts[code];
+  }
+  for (int code = 0; code < kNumSymbols; ++code) {
+    if (counts[code] < minCounts_[code]) {
+      return {Violation::kTooFew, PackedEquation::symbolChar(code), -1,
+              minCounts_[code]};
+    }
+    if (counts[code] > maxCounts_[code]) {
+      return {Violation::kTooMany, PackedEquation::symbolChar(code), -1,
+              maxCounts_[code]};
+    }
+  }
+  return {Violation::kNone, ' ', -1, 0};
+}
+
+// ____________________________________________________________________________
+std::string Constraints::message(const Violation& violation) {
+  const std::string symbol(1, violation.symbol);
+  switch (violation.kind) {
+    case Violation::kNone:
+      return "";
+    case Violation::kGreenMoved:
+      return "Cell " + std::to_string(violation.cell + 1) + " must stay a "
+             + symbol + "!";
+    case Violation::kTooFew:
+      return "Use the " + symbol + " at least " + times(violation.count)
+             + "!";
+    case Violation::kTooMany:
+      if (violation.count == 0) { return "There is no " + symbol + " in it!"; }
+      return "Use the " + symbol + " at most " + times(violation.count) + "!";
+  }
+  return "";
+}
@@ -0,0 +1,69 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef CONSTRAINTS_H_
+#define CONSTRAINTS_H_
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include "./GameSession.h"
+#include "./PackedEquation.h"
+
+// What the feedback of the earlier rounds of a game says about the answer,
+// for the hard mode, in which every guess must fit it: green symbols stay in
+// their cells, and every symbol is used at least as often as it was green
+// or magenta in one guess and, once it was also black there, exactly that
+// often.
+//
+// The constraints are updated once per round, checking a guess takes the
+// same time in every round. Like GameSession, they can be copied with
+// memcpy.
+class Constraints {
+ public:
+  // Why a guess doesn't fit the feedback so far.
+  struct Violation {
+    enum Kind {
+      kNone,
+      kGreenMoved,  // the cell must hold the given symbol
+      kTooFew,  // the symbol must be used at least count times
+      kTooMany  // the symbol may be used at most count times
+    };
+    Kind kind;
+    char symbol;
+    int cell;
+    int count;
+  };
+
+  // No constraints yet on equations of the given length.
+  explicit Constraints(int length);
+
+  // Take the feedback on the given guess into account, given as a base-3
+  // pattern id like GameSession::pattern.
+  void add(const char* guess, uint32_t pattern);
+
+  // Return the first violation of the constraints by the given guess,
+  // which is as long as the equations, checking the cells from left to
+  // right and then the symbols. The guess must only contain legal symbols.
+  Violation check(const char* guess) const;
+  bool allows(const char* guess) const {
+    return check(guess).kind == Violation::kNone;
+  }
+
+  // Text of a violation for the player, f.e. "Cell 3 must stay a 4!".
+  static std::string message(const Violation& violation);
+
+ private:
+  static constexpr uint8_t kAnySymbol = 0xFF;
+
+  // The symbol code that is green in each cell, or kAnySymbol.
+  uint8_t greens_[kMaxLength];
+  // How often each symbol (by its code) is at least and at most used.
+  uint8_t minCounts_[kNumSymbols];
+  uint8_t maxCounts_[kNumSymbols];
+  uint8_t length_;
+};
+
+static_assert(std::is_trivially_copyable<Constraints>::value,
+              "constraints are copied with memcpy");
+
+#endif  // CONSTRAINTS_H_
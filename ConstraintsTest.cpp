@@ -0,0 +1,59 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <string>
+#include "./Constraints.h"
+#include "./GameSession.h"
+#include "./Variant.h"
+
+namespace {
+// Submit the guess to the session and add its feedback to the constraints.
+void guess(GameSession* session, Constraints* constraints,
+           const std::string& guess) {
+  ASSERT_EQ(session->submit(guess.data(), guess.size()),
+            GameSession::kAccepted);
+  constraints->add(guess.data(), session->pattern(session->round() - 1));
+}
+}  // namespace
+
+TEST(ConstraintsTest, check) {
+  GameSession session(VariantRules::forLength(8), "11+11=22");
+  Constraints constraints(8);
+  ASSERT_TRUE(constraints.allows("48-32=16"));
+  // feedback "11113231": = green, 2 and 1 magenta, the others black
+  guess(&session, &constraints, "48-32=16");
+  Constraints::Violation violation = constraints.check("48-32=16");
+  ASSERT_EQ(violation.kind, Constraints::Violation::kTooMany);
+  ASSERT_EQ(violation.symbol, '3');
+  ASSERT_EQ(Constraints::message(violation), "There is no 3 in it!");
+  violation = constraints.check("22=10+12");
+  ASSERT_EQ(violation.kind, Constraints::Violation::kGreenMoved);
+  ASSERT_EQ(violation.cell, 5);
+  ASSERT_EQ(Constraints::message(violation), "Cell 6 must stay a =!");
+  violation = constraints.check("5*7+0=35");
+  ASSERT_EQ(violation.kind, Constraints::Violation::kTooFew);
+  ASSERT_EQ(Constraints::message(violation), "Use the 1 at least once!");
+  ASSERT_TRUE(constraints.allows("12+10=22"));
+  // feedback "21221222": now there are exactly two 2 and no 0
+  guess(&session, &constraints, "12+10=22");
+  ASSERT_TRUE(constraints.allows("11+11=22"));
+  violation = constraints.check("11+12=23");
+  ASSERT_EQ(violation.kind, Constraints::Violation::kGreenMoved);
+  ASSERT_EQ(violation.cell, 7);
+  violation = constraints.check("12+12=22");
+  ASSERT_EQ(violation.kind, Constraints::Violation::kTooMany);
+  ASSERT_EQ(Constraints::message(violation), "Use the 2 at most twice!");
+}
+
+TEST(ConstraintsTest, session) {
+  // guesses of the hard mode must fit the constraints
+  GameSession session(VariantRules::forLength(6), "10-7=3");
+  Constraints constraints(6);
+  guess(&session, &constraints, "10-8=2");
+  ASSERT_EQ(session.submit("12-9=3", 6, &constraints),
+            GameSession::kInconsistent);
+  ASSERT_STREQ(GameSession::name(GameSession::kInconsistent), "hard");
+  ASSERT_EQ(session.round(), 1);
+  ASSERT_EQ(session.submit("10-6=4", 6, &constraints),
+            GameSession::kAccepted);
+}
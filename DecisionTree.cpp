@@ -0,0 +1,436 @@
+// Copyright 2022 Henrik Roth
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./DecisionTree.h"
+#include "./Feedback.h"
+
+namespace {
+constexpr char kMagic[8] = {'N', 'R', 'D', 'L', 'T', 'R', 'E', 'E'};
+constexpr uint32_t kVersion = 1;
+
+// Sets of candidates at least this large search their groups in parallel.
+constexpr size_t kParallelSize = 128;
+
+// Number of parts of the memo, each with a lock of its own.
+constexpr size_t kNumShards = 64;
+
+// Header at the start of every tree file.
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t objective;
+  uint64_t numNodes;
+  uint64_t numEdges;
+  uint64_t numAnswers;
+  uint64_t totalGuesses;
+  uint32_t worstCase;
+  uint32_t padding;
+  // checksum of everything behind the header
+  uint64_t checksum;
+};
+
+// Offsets of the tables behind the header and the size of the file.
+struct Layout {
+  uint64_t guesses;
+  uint64_t firstEdges;
+  uint64_t patterns;
+  uint64_t children;
+  uint64_t fileSize;
+
+  Layout(uint64_t numNodes, uint64_t numEdges) {
+    guesses = sizeof(Header);
+    firstEdges = guesses + 4 * numNodes;
+    patterns = firstEdges + 4 * (numNodes + 1);
+    children = patterns + (2 * numEdges + 3) / 4 * 4;
+    fileSize = children + 4 * numEdges;
+  }
+};
+
+// ____________________________________________________________________________
+uint64_t checksum(const uint8_t* data, size_t size) {
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ data[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+// A way to play a set of candidates: the first guess, the guesses all
+// candidates need together and the most one of them needs.
+struct Plan {
+  uint32_t guess;
+  uint64_t cost;
+  int worst;
+};
+
+constexpr uint64_t kInfeasible = UINT64_MAX;
+
+// The candidates that get the same pattern on a guess.
+struct Group {
+  uint16_t pattern;
+  std::vector<uint32_t> candidates;
+};
+
+// Searches the best plan of every set of candidates it meets, depth first,
+// and remembers them.
+class Builder {
+ public:
+  Builder(const Solver& solver, ThreadPool* pool,
+          const DecisionTree::Options& options)
+      : solver_(solver), answers_(*solver.answers()), pool_(pool),
+        options_(options), shards_(kNumShards), numSolved_(0),
+        numReused_(0) {}
+
+  // Return the best plan for the given candidates (positions of answers)
+  // that needs at most guessesLeft guesses for each.
+  Plan solve(const std::vector<uint32_t>& candidates, int guessesLeft);
+
+  // Split the candidates by the pattern they get on the given guess, in
+  // ascending order of the patterns.
+  std::vector<Group> split(uint32_t guess,
+                           const std::vector<uint32_t>& candidates) const;
+
+  size_t numSolved() const { return numSolved_; }
+  size_t numReused() const { return numReused_; }
+
+ private:
+  // Return true if plan a is better than plan b.
+  bool isBetter(const Plan& a, const Plan& b) const;
+
+  // Return the plan of the given guess for the given candidates, or an
+  // infeasible one if it can't be better than best.
+  Plan tryGuess(uint32_t guess, const std::vector<uint32_t>& candidates,
+                int guessesLeft, const Plan& best);
+
+  // Part of the memo of solved sets, keyed by the guesses left and the
+  // candidates.
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<std::string, Plan> plans;
+  };
+
+  const Solver& solver_;
+  const EquationIndex& answers_;
+  ThreadPool* pool_;
+  DecisionTree::Options options_;
+  std::vector<Shard> shards_;
+  std::atomic<size_t> numSolved_;
+  std::atomic<size_t> numReused_;
+};
+
+// ____________________________________________________________________________
+bool Builder::isBetter(const Plan& a, const Plan& b) const {
+  if (a.cost == kInfeasible) { return false; }
+  if (b.cost == kInfeasible) { return true; }
+  if (options_.objective == DecisionTree::kWorstCase) {
+    return a.worst < b.worst || (a.worst == b.worst && a.cost < b.cost);
+  }
+  return a.cost < b.cost || (a.cost == b.cost && a.worst < b.worst);
+}
+
+// ____________________________________________________________________________
+std::vector<Group> Builder::split(
+    uint32_t guess, const std::vector<uint32_t>& candidates) const {
+  std::vector<uint32_t> packed(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    packed[i] = answers_.packed(candidates[i]);
+  }
+  std::vector<uint16_t> patterns(candidates.size());
+  Feedback::patterns(guess, packed.data(), packed.size(), patterns.data());
+  std::vector<std::pair<uint16_t, uint32_t>> sorted(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    sorted[i] = {patterns[i], candidates[i]};
+  }
+  std::sort(sorted.begin(), sorted.end());
+  std::vector<Group> groups;
+  for (const auto& [pattern, candidate] : sorted) {
+    if (groups.empty() || groups.back().pattern != pattern) {
+      groups.push_back({pattern, {}});
+    }
+    groups.back().candidates.push_back(candidate);
+  }
+  return groups;
+}
+
+// ____________________________________________________________________________
+Plan Builder::tryGuess(uint32_t guess,
+                       const std::vector<uint32_t>& candidates,
+                       int guessesLeft, const Plan& best) {
+  const Plan infeasible = {guess, kInfeasible, 0};
+  const std::vector<Group> groups = split(guess, candidates);
+  // A guess that tells nothing only wastes a round.
+  if (groups.size() == 1 && groups[0].pattern != kAllGreen) {
+    return infeasible;
+  }
+  Plan plan = {guess, candidates.size(), 1};
+  if (candidates.size() >= kParallelSize) {
+    // Large groups are worth a task each; idle threads steal them.
+    std::vector<Plan> plans(groups.size());
+    pool_->parallelFor(groups.size(), 1, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        plans[i] = groups[i].pattern == kAllGreen
+            ? Plan{guess, 0, 0} : solve(groups[i].candidates, guessesLeft - 1);
+      }
+    });
+    for (const Plan& sub : plans) {
+      if (sub.cost == kInfeasible) { return infeasible; }
+      plan.cost += sub.cost;
+      plan.worst = std::max(plan.worst, 1 + sub.worst);
+    }
+    return plan;
+  }
+  // Each group of size s needs at least 2 s - 1 guesses: one of them is
+  // guessed next and the others at least once more.
+  uint64_t lowerBound = 0;
+  for (const Group& group : groups) {
+    if (group.pattern != kAllGreen) {
+      lowerBound += 2 * group.candidates.size() - 1;
+    }
+  }
+  for (const Group& group : groups) {
+    if (group.pattern == kAllGreen) { continue; }
+    const bool cantWin = options_.objective == DecisionTree::kWorstCase
+        ? best.cost != kInfeasible && plan.worst > best.worst
+        : best.cost != kInfeasible && plan.cost + lowerBound >= best.cost;
+    if (cantWin) { return infeasible; }
+    const Plan sub = solve(group.candidates, guessesLeft - 1);
+    if (sub.cost == kInfeasible) { return infeasible; }
+    lowerBound -= 2 * group.candidates.size() - 1;
+    plan.cost += sub.cost;
+    plan.worst = std::max(plan.worst, 1 + sub.worst);
+  }
+  return plan;
+}
+
+// ____________________________________________________________________________
+Plan Builder::solve(const std::vector<uint32_t>& candidates,
+                    int guessesLeft) {
+  const size_t n = candidates.size();
+  const uint32_t first = answers_.packed(candidates[0]);
+  if (n == 1) { return {first, 1, 1}; }
+  if (guessesLeft < 2) { return {first, kInfeasible, 0}; }
+  if (n == 2) { return {first, 3, 2}; }
+
+  std::string key(1, static_cast<char>(guessesLeft));
+  key.append(reinterpret_cast<const char*>(candidates.data()), 4 * n);
+  Shard& shard = shards_[std::hash<std::string>()(key) % kNumShards];
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.plans.find(key);
+    if (it != shard.plans.end()) {
+      ++numReused_;
+      return it->second;
+    }
+  }
+
+  std::vector<uint32_t> guesses;
+  if (n <= options_.smallSet) {
+    for (uint32_t candidate : candidates) {
+      guesses.push_back(answers_.packed(candidate));
+    }
+  } else {
+    for (const Solver::Suggestion& suggestion :
+         solver_.suggest(candidates, options_.width, Solver::kExpectedSize)) {
+      guesses.push_back(suggestion.packed);
+    }
+  }
+  Plan best = {first, kInfeasible, 0};
+  for (uint32_t guess : guesses) {
+    const Plan plan = tryGuess(guess, candidates, guessesLeft, best);
+    if (isBetter(plan, best)) { best = plan; }
+  }
+
+  ++numSolved_;
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.plans.emplace(std::move(key), best);
+  return best;
+}
+}  // namespace
+
+// ____________________________________________________________________________
+DecisionTree::DecisionTree() : data_(nullptr), size_(0) {}
+
+// ____________________________________________________________________________
+DecisionTree::~DecisionTree() { close(); }
+
+// ____________________________________________________________________________
+void DecisionTree::close() {
+  if (data_ != nullptr) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+    data_ = nullptr;
+  }
+}
+
+// ____________________________________________________________________________
+bool DecisionTree::build(const Solver& solver, ThreadPool* pool,
+                         const Options& options, const char* path,
+                         Stats* stats) {
+  const size_t numAnswers = solver.answers()->size();
+  if (numAnswers == 0) { return false; }
+  std::vector<uint32_t> all(numAnswers);
+  for (size_t i = 0; i < numAnswers; ++i) { all[i] = i; }
+  Builder builder(solver, pool, options);
+  const Plan root = builder.solve(all, options.maxGuesses);
+  if (root.cost == kInfeasible) { return false; }
+  const size_t numSolved = builder.numSolved();
+  const size_t numReused = builder.numReused();
+
+  // Lay the tree out breadth first. The plans of all sets with more than
+  // two candidates are remembered by now.
+  std::vector<uint32_t> guesses;
+  std::vector<uint32_t> firstEdges;
+  std::vector<uint16_t> patterns;
+  std::vector<uint32_t> children;
+  std::deque<std::pair<std::vector<uint32_t>, int>> pending;
+  pending.emplace_back(std::move(all), options.maxGuesses);
+  size_t numQueued = 1;
+  while (!pending.empty()) {
+    const auto [candidates, guessesLeft] = std::move(pending.front());
+    pending.pop_front();
+    const Plan plan = builder.solve(candidates, guessesLeft);
+    guesses.push_back(plan.guess);
+    firstEdges.push_back(patterns.size());
+    for (Group& group : builder.split(plan.guess, candidates)) {
+      if (group.pattern == kAllGreen) { continue; }
+      patterns.push_back(group.pattern);
+      children.push_back(numQueued++);
+      pending.emplace_back(std::move(group.candidates), guessesLeft - 1);
+    }
+  }
+  firstEdges.push_back(patterns.size());
+
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.objective = options.objective;
+  header.numNodes = guesses.size();
+  header.numEdges = patterns.size();
+  header.numAnswers = numAnswers;
+  header.totalGuesses = root.cost;
+  header.worstCase = root.worst;
+  const Layout layout(header.numNodes, header.numEdges);
+  std::vector<uint8_t> data(layout.fileSize, 0);
+  memcpy(&data[layout.guesses], guesses.data(), 4 * guesses.size());
+  memcpy(&data[layout.firstEdges], firstEdges.data(), 4 * firstEdges.size());
+  memcpy(&data[layout.patterns], patterns.data(), 2 * patterns.size());
+  memcpy(&data[layout.children], children.data(), 4 * children.size());
+  header.checksum = checksum(&data[sizeof(Header)],
+                             data.size() - sizeof(Header));
+  memcpy(data.data(), &header, sizeof(header));
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(data.data()), data.size());
+  if (!file) { return false; }
+
+  if (stats != nullptr) {
+    stats->numNodes = header.numNodes;
+    stats->numAnswers = numAnswers;
+    stats->totalGuesses = root.cost;
+    stats->worstCase = root.worst;
+    stats->numSolved = numSolved;
+    stats->numReused = numReused;
+  }
+  return true;
+}
+
+// ____________________________________________________________________________
+bool DecisionTree::open(const char* path) {
+  close();
+  const int fd = ::open(path, O_RDONLY);
+  if (fd < 0) { return false; }
+  struct stat status;
+  if (fstat(fd, &status) != 0
+      || static_cast<size_t>(status.st_size) < sizeof(Header)) {
+    ::close(fd);
+    return false;
+  }
+  size_ = status.st_size;
+  void* mapped = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) { return false; }
+  data_ = static_cast<const uint8_t*>(mapped);
+
+  Header header;
+  memcpy(&header, data_, sizeof(header));
+  const Layout layout(header.numNodes, header.numEdges);
+  bool valid = memcmp(header.magic, kMagic, sizeof(kMagic)) == 0
+      && header.version == kVersion
+      && header.numNodes > 0
+      && header.numAnswers > 0
+      && layout.fileSize == size_
+      && checksum(data_ + sizeof(Header), size_ - sizeof(Header))
+         == header.checksum;
+  if (valid) {
+    guesses_ = reinterpret_cast<const uint32_t*>(data_ + layout.guesses);
+    firstEdges_ = reinterpret_cast<const uint32_t*>(data_
+                                                    + layout.firstEdges);
+    patterns_ = reinterpret_cast<const uint16_t*>(data_ + layout.patterns);
+    children_ = reinterpret_cast<const uint32_t*>(data_ + layout.children);
+    // Edges must stay within the table and lead to later nodes, so that
+    // following them always ends.
+    valid = firstEdges_[0] == 0
+        && firstEdges_[header.numNodes] == header.numEdges;
+    for (size_t node = 0; valid && node < header.numNodes; ++node) {
+      valid = firstEdges_[node] <= firstEdges_[node + 1];
+      for (uint32_t e = firstEdges_[node];
+           valid && e < firstEdges_[node + 1]; ++e) {
+        valid = children_[e] > node && children_[e] < header.numNodes;
+      }
+    }
+  }
+  if (!valid) {
+    close();
+    return false;
+  }
+  numNodes_ = header.numNodes;
+  numAnswers_ = header.numAnswers;
+  totalGuesses_ = header.totalGuesses;
+  worstCase_ = header.worstCase;
+  return true;
+}
+
+// ____________________________________________________________________________
+uint32_t DecisionTree::next(uint32_t node, uint16_t pattern) const {
+  const uint16_t* begin = patterns_ + firstEdges_[node];
+  const uint16_t* end = patterns_ + firstEdges_[node + 1];
+  const uint16_t* edge = std::lower_bound(begin, end, pattern);
+  if (edge == end || *edge != pattern) { return kNoNode; }
+  return children_[edge - patterns_];
+}
+
+// ____________________________________________________________________________
+uint32_t DecisionTree::nextGuess(const uint16_t* patterns,
+                                 size_t numPatterns) const {
+  uint32_t node = root();
+  for (size_t i = 0; i < numPatterns; ++i) {
+    node = next(node, patterns[i]);
+    if (node == kNoNode) { return 0; }
+  }
+  return guess(node);
+}
+
+// ____________________________________________________________________________
+int DecisionTree::guessesFor(uint32_t answer) const {
+  uint32_t node = root();
+  for (int numGuesses = 1; node != kNoNode; ++numGuesses) {
+    const uint16_t pattern = Feedback::pattern(guess(node), answer);
+    if (pattern == kAllGreen) { return numGuesses; }
+    node = next(node, pattern);
+  }
+  return -1;
+}
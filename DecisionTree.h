@@ -0,0 +1,111 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef DECISIONTREE_H_
+#define DECISIONTREE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "./Solver.h"
+#include "./ThreadPool.h"
+
+// A complete strategy for the answers of a solver, computed once by build()
+// and stored in a file that is mapped into memory by open(). Every node is
+// a guess, and its children are the nodes to go on with after the feedback
+// patterns the guess can get, so finding the next guess of a game is one
+// step down the tree per move instead of scoring guesses.
+//
+// File layout (version 1), all numbers little endian:
+//   header (see DecisionTree.cpp), packed guess of every node (uint32 each),
+//   first edge of every node and one past the last edge (uint32 each),
+//   pattern of every edge (uint16 each, ascending per node, padded to 4
+//   bytes), child node of every edge (uint32 each). Node 0 is the root.
+// A node has no edge for kAllGreen: the game is won then.
+class DecisionTree {
+ public:
+  // What the tree minimizes: the expected number of guesses per answer or
+  // the most guesses any answer needs. Ties are broken by the other one.
+  enum Objective { kExpectedGuesses, kWorstCase };
+
+  // How the tree is searched. At every node, the width best guesses of the
+  // solver (by expected size) are tried, or every candidate if there are at
+  // most smallSet. Trees that need more than maxGuesses for an answer are
+  // not taken. So the tree is optimal among these guesses; trying more
+  // takes exponentially longer.
+  struct Options {
+    Objective objective = kExpectedGuesses;
+    size_t width = 2;
+    size_t smallSet = 16;
+    int maxGuesses = 6;
+  };
+
+  // What a built tree is like.
+  struct Stats {
+    size_t numNodes = 0;
+    size_t numAnswers = 0;
+    // Sum of the guesses all answers need and the most any answer needs.
+    uint64_t totalGuesses = 0;
+    int worstCase = 0;
+    // Sets of candidates searched and how often one was found again.
+    size_t numSolved = 0;
+    size_t numReused = 0;
+  };
+
+  static constexpr uint32_t kNoNode = UINT32_MAX;
+
+  DecisionTree();
+  ~DecisionTree();
+
+  DecisionTree(const DecisionTree&) = delete;
+  DecisionTree& operator=(const DecisionTree&) = delete;
+
+  // Search the tree for all answers of the given solver with the threads of
+  // the given pool, which steal the subtrees from each other, and write it
+  // to the file at path. Sets of candidates that were solved before are
+  // looked up instead of searched again. Return false if no tree within
+  // maxGuesses was found or the file couldn't be written.
+  static bool build(const Solver& solver, ThreadPool* pool,
+                    const Options& options, const char* path, Stats* stats);
+
+  // Map the tree file at path into memory and check it. Return false if
+  // the file can't be used.
+  bool open(const char* path);
+
+  // The guess of a node and the node after it got the given pattern, or
+  // kNoNode if the pattern is all green or no answer can get it.
+  uint32_t root() const { return 0; }
+  uint32_t guess(uint32_t node) const { return guesses_[node]; }
+  uint32_t next(uint32_t node, uint16_t pattern) const;
+
+  // Return the guess after the guesses of the tree got the given patterns,
+  // or 0 if no answer gets them.
+  uint32_t nextGuess(const uint16_t* patterns, size_t numPatterns) const;
+
+  // Return the number of guesses the tree needs for the given packed
+  // answer, or -1 if it doesn't find it.
+  int guessesFor(uint32_t answer) const;
+
+  size_t numNodes() const { return numNodes_; }
+  size_t numAnswers() const { return numAnswers_; }
+  double expectedGuesses() const {
+    return static_cast<double>(totalGuesses_) / numAnswers_;
+  }
+  int worstCase() const { return worstCase_; }
+
+ private:
+  // Unmap the file if one is mapped.
+  void close();
+
+  // The mapped file.
+  const uint8_t* data_;
+  size_t size_;
+  size_t numNodes_;
+  size_t numAnswers_;
+  uint64_t totalGuesses_;
+  int worstCase_;
+  const uint32_t* guesses_;
+  const uint32_t* firstEdges_;
+  const uint16_t* patterns_;
+  const uint32_t* children_;
+};
+
+#endif  // DECISIONTREE_H_
@@ -0,0 +1,97 @@
+// Copyright 2022 Henrik Roth
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "./DecisionTree.h"
+#include "./EquationIndex.h"
+#include "./FeedbackMatrix.h"
+#include "./PackedEquation.h"
+#include "./Solver.h"
+#include "./ThreadPool.h"
+
+
+// Build the decision tree for all classic answers and write it to a file,
+// or check an existing file. The tree is checked by playing every answer.
+int main(int argc, char** argv) {
+  const char* path = nullptr;
+  const char* matrixPath = nullptr;
+  int numThreads = std::thread::hardware_concurrency();
+  DecisionTree::Options options;
+  bool check = false;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      numThreads = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+      options.width = std::stoul(argv[++i]);
+    } else if (strcmp(argv[i], "--small") == 0 && i + 1 < argc) {
+      options.smallSet = std::stoul(argv[++i]);
+    } else if (strcmp(argv[i], "--matrix") == 0 && i + 1 < argc) {
+      matrixPath = argv[++i];
+    } else if (strcmp(argv[i], "--worst-case") == 0) {
+      options.objective = DecisionTree::kWorstCase;
+    } else if (strcmp(argv[i], "--check") == 0) {
+      check = true;
+    } else if (path == nullptr && argv[i][0] != '-') {
+      path = argv[i];
+    } else {
+      usage = true;
+    }
+  }
+  if (path == nullptr || usage || options.width == 0) {
+    std::cerr << "Usage: " << argv[0] << " <file> [--threads <n>]"
+              << " [--width <n>] [--small <n>] [--matrix <file>]"
+              << " [--worst-case] [--check]" << std::endl;
+    return 1;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const EquationIndex& index = EquationIndex::classic();
+  if (!check) {
+    ThreadPool pool(numThreads);
+    Solver solver(&index, &index, &pool);
+    FeedbackMatrix matrix;
+    if (matrixPath != nullptr
+        && !(matrix.open(matrixPath) && solver.useMatrix(&matrix))) {
+      std::cerr << matrixPath << " is not a feedback matrix of the classic"
+                << " equations" << std::endl;
+      return 1;
+    }
+    DecisionTree::Stats stats;
+    if (!DecisionTree::build(solver, &pool, options, path, &stats)) {
+      std::cerr << "Could not build or write " << path << std::endl;
+      return 1;
+    }
+    std::cout << "Searched " << stats.numSolved << " sets of candidates, "
+              << stats.numReused << " found again" << std::endl;
+  }
+  DecisionTree tree;
+  if (!tree.open(path) || tree.numAnswers() != index.size()) {
+    std::cerr << path << " is not a valid decision tree" << std::endl;
+    return 1;
+  }
+  std::vector<size_t> histogram(tree.worstCase() + 1, 0);
+  for (size_t i = 0; i < index.size(); ++i) {
+    const int numGuesses = tree.guessesFor(index.packed(i));
+    if (numGuesses < 1 || numGuesses > tree.worstCase()) {
+      std::cerr << path << " doesn't find " << index.equation(i)
+                << std::endl;
+      return 1;
+    }
+    ++histogram[numGuesses];
+  }
+  const double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  std::cout << path << ": " << tree.numNodes() << " nodes, opening "
+            << PackedEquation::unpack(tree.guess(tree.root())) << ", "
+            << tree.expectedGuesses() << " guesses expected, at most "
+            << tree.worstCase() << ", " << seconds << " s" << std::endl;
+  for (int r = 1; r <= tree.worstCase(); ++r) {
+    std::cout << "  won in round " << r << ": " << histogram[r] << std::endl;
+  }
+  return 0;
+}
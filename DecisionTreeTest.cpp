@@ -0,0 +1,106 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "./DecisionTree.h"
+#include "./EquationIndex.h"
+#include "./Feedback.h"
+#include "./Solver.h"
+#include "./Strategy.h"
+#include "./ThreadPool.h"
+
+
+TEST(DecisionTreeTest, build) {
+  const EquationIndex answers = EquationIndex::classic().sample(50);
+  ThreadPool serialPool(1);
+  ThreadPool parallelPool(4);
+  Solver serial(&answers, &answers, &serialPool);
+  Solver parallel(&answers, &answers, &parallelPool);
+  const char* path = "/tmp/DecisionTreeTest.tree";
+  DecisionTree::Options options;
+  DecisionTree::Stats stats;
+  ASSERT_TRUE(DecisionTree::build(serial, &serialPool, options, path,
+                                  &stats));
+  ASSERT_EQ(stats.numAnswers, answers.size());
+  ASSERT_GT(stats.numSolved, 0u);
+  DecisionTree tree;
+  ASSERT_TRUE(tree.open(path));
+  ASSERT_EQ(tree.numNodes(), stats.numNodes);
+  ASSERT_EQ(tree.numAnswers(), answers.size());
+  ASSERT_LE(tree.worstCase(), options.maxGuesses);
+
+  // Every answer is found, within as many guesses as the tree says.
+  uint64_t totalGuesses = 0;
+  for (size_t i = 0; i < answers.size(); ++i) {
+    const int numGuesses = tree.guessesFor(answers.packed(i));
+    ASSERT_GE(numGuesses, 1);
+    ASSERT_LE(numGuesses, tree.worstCase());
+    totalGuesses += numGuesses;
+  }
+  ASSERT_EQ(totalGuesses, stats.totalGuesses);
+  ASSERT_DOUBLE_EQ(tree.expectedGuesses(),
+                   static_cast<double>(totalGuesses) / answers.size());
+  // The opening of the tree is one of the best of the solver.
+  const std::vector<Solver::Suggestion> openings = serial.suggest(
+      serial.candidates({}), options.width, Solver::kExpectedSize);
+  ASSERT_TRUE(tree.guess(tree.root()) == openings[0].packed
+              || tree.guess(tree.root()) == openings[1].packed);
+
+  // Walking the tree with the patterns of a game gives its guesses.
+  const uint32_t answer = answers.packed(answers.size() / 2);
+  TreeStrategy strategy(&tree);
+  strategy.newGame(0);
+  std::vector<uint16_t> patterns;
+  for (int round = 1; round <= tree.guessesFor(answer); ++round) {
+    const uint32_t guess = strategy.nextGuess();
+    ASSERT_EQ(tree.nextGuess(patterns.data(), patterns.size()), guess);
+    patterns.push_back(Feedback::pattern(guess, answer));
+    strategy.feedback(guess, patterns.back());
+  }
+  ASSERT_EQ(patterns.back(), kAllGreen);
+  ASSERT_EQ(tree.next(tree.root(), kAllGreen), DecisionTree::kNoNode);
+
+  // The same tree with more threads, and no worse a worst case if that is
+  // what the tree minimizes.
+  const char* parallelPath = "/tmp/DecisionTreeTest.parallel.tree";
+  ASSERT_TRUE(DecisionTree::build(parallel, &parallelPool, options,
+                                  parallelPath, nullptr));
+  DecisionTree parallelTree;
+  ASSERT_TRUE(parallelTree.open(parallelPath));
+  ASSERT_EQ(parallelTree.numNodes(), tree.numNodes());
+  ASSERT_EQ(parallelTree.expectedGuesses(), tree.expectedGuesses());
+  options.objective = DecisionTree::kWorstCase;
+  ASSERT_TRUE(DecisionTree::build(parallel, &parallelPool, options,
+                                  parallelPath, nullptr));
+  ASSERT_TRUE(parallelTree.open(parallelPath));
+  ASSERT_LE(parallelTree.worstCase(), tree.worstCase());
+  ASSERT_GE(parallelTree.expectedGuesses(), tree.expectedGuesses());
+  remove(parallelPath);
+  remove(path);
+}
+
+TEST(DecisionTreeTest, open) {
+  const EquationIndex answers = EquationIndex::classic().sample(50);
+  ThreadPool pool(1);
+  Solver solver(&answers, &answers, &pool);
+  const char* path = "/tmp/DecisionTreeTest.open.tree";
+  DecisionTree tree;
+  ASSERT_FALSE(tree.open(path));
+  // Too few guesses for any tree.
+  DecisionTree::Options options;
+  options.maxGuesses = 2;
+  ASSERT_FALSE(DecisionTree::build(solver, &pool, options, path, nullptr));
+  options.maxGuesses = 6;
+  ASSERT_TRUE(DecisionTree::build(solver, &pool, options, path, nullptr));
+  ASSERT_TRUE(tree.open(path));
+  // A changed byte is noticed.
+  std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+  file.seekp(-1, std::ios::end);
+  file.put('\x7F');
+  file.close();
+  ASSERT_FALSE(tree.open(path));
+  remove(path);
+}
@@ -0,0 +1,120 @@
+// Copyright 2022 Henrik Roth
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "./DecisionTree.h"
+#include "./DifficultyTable.h"
+#include "./EquationIndex.h"
+#include "./Random.h"
+#include "./ThreadPool.h"
+
+
+// Rate how hard every classic answer is and write the table to a file, or
+// pick answers of a band from an existing table, f.e.
+// "DifficultyMain difficulty.bin --pick 4 --count 10" for ten hard ones.
+// With --tree, the table also holds the guesses of the solver, taken from
+// its decision tree (see DecisionTreeMain).
+int main(int argc, char** argv) {
+  const char* path = nullptr;
+  int numThreads = 0;
+  DifficultyTable::Options options;
+  const char* treePath = nullptr;
+  int pickBand = -1;
+  size_t count = 1;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      numThreads = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+      options.gamesPerAnswer = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--bands") == 0 && i + 1 < argc) {
+      options.numBands = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      options.seed = std::stoull(argv[++i]);
+    } else if (strcmp(argv[i], "--tree") == 0 && i + 1 < argc) {
+      treePath = argv[++i];
+    } else if (strcmp(argv[i], "--pick") == 0 && i + 1 < argc) {
+      pickBand = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+      count = std::stoull(argv[++i]);
+    } else if (path == nullptr && argv[i][0] != '-') {
+      path = argv[i];
+    } else {
+      usage = true;
+    }
+  }
+  if (path == nullptr || usage || options.gamesPerAnswer < 1
+      || options.numBands < 1 || options.numBands > 255) {
+    std::cerr << "Usage: " << argv[0] << " <file> [--threads <n>]"
+              << " [--games <n>] [--bands <1-255>] [--seed <n>]"
+              << " [--tree <file>]"
+              << " [--pick <band> [--count <n>]]" << std::endl;
+    return 1;
+  }
+
+  const EquationIndex& index = EquationIndex::classic();
+  DifficultyTable table;
+  if (pickBand >= 0) {
+    if (!table.open(path, index) || pickBand >= table.numBands()) {
+      std::cerr << path << " is not a difficulty table of the classic"
+                << " answers with band " << pickBand << std::endl;
+      return 1;
+    }
+    Random random;
+    for (size_t k = 0; k < count; ++k) {
+      const size_t i = table.pick(pickBand, &random);
+      std::cout << index.equation(i) << " " << table.expectedGuesses(i)
+                << " " << table.worstCase(i) << " "
+                << table.lateCandidates(i) << " " << table.solverGuesses(i)
+                << std::endl;
+    }
+    return 0;
+  }
+
+  DecisionTree tree;
+  if (treePath != nullptr) {
+    if (!tree.open(treePath) || tree.numAnswers() != index.size()) {
+      std::cerr << treePath << " is not a decision tree of the classic"
+                << " answers" << std::endl;
+      return 1;
+    }
+    options.tree = &tree;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  ThreadPool pool(numThreads);
+  if (!DifficultyTable::build(index, &pool, options, path)
+      || !table.open(path, index)) {
+    std::cerr << "Could not build or write " << path << std::endl;
+    return 1;
+  }
+  const double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  std::cout << path << ": " << table.numAnswers() << " answers, "
+            << options.gamesPerAnswer << " games each, " << seconds
+            << " s on " << pool.numThreads() << " thread(s)" << std::endl;
+  for (int band = 0; band < table.numBands(); ++band) {
+    const size_t easiest = table.answerOfBand(band, 0);
+    const size_t hardest = table.answerOfBand(band, table.bandSize(band) - 1);
+    double late = 0;
+    double solver = 0;
+    for (size_t k = 0; k < table.bandSize(band); ++k) {
+      late += table.lateCandidates(table.answerOfBand(band, k));
+      solver += table.solverGuesses(table.answerOfBand(band, k));
+    }
+    std::cout << "  band " << band << ": " << std::setw(5)
+              << table.bandSize(band) << " answers, " << std::fixed
+              << std::setprecision(2) << table.expectedGuesses(easiest)
+              << " to " << table.expectedGuesses(hardest)
+              << " guesses expected, " << late / table.bandSize(band)
+              << " left after two, ";
+    if (treePath != nullptr) {
+      std::cout << solver / table.bandSize(band) << " for the solver, ";
+    }
+    std::cout << "f.e. " << index.equation(hardest) << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,228 @@
+// Copyright 2022 Henrik Roth
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include "./DifficultyTable.h"
+#include "./Feedback.h"
+#include "./Simulation.h"
+#include "./Strategy.h"
+
+namespace {
+constexpr char kMagic[8] = {'N', 'R', 'D', 'L', 'D', 'I', 'F', 'F'};
+constexpr uint32_t kVersion = 2;
+
+// Header at the start of every table file.
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t numBands;
+  uint64_t numAnswers;
+  uint32_t gamesPerAnswer;
+  uint32_t padding;
+  uint64_t seed;
+  // checksum of the packed answers the table was built for
+  uint64_t answersChecksum;
+  // checksum of everything behind the header
+  uint64_t checksum;
+};
+
+// Offsets of the tables behind the header and the size of the file.
+struct Layout {
+  uint64_t entries;
+  uint64_t bandBegin;
+  uint64_t ranked;
+  uint64_t fileSize;
+
+  Layout(uint64_t numAnswers, uint64_t numBands) {
+    entries = sizeof(Header);
+    bandBegin = entries + sizeof(DifficultyTable::Entry) * numAnswers;
+    ranked = bandBegin + 4 * (numBands + 1);
+    fileSize = ranked + 4 * numAnswers;
+  }
+};
+
+// ____________________________________________________________________________
+uint64_t checksum(const uint8_t* data, size_t size) {
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ data[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+// ____________________________________________________________________________
+uint64_t checksum(const EquationIndex& answers) {
+  return checksum(reinterpret_cast<const uint8_t*>(answers.data()),
+                  4 * answers.size());
+}
+}  // namespace
+
+// ____________________________________________________________________________
+DifficultyTable::DifficultyTable() : data_(nullptr), size_(0) {}
+
+// ____________________________________________________________________________
+DifficultyTable::~DifficultyTable() { close(); }
+
+// ____________________________________________________________________________
+void DifficultyTable::close() {
+  if (data_ != nullptr) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+    data_ = nullptr;
+  }
+}
+
+// ____________________________________________________________________________
+bool DifficultyTable::build(const EquationIndex& answers, ThreadPool* pool,
+                            const Options& options, const char* path) {
+  const size_t numAnswers = answers.size();
+  const int numGames = options.gamesPerAnswer;
+  // Every band gets an answer at least, so that pick() finds one.
+  if (numAnswers == 0 || numGames < 1 || options.numBands < 1
+      || options.numBands > 255
+      || static_cast<size_t>(options.numBands) > numAnswers) {
+    return false;
+  }
+  std::vector<Entry> entries(numAnswers);
+  pool->parallelFor(numAnswers, 16, [&](size_t begin, size_t end) {
+    RandomStrategy player(&answers);
+    for (size_t i = begin; i < end; ++i) {
+      const uint32_t answer = answers.packed(i);
+      uint64_t totalGuesses = 0;
+      uint64_t totalLate = 0;
+      int worstCase = 0;
+      for (int game = 0; game < numGames; ++game) {
+        player.newGame(gameSeed(options.seed, i, game));
+        int numGuesses = kNumRounds + 1;
+        // 1 if the answer was found in the first two guesses
+        size_t late = 1;
+        for (int round = 1; round <= kNumRounds; ++round) {
+          const uint32_t guess = player.nextGuess();
+          const uint16_t pattern = Feedback::pattern(guess, answer);
+          if (pattern == kAllGreen) {
+            numGuesses = round;
+            break;
+          }
+          player.feedback(guess, pattern);
+          if (round == 2) { late = player.numCandidates(); }
+        }
+        totalGuesses += numGuesses;
+        totalLate += late;
+        worstCase = std::max(worstCase, numGuesses);
+      }
+      Entry& entry = entries[i];
+      memset(&entry, 0, sizeof(entry));
+      entry.expectedGuesses = (256 * totalGuesses + numGames / 2) / numGames;
+      entry.lateCandidates = std::min<uint64_t>(
+          (16 * totalLate + numGames / 2) / numGames, UINT16_MAX);
+      entry.worstCase = worstCase;
+      if (options.tree != nullptr) {
+        entry.solverGuesses = std::max(0, options.tree->guessesFor(answer));
+      }
+    }
+  });
+
+  // Rank the answers and split them into bands.
+  std::vector<uint32_t> ranked(numAnswers);
+  for (size_t i = 0; i < numAnswers; ++i) { ranked[i] = i; }
+  std::sort(ranked.begin(), ranked.end(), [&](uint32_t a, uint32_t b) {
+    const Entry& x = entries[a];
+    const Entry& y = entries[b];
+    if (x.expectedGuesses != y.expectedGuesses) {
+      return x.expectedGuesses < y.expectedGuesses;
+    }
+    if (x.worstCase != y.worstCase) { return x.worstCase < y.worstCase; }
+    if (x.solverGuesses != y.solverGuesses) {
+      return x.solverGuesses < y.solverGuesses;
+    }
+    return a < b;
+  });
+  std::vector<uint32_t> bandBegin(options.numBands + 1);
+  for (int band = 0; band <= options.numBands; ++band) {
+    bandBegin[band] = numAnswers * band / options.numBands;
+  }
+  for (int band = 0; band < options.numBands; ++band) {
+    for (uint32_t r = bandBegin[band]; r < bandBegin[band + 1]; ++r) {
+      entries[ranked[r]].band = band;
+    }
+  }
+
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.numBands = options.numBands;
+  header.numAnswers = numAnswers;
+  header.gamesPerAnswer = numGames;
+  header.seed = options.seed;
+  header.answersChecksum = checksum(answers);
+  const Layout layout(numAnswers, options.numBands);
+  std::vector<uint8_t> data(layout.fileSize, 0);
+  memcpy(&data[layout.entries], entries.data(),
+         sizeof(Entry) * entries.size());
+  memcpy(&data[layout.bandBegin], bandBegin.data(), 4 * bandBegin.size());
+  memcpy(&data[layout.ranked], ranked.data(), 4 * ranked.size());
+  header.checksum = checksum(&data[sizeof(Header)],
+                             data.size() - sizeof(Header));
+  memcpy(data.data(), &header, sizeof(header));
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(data.data()), data.size());
+  return static_cast<bool>(file);
+}
+
+// ____________________________________________________________________________
+bool DifficultyTable::open(const char* path, const EquationIndex& answers) {
+  close();
+  const int fd = ::open(path, O_RDONLY);
+  if (fd < 0) { return false; }
+  struct stat status;
+  if (fstat(fd, &status) != 0
+      || static_cast<size_t>(status.st_size) < sizeof(Header)) {
+    ::close(fd);
+    return false;
+  }
+  size_ = status.st_size;
+  void* mapped = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) { return false; }
+  data_ = static_cast<const uint8_t*>(mapped);
+
+  Header header;
+  memcpy(&header, data_, sizeof(header));
+  const Layout layout(header.numAnswers, header.numBands);
+  bool valid = memcmp(header.magic, kMagic, sizeof(kMagic)) == 0
+      && header.version == kVersion
+      && header.numAnswers == answers.size()
+      && header.numBands >= 1 && header.numBands <= 255
+      && header.answersChecksum == checksum(answers)
+      && layout.fileSize == size_
+      && checksum(data_ + sizeof(Header), size_ - sizeof(Header))
+         == header.checksum;
+  if (valid) {
+    entries_ = reinterpret_cast<const Entry*>(data_ + layout.entries);
+    bandBegin_ = reinterpret_cast<const uint32_t*>(data_ + layout.bandBegin);
+    ranked_ = reinterpret_cast<const uint32_t*>(data_ + layout.ranked);
+    // Bands and ranks must stay within the answers.
+    valid = bandBegin_[0] == 0
+        && bandBegin_[header.numBands] == header.numAnswers;
+    for (uint32_t band = 0; valid && band < header.numBands; ++band) {
+      valid = bandBegin_[band] < bandBegin_[band + 1];
+    }
+    for (size_t r = 0; valid && r < header.numAnswers; ++r) {
+      valid = ranked_[r] < header.numAnswers;
+    }
+  }
+  if (!valid) {
+    close();
+    return false;
+  }
+  numAnswers_ = header.numAnswers;
+  numBands_ = header.numBands;
+  return true;
+}
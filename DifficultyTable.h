@@ -0,0 +1,133 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef DIFFICULTYTABLE_H_
+#define DIFFICULTYTABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "./DecisionTree.h"
+#include "./EquationIndex.h"
+#include "./Random.h"
+#include "./ThreadPool.h"
+
+// How hard every answer of an index is, computed once by build() and stored
+// in a file next to the answers that is mapped into memory by open().
+//
+// The reference player is RandomStrategy: it always guesses an equation
+// that fits all feedback so far, like a human player in the hard mode. It
+// plays gamesPerAnswer games with different seeds against every answer. An
+// answer is as hard as the number of guesses these games need on average
+// and at most (kNumRounds + 1 for a lost game), and as the number of
+// answers that still fit the feedback after two guesses, on average: the
+// more are left then, the more the end of the game is guesswork.
+//
+// The solver plays the same game every time, so one game per answer tells
+// how hard the answer is for it. Its decision tree (see DecisionTree) has
+// that number for every answer, and build() stores it next to the others
+// if a tree is given.
+//
+// The answers are ranked by the expected guesses of the reference player
+// (then worst case, then guesses of the solver, then position) and split
+// into numBands bands of the same size, band 0 being the easiest, so
+// picking an answer of a band takes one lookup.
+//
+// File layout (version 2), all numbers little endian:
+//   header (see DifficultyTable.cpp), an Entry per answer in the order of
+//   the index, the first rank of every band and one past the last (uint32
+//   each) and the positions of the answers ranked by difficulty (uint32
+//   each).
+class DifficultyTable {
+ public:
+  // How the table is computed.
+  struct Options {
+    int gamesPerAnswer = 32;
+    int numBands = 5;
+    uint64_t seed = 42;
+    // the tree of the solver for the same answers, or none
+    const DecisionTree* tree = nullptr;
+  };
+
+  // The difficulty of one answer, in fixed point.
+  struct Entry {
+    // expected guesses times 256
+    uint16_t expectedGuesses;
+    // answers left after two guesses times 16, at most 65535
+    uint16_t lateCandidates;
+    uint8_t worstCase;
+    uint8_t band;
+    // guesses of the solver, 0 without a tree
+    uint8_t solverGuesses;
+    uint8_t padding;
+  };
+
+  DifficultyTable();
+  ~DifficultyTable();
+
+  DifficultyTable(const DifficultyTable&) = delete;
+  DifficultyTable& operator=(const DifficultyTable&) = delete;
+
+  // Play the games of every answer of the given index with the threads of
+  // the given pool and write the table to the file at path. Return false if
+  // there are fewer answers than bands or the file couldn't be written.
+  static bool build(const EquationIndex& answers, ThreadPool* pool,
+                    const Options& options, const char* path);
+
+  // Return the seed of the given game against the answer at position i of
+  // a table with the given seed. The seeds of all games of all answers and
+  // table seeds are unrelated, so another table seed gives other games.
+  static uint64_t gameSeed(uint64_t seed, size_t i, int game) {
+    return Random::mix(Random::mix(Random::mix(seed) ^ i) ^ game);
+  }
+
+  // Map the table file at path into memory and check that it was built for
+  // the given answers. Return false if the file can't be used.
+  bool open(const char* path, const EquationIndex& answers);
+
+  size_t numAnswers() const { return numAnswers_; }
+  int numBands() const { return numBands_; }
+
+  // The difficulty of the answer at the given position of the index.
+  const Entry& entry(size_t i) const { return entries_[i]; }
+  double expectedGuesses(size_t i) const {
+    return entries_[i].expectedGuesses / 256.0;
+  }
+  double lateCandidates(size_t i) const {
+    return entries_[i].lateCandidates / 16.0;
+  }
+  int worstCase(size_t i) const { return entries_[i].worstCase; }
+  int solverGuesses(size_t i) const { return entries_[i].solverGuesses; }
+  int band(size_t i) const { return entries_[i].band; }
+
+  // Number of answers in the given band, at least 1, and the position of
+  // the k-th easiest of them.
+  size_t bandSize(int band) const {
+    return bandBegin_[band + 1] - bandBegin_[band];
+  }
+  size_t answerOfBand(int band, size_t k) const {
+    return ranked_[bandBegin_[band] + k];
+  }
+
+  // Return the position of an answer of the given band picked by the given
+  // random number generator.
+  size_t pick(int band, Random* random) const {
+    return answerOfBand(band, random->uniform(bandSize(band)));
+  }
+
+ private:
+  // Unmap the file if one is mapped.
+  void close();
+
+  // The mapped file.
+  const uint8_t* data_;
+  size_t size_;
+  size_t numAnswers_;
+  int numBands_;
+  const Entry* entries_;
+  const uint32_t* bandBegin_;
+  const uint32_t* ranked_;
+};
+
+static_assert(sizeof(DifficultyTable::Entry) == 8,
+              "entries are written as they are");
+
+#endif  // DIFFICULTYTABLE_H_
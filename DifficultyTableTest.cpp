@@ -0,0 +1,153 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "./DecisionTree.h"
+#include "./DifficultyTable.h"
+#include "./EquationIndex.h"
+#include "./Random.h"
+#include "./Simulation.h"
+#include "./Solver.h"
+#include "./ThreadPool.h"
+
+namespace {
+// Return the contents of the file at path.
+std::string contents(const char* path) {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream data;
+  data << file.rdbuf();
+  return data.str();
+}
+}  // namespace
+
+
+TEST(DifficultyTableTest, build) {
+  const EquationIndex answers = EquationIndex::classic().sample(50);
+  ThreadPool serialPool(1);
+  ThreadPool parallelPool(4);
+  DifficultyTable::Options options;
+  options.gamesPerAnswer = 8;
+  options.numBands = 4;
+  const char* path = "/tmp/DifficultyTableTest.table";
+  ASSERT_TRUE(DifficultyTable::build(answers, &serialPool, options, path));
+  const std::string serial = contents(path);
+  // The same table on any number of threads.
+  ASSERT_TRUE(DifficultyTable::build(answers, &parallelPool, options, path));
+  ASSERT_EQ(contents(path), serial);
+
+  DifficultyTable table;
+  ASSERT_TRUE(table.open(path, answers));
+  ASSERT_EQ(table.numAnswers(), answers.size());
+  ASSERT_EQ(table.numBands(), 4);
+  size_t numRanked = 0;
+  double lastExpected = 0;
+  for (int band = 0; band < table.numBands(); ++band) {
+    ASSERT_GE(table.bandSize(band), answers.size() / 4);
+    ASSERT_LE(table.bandSize(band), answers.size() / 4 + 1);
+    for (size_t k = 0; k < table.bandSize(band); ++k) {
+      const size_t i = table.answerOfBand(band, k);
+      ASSERT_EQ(table.band(i), band);
+      // easiest first
+      ASSERT_GE(table.expectedGuesses(i), lastExpected);
+      lastExpected = table.expectedGuesses(i);
+      ASSERT_GE(table.expectedGuesses(i), 1);
+      ASSERT_LE(table.expectedGuesses(i), table.worstCase(i));
+      ASSERT_LE(table.worstCase(i), kNumRounds + 1);
+      ASSERT_GE(table.lateCandidates(i), 1);
+      ASSERT_EQ(table.solverGuesses(i), 0);
+      ++numRanked;
+    }
+  }
+  ASSERT_EQ(numRanked, answers.size());
+  ASSERT_LT(table.expectedGuesses(table.answerOfBand(0, 0)),
+            table.expectedGuesses(table.answerOfBand(3, 0)));
+  Random random(1);
+  for (int n = 0; n < 100; ++n) {
+    ASSERT_EQ(table.band(table.pick(2, &random)), 2);
+  }
+
+  // Another seed rates the answers a bit differently.
+  options.seed = 43;
+  ASSERT_TRUE(DifficultyTable::build(answers, &serialPool, options, path));
+  ASSERT_NE(contents(path), serial);
+  remove(path);
+}
+
+TEST(DifficultyTableTest, gameSeed) {
+  // No game is played twice, by any answer with any of neighbouring seeds.
+  std::set<uint64_t> seeds;
+  for (uint64_t seed = 42; seed < 46; ++seed) {
+    for (size_t i = 0; i < 1000; ++i) {
+      for (int game = 0; game < 8; ++game) {
+        seeds.insert(DifficultyTable::gameSeed(seed, i, game));
+      }
+    }
+  }
+  ASSERT_EQ(seeds.size(), 4u * 1000 * 8);
+}
+
+TEST(DifficultyTableTest, open) {
+  const EquationIndex answers = EquationIndex::classic().sample(50);
+  ThreadPool pool(1);
+  DifficultyTable::Options options;
+  options.gamesPerAnswer = 2;
+  const char* path = "/tmp/DifficultyTableTest.open.table";
+  DifficultyTable table;
+  ASSERT_FALSE(table.open(path, answers));
+  // Bands without answers aren't built.
+  options.numBands = 3;
+  ASSERT_FALSE(DifficultyTable::build(EquationIndex({answers.packed(0),
+                                                     answers.packed(1)}),
+                                      &pool, options, path));
+  ASSERT_FALSE(table.open(path, answers));
+  options.numBands = 5;
+  ASSERT_TRUE(DifficultyTable::build(answers, &pool, options, path));
+  ASSERT_TRUE(table.open(path, answers));
+  // A table of other answers isn't used.
+  ASSERT_FALSE(table.open(path, EquationIndex::classic()));
+  std::vector<uint32_t> others(answers.data(),
+                               answers.data() + answers.size());
+  others.back() = EquationIndex::classic().packed(1);
+  ASSERT_FALSE(table.open(path, EquationIndex(others)));
+  // A changed byte is noticed.
+  std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+  file.seekp(-1, std::ios::end);
+  file.put('\x7F');
+  file.close();
+  ASSERT_FALSE(table.open(path, answers));
+  remove(path);
+}
+
+TEST(DifficultyTableTest, solver) {
+  const EquationIndex answers = EquationIndex::classic().sample(50);
+  ThreadPool pool(2);
+  Solver solver(&answers, &answers, &pool);
+  const char* treePath = "/tmp/DifficultyTableTest.tree";
+  DecisionTree::Stats stats;
+  ASSERT_TRUE(DecisionTree::build(solver, &pool, DecisionTree::Options(),
+                                  treePath, &stats));
+  DecisionTree tree;
+  ASSERT_TRUE(tree.open(treePath));
+  DifficultyTable::Options options;
+  options.gamesPerAnswer = 2;
+  options.tree = &tree;
+  const char* path = "/tmp/DifficultyTableTest.solver.table";
+  ASSERT_TRUE(DifficultyTable::build(answers, &pool, options, path));
+  DifficultyTable table;
+  ASSERT_TRUE(table.open(path, answers));
+  // the guesses of the solver, one game per answer
+  uint64_t totalGuesses = 0;
+  for (size_t i = 0; i < answers.size(); ++i) {
+    ASSERT_EQ(table.solverGuesses(i), tree.guessesFor(answers.packed(i)));
+    ASSERT_GE(table.solverGuesses(i), 1);
+    totalGuesses += table.solverGuesses(i);
+  }
+  ASSERT_EQ(totalGuesses, stats.totalGuesses);
+  remove(path);
+  remove(treePath);
+}
@@ -0,0 +1,95 @@
+// Copyright 2022 Henrik Roth
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "./EquationClasses.h"
+#include "./EquationRules.h"
+
+// ____________________________________________________________________________
+EquationClasses::EquationClasses(const EquationIndex* index)
+    : index_(index), classes_(index->size()) {
+  std::unordered_map<std::string, uint32_t> classOfForm;
+  for (size_t i = 0; i < index->size(); ++i) {
+    const auto [it, isNew] = classOfForm.emplace(
+        canonical(index->equation(i)), representatives_.size());
+    if (isNew) {
+      representatives_.push_back(i);
+      classSizes_.push_back(0);
+    }
+    classes_[i] = it->second;
+    ++classSizes_[it->second];
+  }
+}
+
+// ____________________________________________________________________________
+std::string EquationClasses::canonical(const std::string& equation) {
+  const size_t eqPos = equation.find('=');
+  const int64_t rightSide = EquationRules::parseNumber(
+      equation.data() + eqPos + 1, equation.size() - eqPos - 1);
+
+  // Terms added and subtracted, the current one and its current run of
+  // factors that are multiplied.
+  std::vector<std::string> terms[2];
+  bool subtracted = false;
+  std::string term;
+  std::vector<int64_t> run;
+  auto endRun = [&]() {
+    if (run.empty()) { return; }
+    std::sort(run.begin(), run.end());
+    for (int64_t factor : run) {
+      if (!term.empty() && term.back() != '/') { term += '*'; }
+      term += std::to_string(factor);
+    }
+    run.clear();
+  };
+  char operation = '+';
+  size_t begin = 0;
+  // every number of the left side ends at an operator or at the '='
+  for (size_t i = 0; i <= eqPos; ++i) {
+    if (i < eqPos && isdigit(equation[i])) { continue; }
+    const int64_t number =
+        EquationRules::parseNumber(equation.data() + begin, i - begin);
+    // a divisor keeps its place, everything else is a factor of a run
+    if (operation == '/') {
+      term += std::to_string(number);
+    } else {
+      run.push_back(number);
+    }
+    if (i == eqPos) { break; }
+    operation = equation[i];
+    begin = i + 1;
+    if (operation == '+' || operation == '-') {
+      endRun();
+      terms[subtracted].push_back(term);
+      term.clear();
+      subtracted = operation == '-';
+    } else if (operation == '/') {
+      endRun();
+      term += '/';
+    }
+  }
+  endRun();
+  terms[subtracted].push_back(term);
+
+  std::string form;
+  for (bool sub : {false, true}) {
+    std::sort(terms[sub].begin(), terms[sub].end());
+    for (const std::string& t : terms[sub]) {
+      if (!form.empty() || sub) { form += sub ? '-' : '+'; }
+      form += t;
+    }
+  }
+  return form + "=" + std::to_string(rightSide);
+}
+
+// ____________________________________________________________________________
+std::vector<uint32_t> EquationClasses::representatives() const {
+  std::vector<uint32_t> packed;
+  packed.reserve(representatives_.size());
+  for (size_t i : representatives_) { packed.push_back(index_->packed(i)); }
+  std::sort(packed.begin(), packed.end());
+  return packed;
+}
@@ -0,0 +1,59 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef EQUATIONCLASSES_H_
+#define EQUATIONCLASSES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "./EquationIndex.h"
+
+// Groups the equations of an index into classes of equations that are the
+// same up to commutativity, f.e. "12+34=46" and "34+12=46", or "2*3*7=42"
+// and "7*2*3=42". Two equations are in one class if the terms of the left
+// side can be reordered, keeping their signs, and the factors of every run
+// of multiplications in a term can be reordered, so that both are the same.
+// Such reorderings keep the value and don't make an operation illegal (see
+// EquationRules::Evaluator). Divisors keep their place: "8/4*2" and
+// "2/4*8" are different.
+//
+// Note that the members of a class get different feedback as guesses, so a
+// solver can't skip them; the classes are meant for the answers, f.e. to
+// allow only one member of each class.
+class EquationClasses {
+ public:
+  // Group the equations of the given index, which must outlive this.
+  explicit EquationClasses(const EquationIndex* index);
+
+  // Return the canonical form of the given correct equation, the same for
+  // all members of its class: the terms added, then the terms subtracted,
+  // both sorted, with the factors of every run of multiplications sorted by
+  // value. F.e. "9-3+4*1=10" -> "1*4+9-3=10".
+  static std::string canonical(const std::string& equation);
+
+  // Number of equations and of classes.
+  size_t size() const { return classes_.size(); }
+  size_t numClasses() const { return representatives_.size(); }
+
+  // Return the class of the equation at the given position of the index.
+  // Classes are numbered in the order of their first member.
+  uint32_t classOf(size_t i) const { return classes_[i]; }
+
+  // Return the position of the first member of the given class and the
+  // number of its members.
+  size_t representative(uint32_t c) const { return representatives_[c]; }
+  size_t classSize(uint32_t c) const { return classSizes_[c]; }
+
+  // Return the packed representatives of all classes, sorted, f.e. to
+  // build an index of answers with one member of each class.
+  std::vector<uint32_t> representatives() const;
+
+ private:
+  const EquationIndex* index_;
+  std::vector<uint32_t> classes_;
+  std::vector<size_t> representatives_;
+  std::vector<uint32_t> classSizes_;
+};
+
+#endif  // EQUATIONCLASSES_H_
@@ -0,0 +1,66 @@
+// Copyright 2022 Henrik Roth
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include "./EquationClasses.h"
+#include "./EquationIndex.h"
+#include "./PackedEquation.h"
+
+
+// Group the classic equations into classes that are the same up to
+// commutativity and report how much that shrinks the space of answers, or
+// print one equation of every class.
+int main(int argc, char** argv) {
+  bool list = false;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--representatives") == 0) {
+      list = true;
+    } else {
+      usage = true;
+    }
+  }
+  if (usage) {
+    std::cerr << "Usage: " << argv[0] << " [--representatives]" << std::endl;
+    return 1;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const EquationIndex& index = EquationIndex::classic();
+  const EquationClasses classes(&index);
+  const double milliseconds = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+  if (list) {
+    for (uint32_t packed : classes.representatives()) {
+      std::cout << PackedEquation::unpack(packed) << std::endl;
+    }
+    return 0;
+  }
+
+  std::map<size_t, size_t> numClassesOfSize;
+  uint32_t largest = 0;
+  for (uint32_t c = 0; c < classes.numClasses(); ++c) {
+    ++numClassesOfSize[classes.classSize(c)];
+    if (classes.classSize(c) > classes.classSize(largest)) { largest = c; }
+  }
+  const double factor = static_cast<double>(classes.size())
+                        / classes.numClasses();
+  std::cout << classes.size() << " equations in " << classes.numClasses()
+            << " classes, " << factor << " times fewer answers and "
+            << factor * factor << " times fewer pairs of them, "
+            << milliseconds << " ms" << std::endl;
+  for (const auto& [size, numClasses] : numClassesOfSize) {
+    std::cout << "  classes of " << size << ": " << numClasses << std::endl;
+  }
+  std::cout << "Largest class:";
+  for (size_t i = 0; i < classes.size(); ++i) {
+    if (classes.classOf(i) == largest) {
+      std::cout << " " << index.equation(i);
+    }
+  }
+  std::cout << std::endl;
+  return 0;
+}
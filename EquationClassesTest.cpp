@@ -0,0 +1,73 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "./EquationClasses.h"
+#include "./EquationIndex.h"
+#include "./EquationRules.h"
+#include "./PackedEquation.h"
+
+
+TEST(EquationClassesTest, canonical) {
+  ASSERT_EQ(EquationClasses::canonical("12+34=46"), "12+34=46");
+  ASSERT_EQ(EquationClasses::canonical("34+12=46"), "12+34=46");
+  ASSERT_EQ(EquationClasses::canonical("9-3+4*1=10"), "1*4+9-3=10");
+  ASSERT_EQ(EquationClasses::canonical("4*1-3+9=10"), "1*4+9-3=10");
+  ASSERT_EQ(EquationClasses::canonical("99-8-9=82"), "99-8-9=82");
+  ASSERT_EQ(EquationClasses::canonical("99-9-8=82"), "99-8-9=82");
+  ASSERT_EQ(EquationClasses::canonical("7*2*3=42"), "2*3*7=42");
+  // Divisors keep their place, the runs of factors around them don't.
+  ASSERT_EQ(EquationClasses::canonical("8*3/4=6"), "3*8/4=6");
+  ASSERT_EQ(EquationClasses::canonical("8/4*3=6"), "8/4*3=6");
+  ASSERT_EQ(EquationClasses::canonical("9/3*5*2=30"), "9/3*2*5=30");
+  ASSERT_EQ(EquationClasses::canonical("2-1=1"),
+            EquationClasses::canonical("2-1=1"));
+  ASSERT_NE(EquationClasses::canonical("2*3=6"),
+            EquationClasses::canonical("3+3=6"));
+}
+
+TEST(EquationClassesTest, classes) {
+  const EquationIndex& index = EquationIndex::classic();
+  const EquationClasses classes(&index);
+  ASSERT_EQ(classes.size(), index.size());
+  ASSERT_LT(classes.numClasses(), index.size() * 2 / 3);
+  size_t numMembers = 0;
+  for (uint32_t c = 0; c < classes.numClasses(); ++c) {
+    const size_t first = classes.representative(c);
+    ASSERT_EQ(classes.classOf(first), c);
+    // Classes are numbered in the order of their first member.
+    if (c > 0) { ASSERT_GT(first, classes.representative(c - 1)); }
+    numMembers += classes.classSize(c);
+  }
+  ASSERT_EQ(numMembers, index.size());
+  // Members of a class have the same canonical form, all of which are
+  // different from those of other classes.
+  std::vector<std::string> forms(classes.numClasses());
+  for (size_t i = 0; i < index.size(); ++i) {
+    const std::string form = EquationClasses::canonical(index.equation(i));
+    if (classes.representative(classes.classOf(i)) == i) {
+      forms[classes.classOf(i)] = form;
+    }
+    ASSERT_EQ(form, forms[classes.classOf(i)]);
+  }
+  std::sort(forms.begin(), forms.end());
+  ASSERT_EQ(std::unique(forms.begin(), forms.end()), forms.end());
+
+  std::string equation = "12+34=46";
+  std::string swapped = "34+12=46";
+  const size_t i = index.find(PackedEquation::pack(&equation));
+  const size_t j = index.find(PackedEquation::pack(&swapped));
+  ASSERT_EQ(classes.classOf(i), classes.classOf(j));
+  ASSERT_EQ(classes.classSize(classes.classOf(i)), 2u);
+
+  // One correct equation of every class, sorted.
+  const std::vector<uint32_t> representatives = classes.representatives();
+  ASSERT_EQ(representatives.size(), classes.numClasses());
+  ASSERT_TRUE(std::is_sorted(representatives.begin(),
+                             representatives.end()));
+  for (uint32_t packed : representatives) {
+    ASSERT_TRUE(EquationRules::isLegal(PackedEquation::unpack(packed)));
+  }
+}
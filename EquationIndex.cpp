@@ -0,0 +1,139 @@
+// Copyright 2022 Henrik Roth
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./EquationTable.h"
+#include "./PackedEquation.h"
+
+// ____________________________________________________________________________
+const EquationIndex& EquationIndex::classic() {
+  static const EquationIndex index(kClassicEquations.equations,
+                                   kClassicEquations.size);
+  return index;
+}
+
+// ____________________________________________________________________________
+EquationIndex::EquationIndex(std::vector<uint32_t> equations)
+    : storage_(std::move(equations)) {
+  std::sort(storage_.begin(), storage_.end());
+  equations_ = storage_.data();
+  size_ = storage_.size();
+}
+
+// ____________________________________________________________________________
+EquationIndex::EquationIndex(const uint32_t* equations, size_t size)
+    : equations_(equations), size_(size) {}
+
+// ____________________________________________________________________________
+std::string EquationIndex::equation(size_t i) const {
+  return PackedEquation::unpack(equations_[i]);
+}
+
+// ____________________________________________________________________________
+int64_t EquationIndex::find(uint32_t packed) const {
+  const uint32_t* it = std::lower_bound(equations_, equations_ + size_,
+                                        packed);
+  if (it == equations_ + size_ || *it != packed) { return -1; }
+  return it - equations_;
+}
+
+// ____________________________________________________________________________
+EquationIndex EquationIndex::sample(size_t stride) const {
+  std::vector<uint32_t> equations;
+  for (size_t i = 0; i < size_; i += stride) {
+    equations.push_back(equations_[i]);
+  }
+  return EquationIndex(std::move(equations));
+}
+
+// ____________________________________________________________________________
+std::vector<uint32_t> EquationIndex::enumerate() {
+  std::vector<uint32_t> equations;
+  char lhs[kEquationLength];
+  // The left side needs at least three symbols ("1+2") and the right side
+  // at least one digit.
+  for (int length = 3; length <= kEquationLength - 2; ++length) {
+    extendLeftSide(lhs, 0, length, false, &equations);
+  }
+  std::sort(equations.begin(), equations.end());
+  return equations;
+}
+
+// ____________________________________________________________________________
+void EquationIndex::extendLeftSide(char* lhs, int pos, int length,
+                                   bool operationAppeared,
+                                   std::vector<uint32_t>* equations) {
+  if (pos == length) {
+    if (!operationAppeared) { return; }
+    const int64_t result = evaluateLeftSide(lhs, length);
+    if (result < 0) { return; }
+    std::string equation(lhs, length);
+    equation += "=" + std::to_string(result);
+    if (equation.length() == kEquationLength) {
+      equations->push_back(PackedEquation::pack(&equation));
+    }
+    return;
+  }
+  const bool lastIsDigit = pos > 0 && std::isdigit(lhs[pos - 1]);
+  // a zero that doesn't follow another digit can't be followed by a digit
+  const bool lastIsLeadingZero = lastIsDigit && lhs[pos - 1] == '0'
+                                && (pos == 1 || !std::isdigit(lhs[pos - 2]));
+  if (!lastIsLeadingZero) {
+    for (char digit = '0'; digit <= '9'; ++digit) {
+      lhs[pos] = digit;
+      extendLeftSide(lhs, pos + 1, length, operationAppeared, equations);
+    }
+  }
+  // arithmetic symbols only between two numbers
+  if (lastIsDigit && pos < length - 1) {
+    for (char symbol : {'+', '-', '*', '/'}) {
+      lhs[pos] = symbol;
+      extendLeftSide(lhs, pos + 1, length, true, equations);
+    }
+  }
+}
+
+// ____________________________________________________________________________
+int64_t EquationIndex::evaluateLeftSide(const char* lhs, int length) {
+  int64_t result = 0;  // sum of all finished terms
+  int64_t term = 0;  // current term, products and quotients already applied
+  int64_t operand = 0;  // number that is currently read
+  int64_t lastOperand = 0;  // number left of the current * or /
+  char sign = '+';  // sign of the current term
+  char operation = ' ';  // * or / pending between lastOperand and operand
+  for (int i = 0; i <= length; ++i) {
+    if (i < length && std::isdigit(lhs[i])) {
+      operand = 10 * operand + (lhs[i] - '0');
+      continue;
+    }
+    // a number ended, apply a pending * or /
+    if (operation == ' ') {
+      term = operand;
+    } else {
+      // x * 0, 0 * x, x / 0 and 0 / x not allowed
+      if (lastOperand == 0 || operand == 0) { return -1; }
+      if (operation == '*') {
+        term *= operand;
+      } else {
+        // calculations leading to non-integer results not allowed
+        if (term % operand != 0) { return -1; }
+        term /= operand;
+      }
+    }
+    if (i == length || lhs[i] == '+' || lhs[i] == '-') {
+      result += sign == '+' ? term : -term;
+      sign = i < length ? lhs[i] : '+';
+      operation = ' ';
+    } else {
+      operation = lhs[i];
+    }
+    lastOperand = operand;
+    operand = 0;
+  }
+  return result;
+}
@@ -0,0 +1,76 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef EQUATIONINDEX_H_
+#define EQUATIONINDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Index of every equation that can be the answer of a classic game, meaning
+// every syntactically and contentwise correct equation of length 8.
+// The equations are stored packed (see PackedEquation) and sorted, so
+// picking a random answer is a single array access.
+class EquationIndex {
+ public:
+  // Return the index of the classic game. It is a view on the table the
+  // compiler generated (see EquationTable), so using it costs nothing.
+  static const EquationIndex& classic();
+
+  // Build the index from the given packed equations.
+  explicit EquationIndex(std::vector<uint32_t> equations);
+
+  // Build an index on the given sorted packed equations without copying
+  // them. The equations must outlive the index.
+  EquationIndex(const uint32_t* equations, size_t size);
+
+  // Number of equations in the index.
+  size_t size() const { return size_; }
+
+  // Return the i-th equation, packed or as a string.
+  uint32_t packed(size_t i) const { return equations_[i]; }
+  std::string equation(size_t i) const;
+
+  // Return all packed equations as one contiguous array.
+  const uint32_t* data() const { return equations_; }
+
+  // Return the position of the given packed equation in the index or -1 if
+  // it isn't part of the index.
+  int64_t find(uint32_t packed) const;
+
+  // Return an index of every stride-th equation, starting with the first,
+  // f.e. a small but varied set of answers for tests.
+  EquationIndex sample(size_t stride) const;
+
+  // Walk the full space of equations of length 8 once and return every
+  // correct one, packed and sorted. Follows the same rules as
+  // Nerdle::isEquationSyntactic and Nerdle::computeEquation: no leading
+  // zeros, at least one arithmetic symbol left of the equal sign, no x * 0,
+  // 0 * x, x / 0 or 0 / x and only divisions without remainder. This is the
+  // runtime counterpart of EquationTable, which must hold exactly the same
+  // equations.
+  static std::vector<uint32_t> enumerate();
+
+ private:
+  // Append every legal symbol at position pos of the left side lhs of an
+  // equation and recurse until the left side has the given length. Complete
+  // left sides are evaluated and, if "=result" fills the remaining cells,
+  // appended to equations.
+  static void extendLeftSide(char* lhs, int pos, int length,
+                             bool operationAppeared,
+                             std::vector<uint32_t>* equations);
+
+  // Compute the value of the given left side of an equation.
+  // Will return -1 if it does "illegal" arithmetic operations
+  // (see Nerdle::computeEquation).
+  static int64_t evaluateLeftSide(const char* lhs, int length);
+
+  // The packed equations, sorted, and their number. They either point into
+  // storage_ or to a table the index doesn't own.
+  std::vector<uint32_t> storage_;
+  const uint32_t* equations_;
+  size_t size_;
+};
+
+#endif  // EQUATIONINDEX_H_
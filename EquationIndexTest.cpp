@@ -0,0 +1,58 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./EquationTable.h"
+#include "./PackedEquation.h"
+
+
+TEST(EquationIndexTest, enumerate) {
+  std::vector<uint32_t> equations = EquationIndex::enumerate();
+  ASSERT_EQ(equations.size(), 18290);
+  for (size_t i = 1; i < equations.size(); ++i) {
+    ASSERT_LT(equations[i - 1], equations[i]);  // sorted and unique
+  }
+  ASSERT_EQ(PackedEquation::unpack(equations.front()), "0+10-1=9");
+}
+
+TEST(EquationIndexTest, classicTable) {
+  // the table generated by the compiler and the runtime enumeration must
+  // hold the same equations
+  std::vector<uint32_t> equations = EquationIndex::enumerate();
+  ASSERT_EQ(kClassicEquations.size, equations.size());
+  for (size_t i = 0; i < equations.size(); ++i) {
+    ASSERT_EQ(kClassicEquations.equations[i], equations[i]);
+  }
+  ASSERT_EQ(EquationIndex::classic().size(), kNumClassicEquations);
+}
+
+TEST(EquationIndexTest, find) {
+  const EquationIndex& index = EquationIndex::classic();
+  std::string test0 = "42-10=32";  // legal equation
+  std::string test1 = "20*5=100";
+  std::string test2 = "42+10=13";  // not correct
+  std::string test3 = "0*1337=0";  // x * 0 not allowed
+  std::string test4 = "42*02=84";  // leading zero
+  ASSERT_NE(index.find(PackedEquation::pack(&test0)), -1);
+  ASSERT_NE(index.find(PackedEquation::pack(&test1)), -1);
+  ASSERT_EQ(index.find(PackedEquation::pack(&test2)), -1);
+  ASSERT_EQ(index.find(PackedEquation::pack(&test3)), -1);
+  ASSERT_EQ(index.find(PackedEquation::pack(&test4)), -1);
+  for (size_t i = 0; i < index.size(); i += 97) {
+    ASSERT_EQ(index.find(index.packed(i)), i);
+    std::string eq = index.equation(i);
+    ASSERT_EQ(PackedEquation::pack(&eq), index.packed(i));
+  }
+}
+
+TEST(EquationIndexTest, sample) {
+  const EquationIndex& index = EquationIndex::classic();
+  const EquationIndex sample = index.sample(50);
+  ASSERT_EQ(sample.size(), (index.size() + 49) / 50);
+  for (size_t i = 0; i < sample.size(); ++i) {
+    ASSERT_EQ(sample.packed(i), index.packed(50 * i));
+  }
+  ASSERT_EQ(index.sample(1).size(), index.size());
+}
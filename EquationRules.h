@@ -0,0 +1,206 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef EQUATIONRULES_H_
+#define EQUATIONRULES_H_
+
+#include <cstdint>
+#include <string_view>
+#include "./PackedEquation.h"
+
+// The rules of the classic game as constexpr functions, so that they can
+// be evaluated by the compiler (see EquationTable). They follow the rules
+// of Nerdle::isEquationSyntactic, Nerdle::computeEquation and
+// Nerdle::isEquationCorrect exactly.
+class EquationRules {
+ public:
+  // Return true if a given string is a syntactically correct equation
+  // (see Nerdle::isEquationSyntactic).
+  static constexpr bool isSyntactic(std::string_view eq) {
+    return isSyntactic(eq.data(), eq.length());
+  }
+  // Same as above on a raw character buffer. The compiler evaluates this
+  // form much faster than the std::string_view one. Equations of game
+  // variants have another requiredLength (see Variant).
+  static constexpr bool isSyntactic(const char* eq, size_t length,
+                                    size_t requiredLength = kEquationLength) {
+    if (length != requiredLength) { return false; }
+    bool symbolAllowed = false;
+    bool numberAllowed = true;
+    int numEq = 0;
+    for (size_t i = 0; i < length; ++i) {
+      if (eq[i] < '0' || eq[i] > '9') {
+        if (!symbolAllowed || numEq > 0) { return false; }
+        if (eq[i] == '=') {
+          ++numEq;
+        } else if (eq[i] != '+' && eq[i] != '-' && eq[i] != '*'
+                                                 && eq[i] != '/') {
+          return false;
+        }
+        symbolAllowed = false;
+        numberAllowed = true;
+      } else {
+        if (!numberAllowed) { return false; }
+        symbolAllowed = true;
+        // a zero that doesn't follow another digit is a whole number
+        numberAllowed = eq[i] != '0'
+                        || (i > 0 && '0' <= eq[i - 1] && eq[i - 1] <= '9');
+      }
+    }
+    return numEq == 1;
+  }
+
+  // Evaluates an expression in a single pass from left to right, fed one
+  // number and one arithmetic symbol at a time, without allocating. The
+  // value follows Nerdle::computeEquation: * and / before + and -, and -1
+  // for "illegal" arithmetic operations (x * 0, 0 * x, x / 0, 0 / x and
+  // divisions with remainder). Overflowing int64 is illegal as well.
+  class Evaluator {
+   public:
+    // Feed the next number of the expression.
+    constexpr void number(int64_t value) {
+      if (operation_ == ' ') {
+        term_ = value;
+      } else if (lastNumber_ == 0 || value == 0) {
+        illegal_ = true;
+      } else if (operation_ == '*') {
+        illegal_ |= __builtin_mul_overflow(term_, value, &term_);
+      } else {
+        illegal_ |= term_ % value != 0;
+        term_ = illegal_ ? 0 : term_ / value;
+      }
+      lastNumber_ = value;
+    }
+
+    // Feed the arithmetic symbol (+, -, * or /) after the last number.
+    constexpr void symbol(char symbol) {
+      if (symbol == '+' || symbol == '-') {
+        addTerm();
+        sign_ = symbol;
+        operation_ = ' ';
+      } else {
+        operation_ = symbol;
+      }
+    }
+
+    // Return the value of the expression fed so far, ending with a number.
+    constexpr int64_t value() {
+      addTerm();
+      operation_ = ' ';
+      return illegal_ ? -1 : result_;
+    }
+
+   private:
+    // Add the current term to the result.
+    constexpr void addTerm() {
+      illegal_ |= sign_ == '+'
+                  ? __builtin_add_overflow(result_, term_, &result_)
+                  : __builtin_sub_overflow(result_, term_, &result_);
+      term_ = 0;
+    }
+
+    int64_t result_ = 0;  // sum of all finished terms
+    int64_t term_ = 0;  // current term, products and quotients applied
+    int64_t lastNumber_ = 0;  // number left of the pending * or /
+    char sign_ = '+';  // sign of the current term
+    char operation_ = ' ';  // * or / pending between the last two numbers
+    bool illegal_ = false;
+  };
+
+  // Return the value of the given number without sign, f.e. "0042" -> 42,
+  // or -1 if it isn't one or doesn't fit into int64.
+  static constexpr int64_t parseNumber(std::string_view number) {
+    return parseNumber(number.data(), number.length());
+  }
+  static constexpr int64_t parseNumber(const char* number, size_t length) {
+    if (length == 0) { return -1; }
+    int64_t value = 0;
+    for (size_t i = 0; i < length; ++i) {
+      if (number[i] < '0' || number[i] > '9' ||
+          __builtin_mul_overflow(value, 10, &value) ||
+          __builtin_add_overflow(value, number[i] - '0', &value)) {
+        return -1;
+      }
+    }
+    return value;
+  }
+
+  // Compute the value of the given expression, f.e. "187-42*3" -> 61.
+  // Will return -1 if the expression does "illegal" arithmetic operations
+  // (see Evaluator). The expression must consist of numbers separated by
+  // single arithmetic symbols.
+  static constexpr int64_t compute(std::string_view expr) {
+    return compute(expr.data(), expr.length());
+  }
+  static constexpr int64_t compute(const char* expr, size_t length) {
+    Evaluator evaluator;
+    size_t begin = 0;
+    for (size_t i = 0; i <= length; ++i) {
+      if (i < length && '0' <= expr[i] && expr[i] <= '9') { continue; }
+      const int64_t number = parseNumber(expr + begin, i - begin);
+      if (number < 0) { return -1; }
+      evaluator.number(number);
+      if (i < length) { evaluator.symbol(expr[i]); }
+      begin = i + 1;
+    }
+    return evaluator.value();
+  }
+
+  // Return true if the values left and right of the equal sign of a
+  // syntactically correct equation are equal (see Nerdle::isEquationCorrect).
+  static constexpr bool isCorrect(std::string_view eq) {
+    return isCorrect(eq.data(), eq.length());
+  }
+  static constexpr bool isCorrect(const char* eq, size_t length) {
+    size_t eqPos = 0;
+    while (eqPos < length && eq[eqPos] != '=') { ++eqPos; }
+    const int64_t rightSide = parseNumber(eq + eqPos + 1, length - eqPos - 1);
+    // nothing or no number right of =
+    if (rightSide < 0) { return false; }
+    return compute(eq, eqPos) == rightSide;
+  }
+
+  // Return true if the given string could be the answer of a game, the
+  // same as isSyntactic && isCorrect. Checks and evaluates the equation in
+  // a single pass.
+  static constexpr bool isLegal(std::string_view eq) {
+    return isLegal(eq.data(), eq.length());
+  }
+  static constexpr bool isLegal(const char* eq, size_t length,
+                                size_t requiredLength = kEquationLength) {
+    if (length != requiredLength) { return false; }
+    Evaluator evaluator;
+    int64_t number = 0;
+    int64_t leftSide = -1;
+    bool inNumber = false;  // the last symbol was a digit
+    bool zero = false;  // the last symbol was a zero that is a whole number
+    for (size_t i = 0; i < length; ++i) {
+      const char c = eq[i];
+      if ('0' <= c && c <= '9') {
+        if (zero) { return false; }  // leading zero
+        zero = !inNumber && c == '0';
+        number = 10 * number + (c - '0');
+        inNumber = true;
+        continue;
+      }
+      // arithmetic symbols only between numbers and left of the equal sign
+      if (!inNumber || leftSide != -1) { return false; }
+      evaluator.number(number);
+      if (c == '=') {
+        leftSide = evaluator.value();
+        // -1 is also the value of illegal expressions, no legal equation
+        // has it as its right side
+        if (leftSide < 0) { return false; }
+      } else if (c == '+' || c == '-' || c == '*' || c == '/') {
+        evaluator.symbol(c);
+      } else {
+        return false;
+      }
+      number = 0;
+      inNumber = false;
+      zero = false;
+    }
+    return inNumber && leftSide == number;
+  }
+};
+
+#endif  // EQUATIONRULES_H_
@@ -0,0 +1,250 @@
+// Copyright 2022 Henrik Roth
+
+#include <cstddef>
+#include <cstdint>
+#include "./EquationTable.h"
+#include "./EquationRules.h"
+#include "./PackedEquation.h"
+
+namespace {
+
+// Smallest and largest number with the given number of digits.
+constexpr int64_t smallestNumber(int digits) {
+  int64_t number = digits == 1 ? 0 : 1;
+  for (int i = 1; i < digits; ++i) { number *= 10; }
+  return number;
+}
+constexpr int64_t largestNumber(int digits) {
+  int64_t number = 1;
+  for (int i = 0; i < digits; ++i) { number *= 10; }
+  return number - 1;
+}
+
+// Division rounding towards negative / positive infinity.
+constexpr int64_t floorDiv(int64_t a, int64_t b) {
+  return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+constexpr int64_t ceilDiv(int64_t a, int64_t b) {
+  return a / b + (a % b != 0 && (a < 0) == (b < 0));
+}
+
+// Write number into buf at pos with exactly the given number of digits and
+// return the position after it.
+constexpr int writeNumber(char* buf, int pos, int64_t number, int digits) {
+  for (int i = digits - 1; i >= 0; --i) {
+    buf[pos + i] = '0' + number % 10;
+    number /= 10;
+  }
+  return pos + digits;
+}
+
+// Check the given candidate with the constexpr rules and add it to the
+// table if it is legal. Finding more than kNumClassicEquations equations
+// writes beyond the table, which stops the compilation.
+constexpr void addIfLegal(const char* eq, EquationTable* table) {
+  if (!EquationRules::isLegal(eq, kEquationLength)) { return; }
+  uint32_t packed = 0;
+  for (int i = 0; i < kEquationLength; ++i) {
+    const char c = eq[i];
+    packed = (packed << 4) | ('0' <= c && c <= '9' ? c - '0'
+                              : c == '+' ? 10 : c == '-' ? 11
+                              : c == '*' ? 12 : c == '/' ? 13 : 14);
+  }
+  table->equations[table->size++] = packed;
+}
+
+// Enumerate the last number of a left side "<prefix> op c" with c having
+// the given number of digits. Instead of trying every c, only those are
+// tried for which the value of the left side has resultDigits digits.
+// sum is the sum of the finished terms of the prefix and term its last
+// term with the given sign. The value is only used to find candidates,
+// every candidate is checked with the rules before it is added.
+constexpr void addLastNumber(char* buf, int pos, int64_t sum, int64_t term,
+                             int sign, char op, int digits, int resultDigits,
+                             EquationTable* table) {
+  const int64_t lo = smallestNumber(resultDigits);
+  const int64_t hi = largestNumber(resultDigits);
+  int64_t first = smallestNumber(digits);
+  int64_t last = largestNumber(digits);
+  const int64_t base = sum + sign * term;
+  if (op == '+') {
+    first = first > lo - base ? first : lo - base;
+    last = last < hi - base ? last : hi - base;
+  } else if (op == '-') {
+    first = first > base - hi ? first : base - hi;
+    last = last < base - lo ? last : base - lo;
+  } else if (term <= 0) {
+    return;  // multiplying or dividing 0 is not allowed
+  } else if (op == '*') {
+    // sum + sign * term * c must lie in [lo, hi]
+    const int64_t low = sign > 0 ? lo - sum : sum - hi;
+    const int64_t high = sign > 0 ? hi - sum : sum - lo;
+    first = first > ceilDiv(low, term) ? first : ceilDiv(low, term);
+    last = last < floorDiv(high, term) ? last : floorDiv(high, term);
+  } else {
+    // sum + sign * (term / c) must lie in [lo, hi] with term / c >= 1
+    int64_t low = sign > 0 ? lo - sum : sum - hi;
+    const int64_t high = sign > 0 ? hi - sum : sum - lo;
+    low = low > 1 ? low : 1;
+    if (high < low) { return; }
+    first = first > ceilDiv(term, high) ? first : ceilDiv(term, high);
+    last = last < term / low ? last : term / low;
+  }
+  buf[pos] = op;
+  buf[pos + 1 + digits] = '=';
+  for (int64_t c = first; c <= last; ++c) {
+    int64_t value = base + c;
+    if (op == '-') {
+      value = base - c;
+    } else if (op == '*') {
+      value = sum + sign * term * c;
+    } else if (op == '/') {
+      if (term % c != 0) { continue; }
+      value = sum + sign * (term / c);
+    }
+    if (value < lo || value > hi) { continue; }
+    writeNumber(buf, pos + 1, c, digits);
+    writeNumber(buf, pos + 2 + digits, value, resultDigits);
+    addIfLegal(buf, table);
+  }
+}
+
+// Sort the table with a radix sort, one byte at a time, since std::sort
+// isn't constexpr in C++17 and the compiler is slow at evaluating the many
+// comparisons of a comparison sort.
+constexpr void sortTable(EquationTable* table) {
+  uint32_t buffer[kNumClassicEquations] = {};
+  uint32_t* from = table->equations;
+  uint32_t* to = buffer;
+  for (int shift = 0; shift < 32; shift += 8) {
+    size_t start[257] = {};
+    for (size_t i = 0; i < table->size; ++i) {
+      ++start[((from[i] >> shift) & 0xFF) + 1];
+    }
+    for (int b = 0; b < 256; ++b) { start[b + 1] += start[b]; }
+    for (size_t i = 0; i < table->size; ++i) {
+      to[start[(from[i] >> shift) & 0xFF]++] = from[i];
+    }
+    uint32_t* tmp = from;
+    from = to;
+    to = tmp;
+  }
+  // after an even number of passes the result is back in the table
+}
+
+// Enumerate every legal equation. A left side of at most 6 symbols holds
+// one or two arithmetic symbols, so it is "a op c" or "a op b op c". Every
+// a and b is tried, c is handled by addLastNumber.
+constexpr EquationTable generateTable() {
+  EquationTable table{};
+  const char ops[] = {'+', '-', '*', '/'};
+  char buf[kEquationLength] = {};
+  for (int lhsLength = 3; lhsLength <= kEquationLength - 2; ++lhsLength) {
+    const int resultDigits = kEquationLength - 1 - lhsLength;
+    const int64_t lo = smallestNumber(resultDigits);
+    const int64_t hi = largestNumber(resultDigits);
+    // one arithmetic symbol: a op c, only values of a for which some c
+    // gives a result with resultDigits digits are tried
+    for (int aDigits = 1; aDigits <= lhsLength - 2; ++aDigits) {
+      const int cDigits = lhsLength - 1 - aDigits;
+      const int64_t cFirst = smallestNumber(cDigits);
+      const int64_t cLast = largestNumber(cDigits);
+      for (char op : ops) {
+        int64_t first = smallestNumber(aDigits);
+        int64_t last = largestNumber(aDigits);
+        if (op == '+' && last > hi - cFirst) { last = hi - cFirst; }
+        if (op == '-' && last > hi + cLast) { last = hi + cLast; }
+        if (op == '-' && first < lo + cFirst) { first = lo + cFirst; }
+        if (op == '*' && last > hi) { last = hi; }
+        if (op == '/' && first < lo) { first = lo; }
+        if (op == '/' && last > hi * cLast) { last = hi * cLast; }
+        for (int64_t a = first; a <= last; ++a) {
+          const int pos = writeNumber(buf, 0, a, aDigits);
+          addLastNumber(buf, pos, 0, a, 1, op, cDigits, resultDigits, &table);
+        }
+      }
+    }
+    // two arithmetic symbols: a op1 b op2 c
+    for (int aDigits = 1; aDigits <= lhsLength - 4; ++aDigits) {
+      for (int bDigits = 1; aDigits + bDigits <= lhsLength - 3; ++bDigits) {
+        const int cDigits = lhsLength - 2 - aDigits - bDigits;
+        for (int64_t a = smallestNumber(aDigits);
+                                          a <= largestNumber(aDigits); ++a) {
+          for (int64_t b = smallestNumber(bDigits);
+                                          b <= largestNumber(bDigits); ++b) {
+            for (char op1 : ops) {
+              int pos = writeNumber(buf, 0, a, aDigits);
+              buf[pos] = op1;
+              pos = writeNumber(buf, pos + 1, b, bDigits);
+              if (op1 == '+' || op1 == '-') {
+                for (char op2 : ops) {
+                  addLastNumber(buf, pos, a, b, op1 == '+' ? 1 : -1, op2,
+                                cDigits, resultDigits, &table);
+                }
+              } else {
+                if (a == 0 || b == 0) { continue; }
+                if (op1 == '/' && a % b != 0) { continue; }
+                const int64_t term = op1 == '*' ? a * b : a / b;
+                for (char op2 : ops) {
+                  addLastNumber(buf, pos, 0, term, 1, op2, cDigits,
+                                resultDigits, &table);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  sortTable(&table);
+  return table;
+}
+
+// The constexpr rules must agree with the runtime rules of Nerdle, the
+// build fails otherwise. These are the cases of NerdleTest, the fingerprint
+// further below pins the table to the one the runtime enumeration
+// (EquationIndex::enumerate) produces, which EquationIndexTest checks.
+static_assert(EquationRules::isSyntactic("42*3=126"));
+static_assert(EquationRules::isSyntactic("3*6-18=0"));
+static_assert(EquationRules::isSyntactic("0+3*4=12"));
+static_assert(EquationRules::isSyntactic("3+0+7=10"));
+static_assert(EquationRules::isSyntactic("102-99=3"));
+static_assert(!EquationRules::isSyntactic("42*2=84"));
+static_assert(!EquationRules::isSyntactic("12345678"));
+static_assert(!EquationRules::isSyntactic("42=42=42"));
+static_assert(!EquationRules::isSyntactic("2**8=256"));
+static_assert(!EquationRules::isSyntactic("42*02=84"));
+static_assert(!EquationRules::isSyntactic("126=3*42"));
+static_assert(!EquationRules::isSyntactic("+42*1=42"));
+static_assert(!EquationRules::isSyntactic("5A6-9=42"));
+static_assert(EquationRules::compute("42*3/2") == 63);
+static_assert(EquationRules::compute("0*28+4") == -1);
+static_assert(EquationRules::compute("4+28*0") == -1);
+static_assert(EquationRules::compute("0/28-5") == -1);
+static_assert(EquationRules::compute("5-28/0") == -1);
+static_assert(EquationRules::compute("42+5/9") == -1);
+static_assert(EquationRules::compute("9-16") == -7);
+static_assert(EquationRules::compute("187-42*3+42/6+1") == 69);
+static_assert(EquationRules::isLegal("5*9-3=42"));
+static_assert(EquationRules::isLegal("6/1*7=42"));
+static_assert(!EquationRules::isLegal("0*1337=0"));
+static_assert(!EquationRules::isLegal("187/9=20"));
+
+// FNV-1a hash over all packed equations of the table.
+constexpr uint64_t fingerprint(const EquationTable& table) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < table.size; ++i) {
+    hash = (hash ^ table.equations[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+}  // namespace
+
+// ____________________________________________________________________________
+alignas(64) constexpr EquationTable kClassicEquations = generateTable();
+
+static_assert(kClassicEquations.size == kNumClassicEquations,
+              "constexpr rules found a different number of equations");
+static_assert(fingerprint(kClassicEquations) == 10405724239865305402ull,
+              "constexpr rules found different equations");
@@ -0,0 +1,25 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef EQUATIONTABLE_H_
+#define EQUATIONTABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Number of legal answers of the classic game.
+constexpr size_t kNumClassicEquations = 18290;
+
+// Table of packed equations (see PackedEquation).
+struct EquationTable {
+  // The equations, sorted.
+  uint32_t equations[kNumClassicEquations];
+  // Number of equations in the table.
+  size_t size;
+};
+
+// Every legal answer of the classic game. The table is generated by the
+// compiler from the constexpr rules in EquationRules and stored read-only
+// in the binary, so no work is needed at runtime to get it.
+extern const EquationTable kClassicEquations;
+
+#endif  // EQUATIONTABLE_H_
@@ -0,0 +1,186 @@
+// Copyright 2022 Henrik Roth
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "./EquationValidator.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Number of records validate() reads at the same time. Their automata are
+// independent, so the lookups of one step overlap.
+constexpr size_t kInterleave = 8;
+
+// The transitions of the grammar of Nerdle::isEquationSyntactic: numbers
+// without leading zeros, separated by single arithmetic symbols on the
+// left side, and exactly one equal sign followed by a number.
+// Entries are the next state times 256, its first entry in the table, so
+// a step is a single lookup without any arithmetic on the state.
+struct TransitionTable {
+  uint16_t next[EquationValidator::kNumStates * 256];
+
+  constexpr TransitionTable() : next() {
+    using V = EquationValidator;
+    for (int state = 0; state < V::kNumStates; ++state) {
+      const bool right = state >= V::kRightStart && state <= V::kRightZero;
+      const int start = right ? V::kRightStart : V::kLeftStart;
+      for (int symbol = 0; symbol < 256; ++symbol) {
+        int to = V::kReject;
+        if (state == V::kReject) {
+          to = V::kReject;
+        } else if (symbol >= '0' && symbol <= '9') {
+          if (state == start) {
+            to = symbol == '0' ? start + 2 : start + 1;  // zero or number
+          } else if (state == start + 1) {
+            to = start + 1;  // the number goes on
+          }
+        } else if (!right && state != V::kLeftStart) {
+          if (symbol == '=') {
+            to = V::kRightStart;
+          } else if (symbol == '+' || symbol == '-' || symbol == '*'
+                     || symbol == '/') {
+            to = V::kLeftStart;
+          }
+        }
+        next[state * 256 + symbol] = to * 256;
+      }
+    }
+  }
+};
+
+constexpr TransitionTable kTable;
+
+// Shift that moves symbol i of a record loaded as a 64-bit word to the
+// lowest byte.
+constexpr int symbolShift(int i) {
+  return __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+         ? 8 * i : 8 * (kEquationLength - 1 - i);
+}
+
+// Accepting states as a bit mask.
+constexpr uint32_t kAccepting = 1 << EquationValidator::kRightStart
+                                | 1 << EquationValidator::kRightNumber
+                                | 1 << EquationValidator::kRightZero;
+}  // namespace
+
+// ____________________________________________________________________________
+EquationValidator::State EquationValidator::next(State state, char symbol) {
+  return static_cast<State>(
+      kTable.next[state * 256 + static_cast<uint8_t>(symbol)] / 256);
+}
+
+// ____________________________________________________________________________
+bool EquationValidator::isSyntactic(const char* eq) {
+  uint32_t state = kLeftStart * 256;
+  for (int i = 0; i < kEquationLength; ++i) {
+    state = kTable.next[state + static_cast<uint8_t>(eq[i])];
+  }
+  return (kAccepting >> (state / 256)) & 1;
+}
+
+// ____________________________________________________________________________
+size_t EquationValidator::validate(const char* records, size_t numRecords,
+                                   uint8_t* valid) {
+  return validateSse2(records, numRecords, valid);
+}
+
+// ____________________________________________________________________________
+size_t EquationValidator::validateDfa(const char* records, size_t numRecords,
+                                      uint8_t* valid) {
+  size_t numValid = 0;
+  size_t r = 0;
+  // kInterleave records at a time, each loaded as one 64-bit word whose
+  // bytes are its symbols in order.
+  for (; r + kInterleave <= numRecords; r += kInterleave) {
+    uint64_t symbols[kInterleave];
+    uint32_t state[kInterleave];
+    std::memcpy(symbols, records + r * kEquationLength,
+                kInterleave * kEquationLength);
+#pragma GCC unroll 8
+    for (size_t k = 0; k < kInterleave; ++k) { state[k] = kLeftStart * 256; }
+#pragma GCC unroll 8
+    for (int i = 0; i < kEquationLength; ++i) {
+#pragma GCC unroll 8
+      for (size_t k = 0; k < kInterleave; ++k) {
+        const uint8_t symbol = symbols[k] >> symbolShift(i);
+        state[k] = kTable.next[state[k] + symbol];
+      }
+    }
+#pragma GCC unroll 8
+    for (size_t k = 0; k < kInterleave; ++k) {
+      valid[r + k] = (kAccepting >> (state[k] / 256)) & 1;
+      numValid += valid[r + k];
+    }
+  }
+  for (; r < numRecords; ++r) {
+    valid[r] = isSyntactic(records + r * kEquationLength);
+    numValid += valid[r];
+  }
+  return numValid;
+}
+
+#if defined(__SSE2__)
+// ____________________________________________________________________________
+size_t EquationValidator::validateSse2(const char* records,
+                                       size_t numRecords, uint8_t* valid) {
+  // One record per 64-bit lane, symbol i in byte i. Shifting a lane by 8
+  // bits moves every symbol one cell to the right, so all rules about
+  // neighboring cells are a shift and an AND.
+  const __m128i zeroChar = _mm_set1_epi8('0');
+  const __m128i nine = _mm_set1_epi8(9);
+  const __m128i plus = _mm_set1_epi8('+');
+  const __m128i minus = _mm_set1_epi8('-');
+  const __m128i times = _mm_set1_epi8('*');
+  const __m128i divided = _mm_set1_epi8('/');
+  const __m128i equalChar = _mm_set1_epi8('=');
+  const __m128i firstCell = _mm_set1_epi64x(0xFF);
+  size_t numValid = 0;
+  size_t r = 0;
+  for (; r + 2 <= numRecords; r += 2) {
+    const __m128i v = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(records + r * kEquationLength));
+    // digits are the bytes with v - '0' <= 9 (unsigned)
+    const __m128i digit = _mm_cmpeq_epi8(
+        _mm_max_epu8(_mm_sub_epi8(v, zeroChar), nine), nine);
+    const __m128i zero = _mm_cmpeq_epi8(v, zeroChar);
+    const __m128i equal = _mm_cmpeq_epi8(v, equalChar);
+    const __m128i symbol = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, plus), _mm_cmpeq_epi8(v, minus)),
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, times),
+                                  _mm_cmpeq_epi8(v, divided)), equal));
+    // cells right of an equal sign
+    __m128i afterEqual = _mm_slli_epi64(equal, 8);
+    afterEqual = _mm_or_si128(afterEqual, _mm_slli_epi64(afterEqual, 8));
+    afterEqual = _mm_or_si128(afterEqual, _mm_slli_epi64(afterEqual, 16));
+    afterEqual = _mm_or_si128(afterEqual, _mm_slli_epi64(afterEqual, 32));
+    const __m128i digitLeft = _mm_slli_epi64(digit, 8);
+    const __m128i digitRight = _mm_srli_epi64(digit, 8);
+    const __m128i errors = _mm_or_si128(
+        // something else, a symbol first or two symbols in a row
+        _mm_or_si128(
+            _mm_andnot_si128(_mm_or_si128(digit, symbol), _mm_set1_epi8(-1)),
+            _mm_and_si128(symbol, _mm_or_si128(firstCell,
+                                               _mm_slli_epi64(symbol, 8)))),
+        // a symbol (or another =) right of =, or a leading zero
+        _mm_or_si128(_mm_and_si128(symbol, afterEqual),
+                     _mm_and_si128(_mm_andnot_si128(digitLeft, zero),
+                                   digitRight)));
+    const uint32_t errorBits = _mm_movemask_epi8(errors);
+    const uint32_t equalBits = _mm_movemask_epi8(equal);
+    valid[r] = ((errorBits & 0xFF) == 0) & ((equalBits & 0xFF) != 0);
+    valid[r + 1] = ((errorBits >> 8) == 0) & ((equalBits >> 8) != 0);
+    numValid += valid[r] + valid[r + 1];
+  }
+  return numValid + validateDfa(records + r * kEquationLength,
+                                numRecords - r, valid + r);
+}
+#else
+// ____________________________________________________________________________
+size_t EquationValidator::validateSse2(const char* records,
+                                       size_t numRecords, uint8_t* valid) {
+  return validateDfa(records, numRecords, valid);
+}
+#endif
@@ -0,0 +1,62 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef EQUATIONVALIDATOR_H_
+#define EQUATIONVALIDATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "./PackedEquation.h"
+
+// Checks the syntax of classic equations (see Nerdle::isEquationSyntactic)
+// with a deterministic finite automaton: one table lookup per symbol, no
+// branches. Meant for screening many candidates at once, f.e. during
+// enumeration or when checking input in bulk.
+class EquationValidator {
+ public:
+  // States of the automaton. The left side of an equation is read in the
+  // kLeft states, the right side in the kRight ones.
+  enum State : uint8_t {
+    kLeftStart,  // a number must follow, f.e. at the start
+    kLeftNumber,  // in a number that may go on
+    kLeftZero,  // after a zero that is a whole number
+    kRightStart,
+    kRightNumber,
+    kRightZero,
+    kReject,
+    kNumStates
+  };
+
+  // Return the state after reading the given symbol in the given state.
+  static State next(State state, char symbol);
+
+  // Return true if the automaton accepts the equation after reading all of
+  // it in the given state. Like Nerdle::isEquationSyntactic, this is the
+  // case once an equal sign was read, even if no number followed.
+  static bool isAccepting(State state) {
+    return state == kRightStart || state == kRightNumber
+           || state == kRightZero;
+  }
+
+  // Return true if the kEquationLength symbols at eq are a syntactically
+  // correct equation.
+  static bool isSyntactic(const char* eq);
+
+  // Check numRecords records of kEquationLength symbols each, stored one
+  // after the other without separators, and set valid[i] to 1 if the i-th
+  // record is syntactically correct, to 0 otherwise. Return the number of
+  // correct records. Uses validateSse2 where available.
+  static size_t validate(const char* records, size_t numRecords,
+                         uint8_t* valid);
+
+  // The implementations of validate(). validateDfa runs the automata of
+  // several records interleaved. validateSse2 classifies the symbols of two
+  // records per vector instruction (digit, zero, arithmetic symbol, equal
+  // sign) and checks the grammar with shifts and bit operations on those
+  // classes. It falls back to validateDfa on CPUs other than x86.
+  static size_t validateDfa(const char* records, size_t numRecords,
+                            uint8_t* valid);
+  static size_t validateSse2(const char* records, size_t numRecords,
+                             uint8_t* valid);
+};
+
+#endif  // EQUATIONVALIDATOR_H_
@@ -0,0 +1,78 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./EquationRules.h"
+#include "./EquationValidator.h"
+#include "./Random.h"
+
+
+TEST(EquationValidatorTest, isSyntactic) {
+  // the 8 symbol cases of NerdleTest.isEquationSyntactic
+  ASSERT_FALSE(EquationValidator::isSyntactic("12345678"));
+  ASSERT_FALSE(EquationValidator::isSyntactic("42=42=42"));
+  ASSERT_FALSE(EquationValidator::isSyntactic("2**8=256"));
+  ASSERT_FALSE(EquationValidator::isSyntactic("42*02=84"));
+  ASSERT_FALSE(EquationValidator::isSyntactic("126=3*42"));
+  ASSERT_FALSE(EquationValidator::isSyntactic("+42*1=42"));
+  ASSERT_TRUE(EquationValidator::isSyntactic("42*3=126"));
+  ASSERT_TRUE(EquationValidator::isSyntactic("42-10=32"));
+  ASSERT_TRUE(EquationValidator::isSyntactic("20*5=100"));
+  ASSERT_FALSE(EquationValidator::isSyntactic("AEIOU=42"));
+  ASSERT_FALSE(EquationValidator::isSyntactic("42+102=E"));
+  ASSERT_FALSE(EquationValidator::isSyntactic("5A6-9=42"));
+  ASSERT_TRUE(EquationValidator::isSyntactic("3*6-18=0"));
+  ASSERT_TRUE(EquationValidator::isSyntactic("0+3*4=12"));
+  ASSERT_TRUE(EquationValidator::isSyntactic("3+0+7=10"));
+  ASSERT_TRUE(EquationValidator::isSyntactic("102-99=3"));
+  // nothing right of the equal sign is accepted, like the original rules
+  ASSERT_TRUE(EquationValidator::isSyntactic("1234567="));
+  ASSERT_EQ(EquationValidator::next(EquationValidator::kLeftStart, '0'),
+            EquationValidator::kLeftZero);
+  ASSERT_EQ(EquationValidator::next(EquationValidator::kLeftZero, '0'),
+            EquationValidator::kReject);
+}
+
+TEST(EquationValidatorTest, validate) {
+  // every equation, and random strings over the symbols of equations and
+  // a few others, against the rules
+  const EquationIndex& index = EquationIndex::classic();
+  const std::string symbols = "0123456789+-*/=0123456789+-*/=?a\n";
+  Random random(11);
+  std::string records;
+  for (size_t i = 0; i < index.size(); ++i) {
+    records += index.equation(i);
+    for (int k = 0; k < 8; ++k) {
+      records += symbols[random.uniform(symbols.size())];
+    }
+  }
+  // an odd number of records, so that some aren't interleaved
+  const size_t numRecords = records.size() / 8 - 3;
+  std::vector<uint8_t> valid(numRecords);
+  const size_t numValid = EquationValidator::validate(
+      records.data(), numRecords, valid.data());
+  size_t expectedValid = 0;
+  for (size_t r = 0; r < numRecords; ++r) {
+    const std::string record = records.substr(8 * r, 8);
+    const bool expected = EquationRules::isSyntactic(record);
+    ASSERT_EQ(valid[r], expected) << record;
+    ASSERT_EQ(EquationValidator::isSyntactic(record.data()), expected);
+    expectedValid += expected;
+  }
+  ASSERT_EQ(numValid, expectedValid);
+  ASSERT_GT(numValid, index.size());
+  // both implementations, also on tails too short to interleave
+  for (size_t n : {numRecords, size_t(1), size_t(2), size_t(9)}) {
+    std::vector<uint8_t> dfa(n);
+    std::vector<uint8_t> sse2(n);
+    ASSERT_EQ(EquationValidator::validateDfa(records.data(), n, dfa.data()),
+              EquationValidator::validateSse2(records.data(), n,
+                                              sse2.data()));
+    for (size_t r = 0; r < n; ++r) {
+      ASSERT_EQ(dfa[r], valid[r]);
+      ASSERT_EQ(sse2[r], valid[r]);
+    }
+  }
+}
@@ -0,0 +1,233 @@
+// Copyright 2022 Henrik Roth
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "./Feedback.h"
+#include "./PackedEquation.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NERDLE_X86 1
+#endif
+
+namespace {
+// Value of a magenta cell in the pattern id, green is twice as much.
+constexpr uint32_t kCellWeight[kEquationLength] = {
+    2187, 729, 243, 81, 27, 9, 3, 1};
+
+// Shift that moves cell i of a packed equation to the lowest nibble.
+constexpr int kCellShift[kEquationLength] = {28, 24, 20, 16, 12, 8, 4, 0};
+
+// Symbols of a guess, and for every pair of cells k < i whether they hold
+// the same symbol, as all-ones / all-zeros masks for the vector kernels.
+struct GuessLayout {
+  int32_t symbol[kEquationLength];
+  int32_t same[kEquationLength][kEquationLength];
+
+  explicit GuessLayout(uint32_t guess) {
+    for (int i = 0; i < kEquationLength; ++i) {
+      symbol[i] = PackedEquation::cell(guess, i);
+      for (int k = 0; k < kEquationLength; ++k) {
+        same[i][k] = k < i && PackedEquation::cell(guess, k) == symbol[i]
+                     ? -1 : 0;
+      }
+    }
+  }
+};
+}  // namespace
+
+// ____________________________________________________________________________
+uint16_t Feedback::pattern(uint32_t guess, uint32_t answer) {
+  // Count the symbols of the answer that aren't matched by a green cell,
+  // those are left for magenta cells, from left to right. Written without
+  // branches, since whether a cell matches is unpredictable.
+  uint8_t unmatched[16] = {0};
+  uint32_t green = 0;
+  uint32_t pattern = 0;
+  for (int i = 0; i < kEquationLength; ++i) {
+    const int g = PackedEquation::cell(guess, i);
+    const int a = PackedEquation::cell(answer, i);
+    const uint32_t isGreen = g == a;
+    green |= isGreen << i;
+    pattern += isGreen * 2 * kCellWeight[i];
+    unmatched[a] += 1 - isGreen;
+  }
+  for (int i = 0; i < kEquationLength; ++i) {
+    const int g = PackedEquation::cell(guess, i);
+    const uint32_t isMagenta = ((green >> i) & 1) == 0 && unmatched[g] > 0;
+    unmatched[g] -= isMagenta;
+    pattern += isMagenta * kCellWeight[i];
+  }
+  return pattern;
+}
+
+// ____________________________________________________________________________
+void Feedback::patternsScalar(uint32_t guess, const uint32_t* answers,
+                              size_t numAnswers, uint16_t* patterns) {
+  for (size_t i = 0; i < numAnswers; ++i) {
+    patterns[i] = pattern(guess, answers[i]);
+  }
+}
+
+// The vectorized kernels score one answer per 32-bit lane. Since the guess
+// is the same in every lane, no lookups are needed: cell i of the guess
+// with symbol s is magenta iff it isn't green and the answer has more
+// non-green cells with s than there are non-green cells with s left of
+// cell i in the guess (those took the magentas first).
+#ifdef NERDLE_X86
+// ____________________________________________________________________________
+void Feedback::patternsSse2(uint32_t guess, const uint32_t* answers,
+                            size_t numAnswers, uint16_t* patterns) {
+  const GuessLayout layout(guess);
+  const __m128i nibble = _mm_set1_epi32(0xF);
+  const __m128i ones = _mm_set1_epi32(-1);
+  size_t n = 0;
+  for (; n + 4 <= numAnswers; n += 4) {
+    const __m128i answer =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(answers + n));
+    __m128i cell[kEquationLength];
+    __m128i green[kEquationLength];
+    __m128i notGreen[kEquationLength];
+#pragma GCC unroll 8
+    for (int j = 0; j < kEquationLength; ++j) {
+      cell[j] = _mm_and_si128(_mm_srli_epi32(answer, kCellShift[j]), nibble);
+      green[j] = _mm_cmpeq_epi32(cell[j], _mm_set1_epi32(layout.symbol[j]));
+      notGreen[j] = _mm_xor_si128(green[j], ones);
+    }
+    __m128i pattern = _mm_setzero_si128();
+#pragma GCC unroll 8
+    for (int i = 0; i < kEquationLength; ++i) {
+      // non-green cells of the answer with the symbol of cell i and
+      // non-green cells left of i in the guess with the same symbol
+      const __m128i symbol = _mm_set1_epi32(layout.symbol[i]);
+      __m128i unmatched = _mm_setzero_si128();
+      __m128i used = _mm_setzero_si128();
+#pragma GCC unroll 8
+      for (int j = 0; j < kEquationLength; ++j) {
+        unmatched = _mm_sub_epi32(unmatched, _mm_and_si128(
+            _mm_cmpeq_epi32(cell[j], symbol), notGreen[j]));
+        used = _mm_sub_epi32(used, _mm_and_si128(
+            notGreen[j], _mm_set1_epi32(layout.same[i][j])));
+      }
+      const __m128i magenta = _mm_and_si128(notGreen[i],
+                                            _mm_cmpgt_epi32(unmatched, used));
+      pattern = _mm_add_epi32(pattern, _mm_or_si128(
+          _mm_and_si128(green[i], _mm_set1_epi32(2 * kCellWeight[i])),
+          _mm_and_si128(magenta, _mm_set1_epi32(kCellWeight[i]))));
+    }
+    uint32_t result[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result), pattern);
+    for (int k = 0; k < 4; ++k) { patterns[n + k] = result[k]; }
+  }
+  patternsScalar(guess, answers + n, numAnswers - n, patterns + n);
+}
+
+// ____________________________________________________________________________
+__attribute__((target("avx2")))
+void Feedback::patternsAvx2(uint32_t guess, const uint32_t* answers,
+                            size_t numAnswers, uint16_t* patterns) {
+  const GuessLayout layout(guess);
+  const __m256i nibble = _mm256_set1_epi32(0xF);
+  const __m256i ones = _mm256_set1_epi32(-1);
+  size_t n = 0;
+  for (; n + 8 <= numAnswers; n += 8) {
+    const __m256i answer =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(answers + n));
+    __m256i cell[kEquationLength];
+    __m256i green[kEquationLength];
+    __m256i notGreen[kEquationLength];
+#pragma GCC unroll 8
+    for (int j = 0; j < kEquationLength; ++j) {
+      cell[j] = _mm256_and_si256(_mm256_srli_epi32(answer, kCellShift[j]),
+                                 nibble);
+      green[j] = _mm256_cmpeq_epi32(cell[j],
+                                    _mm256_set1_epi32(layout.symbol[j]));
+      notGreen[j] = _mm256_xor_si256(green[j], ones);
+    }
+    __m256i pattern = _mm256_setzero_si256();
+#pragma GCC unroll 8
+    for (int i = 0; i < kEquationLength; ++i) {
+      const __m256i symbol = _mm256_set1_epi32(layout.symbol[i]);
+      __m256i unmatched = _mm256_setzero_si256();
+      __m256i used = _mm256_setzero_si256();
+#pragma GCC unroll 8
+      for (int j = 0; j < kEquationLength; ++j) {
+        unmatched = _mm256_sub_epi32(unmatched, _mm256_and_si256(
+            _mm256_cmpeq_epi32(cell[j], symbol), notGreen[j]));
+        used = _mm256_sub_epi32(used, _mm256_and_si256(
+            notGreen[j], _mm256_set1_epi32(layout.same[i][j])));
+      }
+      const __m256i magenta = _mm256_and_si256(notGreen[i],
+          _mm256_cmpgt_epi32(unmatched, used));
+      pattern = _mm256_add_epi32(pattern, _mm256_or_si256(
+          _mm256_and_si256(green[i], _mm256_set1_epi32(2 * kCellWeight[i])),
+          _mm256_and_si256(magenta, _mm256_set1_epi32(kCellWeight[i]))));
+    }
+    // narrow the eight 32-bit pattern ids to 16 bits
+    const __m128i packed = _mm_packus_epi32(
+        _mm256_castsi256_si128(pattern), _mm256_extracti128_si256(pattern, 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(patterns + n), packed);
+  }
+  patternsScalar(guess, answers + n, numAnswers - n, patterns + n);
+}
+
+// ____________________________________________________________________________
+bool Feedback::hasSse2() { return __builtin_cpu_supports("sse2"); }
+
+// ____________________________________________________________________________
+bool Feedback::hasAvx2() { return __builtin_cpu_supports("avx2"); }
+#else
+// ____________________________________________________________________________
+void Feedback::patternsSse2(uint32_t guess, const uint32_t* answers,
+                            size_t numAnswers, uint16_t* patterns) {
+  patternsScalar(guess, answers, numAnswers, patterns);
+}
+
+// ____________________________________________________________________________
+void Feedback::patternsAvx2(uint32_t guess, const uint32_t* answers,
+                            size_t numAnswers, uint16_t* patterns) {
+  patternsScalar(guess, answers, numAnswers, patterns);
+}
+
+// ____________________________________________________________________________
+bool Feedback::hasSse2() { return false; }
+
+// ____________________________________________________________________________
+bool Feedback::hasAvx2() { return false; }
+#endif
+
+// ____________________________________________________________________________
+void Feedback::patterns(uint32_t guess, const uint32_t* answers,
+                        size_t numAnswers, uint16_t* patterns) {
+  static const bool avx2 = hasAvx2();
+  static const bool sse2 = hasSse2();
+  if (avx2) {
+    patternsAvx2(guess, answers, numAnswers, patterns);
+  } else if (sse2) {
+    patternsSse2(guess, answers, numAnswers, patterns);
+  } else {
+    patternsScalar(guess, answers, numAnswers, patterns);
+  }
+}
+
+// ____________________________________________________________________________
+std::string Feedback::highlight(uint16_t pattern) {
+  std::string highlight(kEquationLength, '1');
+  for (int i = kEquationLength - 1; i >= 0; --i) {
+    const int digit = pattern % 3;
+    highlight[i] = digit == 0 ? '1' : digit == 1 ? '3' : '2';
+    pattern /= 3;
+  }
+  return highlight;
+}
+
+// ____________________________________________________________________________
+uint16_t Feedback::fromHighlight(const std::string* highlight) {
+  uint16_t pattern = 0;
+  for (int i = 0; i < kEquationLength; ++i) {
+    const char c = (*highlight)[i];
+    pattern = 3 * pattern + (c == '2' ? 2 : c == '3' ? 1 : 0);
+  }
+  return pattern;
+}
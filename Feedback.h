@@ -0,0 +1,52 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef FEEDBACK_H_
+#define FEEDBACK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Number of different feedback patterns of a classic guess, 3^8.
+constexpr int kNumPatterns = 6561;
+
+// Pattern of a guess that is the answer, every cell green.
+constexpr uint16_t kAllGreen = kNumPatterns - 1;
+
+// Feedback on packed guesses (see PackedEquation), computed the same way as
+// Nerdle::compareUserGuess. The feedback of a guess is encoded as a base-3
+// pattern id with one digit per cell, the leftmost cell being the most
+// significant digit: 0 = black (wrong symbol), 1 = magenta (symbol at wrong
+// location), 2 = green (symbol at right location).
+// F.e. highlight "21113222" <-> digits 2,0,0,0,1,2,2,2 <-> pattern 4427.
+class Feedback {
+ public:
+  // Return the pattern id of the given guess against the given answer.
+  static uint16_t pattern(uint32_t guess, uint32_t answer);
+
+  // Score one guess against numAnswers answers in one call and store the
+  // pattern ids in patterns. Uses the widest vector instructions the CPU
+  // supports (AVX2, SSE2 or none).
+  static void patterns(uint32_t guess, const uint32_t* answers,
+                       size_t numAnswers, uint16_t* patterns);
+
+  // The different implementations of patterns(), the vectorized ones only
+  // exist on x86 and must only be called if supported (see hasAvx2).
+  static void patternsScalar(uint32_t guess, const uint32_t* answers,
+                             size_t numAnswers, uint16_t* patterns);
+  static void patternsSse2(uint32_t guess, const uint32_t* answers,
+                           size_t numAnswers, uint16_t* patterns);
+  static void patternsAvx2(uint32_t guess, const uint32_t* answers,
+                           size_t numAnswers, uint16_t* patterns);
+
+  // Return true if the CPU supports SSE2 / AVX2.
+  static bool hasSse2();
+  static bool hasAvx2();
+
+  // Convert a pattern id into the highlight string of compareUserGuess
+  // ('1' = black, '2' = green, '3' = magenta) and back.
+  static std::string highlight(uint16_t pattern);
+  static uint16_t fromHighlight(const std::string* highlight);
+};
+
+#endif  // FEEDBACK_H_
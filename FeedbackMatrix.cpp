@@ -0,0 +1,289 @@
+// Copyright 2022 Henrik Roth
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "./FeedbackMatrix.h"
+#include "./Feedback.h"
+
+namespace {
+constexpr char kMagic[8] = {'N', 'R', 'D', 'L', 'F', 'B', 'M', 'X'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kPageSize = 4096;
+
+// Header at the start of every matrix file.
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t cellBytes;
+  uint64_t numGuesses;
+  uint64_t numAnswers;
+  uint64_t numRows;
+  uint64_t guessesOffset;
+  uint64_t answersOffset;
+  uint64_t rowIndexOffset;
+  uint64_t dictionaryOffset;
+  uint64_t cellsOffset;
+  uint64_t fileSize;
+  // checksum of the cells
+  uint64_t dataChecksum;
+  // checksum of the header (with this field 0) and everything up to the
+  // cells
+  uint64_t metaChecksum;
+};
+
+// ____________________________________________________________________________
+uint64_t checksum(const uint8_t* data, size_t size) {
+  // FNV-1a style, but eight bytes per step
+  uint64_t hash = 14695981039346656037ull;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, 8);
+    hash = (hash ^ word) * 1099511628211ull;
+    hash ^= hash >> 29;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ data[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+// ____________________________________________________________________________
+uint64_t metaChecksum(const uint8_t* data) {
+  Header header;
+  memcpy(&header, data, sizeof(header));
+  header.metaChecksum = 0;
+  const uint64_t hash = checksum(reinterpret_cast<uint8_t*>(&header),
+                                 sizeof(header));
+  return hash ^ checksum(data + sizeof(header),
+                         header.cellsOffset - sizeof(header));
+}
+
+// ____________________________________________________________________________
+uint64_t alignUp(uint64_t offset, uint64_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+// Run work(i) for every i in [0, n) on numThreads threads.
+template <class Work>
+void parallelFor(size_t n, int numThreads, Work work) {
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < std::max(1, numThreads); ++t) {
+    threads.emplace_back([&]() {
+      for (size_t i = next++; i < n; i = next++) { work(i); }
+    });
+  }
+  for (std::thread& thread : threads) { thread.join(); }
+}
+}  // namespace
+
+// ____________________________________________________________________________
+FeedbackMatrix::FeedbackMatrix() : data_(nullptr), size_(0) {}
+
+// ____________________________________________________________________________
+FeedbackMatrix::~FeedbackMatrix() { close(); }
+
+// ____________________________________________________________________________
+void FeedbackMatrix::close() {
+  if (data_ != nullptr) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+    data_ = nullptr;
+  }
+}
+
+// ____________________________________________________________________________
+bool FeedbackMatrix::build(const uint32_t* guesses, size_t numGuesses,
+                           const uint32_t* answers, size_t numAnswers,
+                           const char* path, int numThreads,
+                           bool dedupeRows) {
+  // First pass: find the patterns that appear, to choose the cell size,
+  // and the hash of every row, to find identical rows.
+  std::vector<uint64_t> rowHash(numGuesses);
+  std::vector<std::atomic<bool>> appears(kNumPatterns);
+  parallelFor(numGuesses, numThreads, [&](size_t g) {
+    std::vector<uint16_t> row(numAnswers);
+    Feedback::patterns(guesses[g], answers, numAnswers, row.data());
+    for (uint16_t pattern : row) {
+      if (!appears[pattern].load(std::memory_order_relaxed)) {
+        appears[pattern].store(true, std::memory_order_relaxed);
+      }
+    }
+    rowHash[g] = checksum(reinterpret_cast<uint8_t*>(row.data()),
+                          2 * numAnswers);
+  });
+  std::vector<uint16_t> dictionary;
+  for (int pattern = 0; pattern < kNumPatterns; ++pattern) {
+    if (appears[pattern]) { dictionary.push_back(pattern); }
+  }
+  const uint32_t cellBytes = dictionary.size() <= 256 ? 1 : 2;
+  dictionary.resize(256, 0);
+  std::vector<uint8_t> dictionaryPosition(kNumPatterns, 0);
+  for (int i = 0; i < 256; ++i) { dictionaryPosition[dictionary[i]] = i; }
+
+  // Assign stored rows. Rows with the same hash are compared before they
+  // are shared.
+  std::vector<uint32_t> rowIndex(numGuesses);
+  std::vector<size_t> rowGuess;  // guess whose row is stored in each row
+  std::unordered_map<uint64_t, std::vector<uint32_t>> rowsWithHash;
+  std::vector<uint16_t> row0(numAnswers);
+  std::vector<uint16_t> row1(numAnswers);
+  for (size_t g = 0; g < numGuesses; ++g) {
+    rowIndex[g] = rowGuess.size();
+    if (dedupeRows) {
+      std::vector<uint32_t>& candidates = rowsWithHash[rowHash[g]];
+      if (!candidates.empty()) {
+        Feedback::patterns(guesses[g], answers, numAnswers, row0.data());
+      }
+      for (uint32_t candidate : candidates) {
+        Feedback::patterns(guesses[rowGuess[candidate]], answers, numAnswers,
+                           row1.data());
+        if (row0 == row1) {
+          rowIndex[g] = candidate;
+          break;
+        }
+      }
+      if (rowIndex[g] != rowGuess.size()) { continue; }
+      candidates.push_back(rowGuess.size());
+    }
+    rowGuess.push_back(g);
+  }
+
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.cellBytes = cellBytes;
+  header.numGuesses = numGuesses;
+  header.numAnswers = numAnswers;
+  header.numRows = rowGuess.size();
+  header.guessesOffset = sizeof(Header);
+  header.answersOffset = header.guessesOffset + 4 * numGuesses;
+  header.rowIndexOffset = header.answersOffset + 4 * numAnswers;
+  header.dictionaryOffset = header.rowIndexOffset + 4 * numGuesses;
+  header.cellsOffset = alignUp(header.dictionaryOffset + 2 * 256, kPageSize);
+  header.fileSize = header.cellsOffset
+                    + header.numRows * numAnswers * cellBytes;
+
+  const int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) { return false; }
+  if (ftruncate(fd, header.fileSize) != 0) {
+    ::close(fd);
+    return false;
+  }
+  void* mapped = mmap(nullptr, header.fileSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) { return false; }
+  uint8_t* data = static_cast<uint8_t*>(mapped);
+  memcpy(data + header.guessesOffset, guesses, 4 * numGuesses);
+  memcpy(data + header.answersOffset, answers, 4 * numAnswers);
+  memcpy(data + header.rowIndexOffset, rowIndex.data(), 4 * numGuesses);
+  memcpy(data + header.dictionaryOffset, dictionary.data(), 2 * 256);
+
+  // Second pass: write the stored rows directly into the file.
+  uint8_t* cells = data + header.cellsOffset;
+  parallelFor(rowGuess.size(), numThreads, [&](size_t r) {
+    uint8_t* out = cells + r * numAnswers * cellBytes;
+    if (cellBytes == 2) {
+      Feedback::patterns(guesses[rowGuess[r]], answers, numAnswers,
+                         reinterpret_cast<uint16_t*>(out));
+    } else {
+      std::vector<uint16_t> row(numAnswers);
+      Feedback::patterns(guesses[rowGuess[r]], answers, numAnswers,
+                         row.data());
+      for (size_t a = 0; a < numAnswers; ++a) {
+        out[a] = dictionaryPosition[row[a]];
+      }
+    }
+  });
+  header.dataChecksum = checksum(cells, header.fileSize - header.cellsOffset);
+  memcpy(data, &header, sizeof(header));
+  header.metaChecksum = metaChecksum(data);
+  memcpy(data, &header, sizeof(header));
+  const bool synced = msync(data, header.fileSize, MS_SYNC) == 0;
+  munmap(data, header.fileSize);
+  return synced;
+}
+
+// ____________________________________________________________________________
+bool FeedbackMatrix::open(const char* path) {
+  close();
+  const int fd = ::open(path, O_RDONLY);
+  if (fd < 0) { return false; }
+  struct stat status;
+  if (fstat(fd, &status) != 0
+      || static_cast<size_t>(status.st_size) < sizeof(Header)) {
+    ::close(fd);
+    return false;
+  }
+  size_ = status.st_size;
+  void* mapped = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) { return false; }
+  data_ = static_cast<const uint8_t*>(mapped);
+
+  Header header;
+  memcpy(&header, data_, sizeof(header));
+  bool valid = memcmp(header.magic, kMagic, sizeof(kMagic)) == 0
+      && header.version == kVersion
+      && (header.cellBytes == 1 || header.cellBytes == 2)
+      && header.fileSize == size_
+      && header.cellsOffset <= size_
+      && header.cellsOffset % kPageSize == 0
+      && header.guessesOffset == sizeof(Header)
+      && header.answersOffset == header.guessesOffset + 4 * header.numGuesses
+      && header.rowIndexOffset == header.answersOffset + 4 * header.numAnswers
+      && header.dictionaryOffset == header.rowIndexOffset
+                                    + 4 * header.numGuesses
+      && header.dictionaryOffset + 2 * 256 <= header.cellsOffset
+      && header.numRows * header.numAnswers * header.cellBytes
+         == size_ - header.cellsOffset
+      && metaChecksum(data_) == header.metaChecksum;
+  // The checksum only catches damage, not a writer that got the rows
+  // wrong, so every row must be one that is stored.
+  const uint32_t* rowIndex = reinterpret_cast<const uint32_t*>(
+      data_ + header.rowIndexOffset);
+  for (size_t guess = 0; valid && guess < header.numGuesses; ++guess) {
+    valid = rowIndex[guess] < header.numRows;
+  }
+  if (!valid) {
+    close();
+    return false;
+  }
+  numGuesses_ = header.numGuesses;
+  numAnswers_ = header.numAnswers;
+  numRows_ = header.numRows;
+  cellBytes_ = header.cellBytes;
+  guesses_ = reinterpret_cast<const uint32_t*>(data_ + header.guessesOffset);
+  answers_ = reinterpret_cast<const uint32_t*>(data_ + header.answersOffset);
+  rowIndex_ = rowIndex;
+  dictionary_ = reinterpret_cast<const uint16_t*>(data_
+                                                  + header.dictionaryOffset);
+  cells_ = data_ + header.cellsOffset;
+  dataChecksum_ = header.dataChecksum;
+  return true;
+}
+
+// ____________________________________________________________________________
+bool FeedbackMatrix::verify() const {
+  if (data_ == nullptr) { return false; }
+  return checksum(cells_, size_ - (cells_ - data_)) == dataChecksum_;
+}
+
+// ____________________________________________________________________________
+const uint16_t* FeedbackMatrix::row(size_t guess) const {
+  if (cellBytes_ != 2) { return nullptr; }
+  return reinterpret_cast<const uint16_t*>(cells_)
+         + rowIndex_[guess] * numAnswers_;
+}
@@ -0,0 +1,88 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef FEEDBACKMATRIX_H_
+#define FEEDBACKMATRIX_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// The feedback pattern (see Feedback) of every guess against every answer,
+// precomputed once by build() and stored in a file that is mapped into
+// memory by open(). Nothing is parsed or computed when opening the file, so
+// only the pages of the cells that are actually looked up are ever read.
+//
+// File layout (version 1), all numbers little endian:
+//   header (see FeedbackMatrix.cpp), packed guesses (uint32 each), packed
+//   answers (uint32 each), row of every guess (uint32 each), dictionary
+//   (256 uint16 pattern ids, only for 1-byte cells), rows of cells
+//   (numAnswers cells each, starting at a page boundary).
+// A cell holds the pattern id (2 bytes) or, if the file has at most 256
+// different patterns, the position of the pattern id in the dictionary
+// (1 byte). Guesses with identical rows may share one stored row.
+class FeedbackMatrix {
+ public:
+  FeedbackMatrix();
+  ~FeedbackMatrix();
+  FeedbackMatrix(const FeedbackMatrix&) = delete;
+  FeedbackMatrix& operator=(const FeedbackMatrix&) = delete;
+
+  // Compute the matrix of the given packed guesses and answers with
+  // numThreads threads and write it to the file at path. If dedupeRows is
+  // true, identical rows are only stored once. Return false if the file
+  // couldn't be written.
+  static bool build(const uint32_t* guesses, size_t numGuesses,
+                    const uint32_t* answers, size_t numAnswers,
+                    const char* path, int numThreads, bool dedupeRows);
+
+  // Map the matrix file at path into memory. Only the header and the
+  // tables in front of the cells are checked (version, sizes and their
+  // checksum), see verify() for the cells. Return false if the file can't
+  // be used.
+  bool open(const char* path);
+
+  // Check the checksum of all cells. This reads the whole file.
+  bool verify() const;
+
+  // Return the pattern id of the guess with the given index against the
+  // answer with the given index.
+  uint16_t pattern(size_t guess, size_t answer) const {
+    const size_t cell = rowIndex_[guess] * numAnswers_ + answer;
+    return cellBytes_ == 2 ? reinterpret_cast<const uint16_t*>(cells_)[cell]
+                           : dictionary_[cells_[cell]];
+  }
+
+  // Return the row of the given guess if cells are stored as pattern ids
+  // (cellBytes() == 2), nullptr otherwise.
+  const uint16_t* row(size_t guess) const;
+
+  // Number of guesses / answers and their packed equations.
+  size_t numGuesses() const { return numGuesses_; }
+  size_t numAnswers() const { return numAnswers_; }
+  const uint32_t* guesses() const { return guesses_; }
+  const uint32_t* answers() const { return answers_; }
+
+  // Number of rows that are stored and the bytes per cell.
+  size_t numRows() const { return numRows_; }
+  int cellBytes() const { return cellBytes_; }
+
+ private:
+  // Unmap the file if one is mapped.
+  void close();
+
+  // The mapped file.
+  const uint8_t* data_;
+  size_t size_;
+
+  size_t numGuesses_;
+  size_t numAnswers_;
+  size_t numRows_;
+  int cellBytes_;
+  const uint32_t* guesses_;
+  const uint32_t* answers_;
+  const uint32_t* rowIndex_;
+  const uint16_t* dictionary_;
+  const uint8_t* cells_;
+  uint64_t dataChecksum_;
+};
+
+#endif  // FEEDBACKMATRIX_H_
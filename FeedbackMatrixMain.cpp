@@ -0,0 +1,60 @@
+// Copyright 2022 Henrik Roth
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "./EquationIndex.h"
+#include "./FeedbackMatrix.h"
+
+
+// Build the feedback matrix of every classic guess against every classic
+// answer and write it to a file, or check an existing file.
+int main(int argc, char** argv) {
+  const char* path = nullptr;
+  int numThreads = std::thread::hardware_concurrency();
+  bool dedupeRows = false;
+  bool check = false;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      numThreads = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--dedupe-rows") == 0) {
+      dedupeRows = true;
+    } else if (strcmp(argv[i], "--check") == 0) {
+      check = true;
+    } else if (path == nullptr && argv[i][0] != '-') {
+      path = argv[i];
+    } else {
+      usage = true;
+    }
+  }
+  if (path == nullptr || usage) {
+    std::cerr << "Usage: " << argv[0] << " <file> [--threads <n>]"
+              << " [--dedupe-rows] [--check]" << std::endl;
+    return 1;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  if (!check) {
+    const EquationIndex& index = EquationIndex::classic();
+    if (!FeedbackMatrix::build(index.data(), index.size(), index.data(),
+                               index.size(), path, numThreads, dedupeRows)) {
+      std::cerr << "Could not write " << path << std::endl;
+      return 1;
+    }
+  }
+  FeedbackMatrix matrix;
+  if (!matrix.open(path) || !matrix.verify()) {
+    std::cerr << path << " is not a valid feedback matrix" << std::endl;
+    return 1;
+  }
+  const double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  std::cout << path << ": " << matrix.numGuesses() << " guesses x "
+            << matrix.numAnswers() << " answers, " << matrix.numRows()
+            << " rows stored, " << matrix.cellBytes() << " byte(s) per cell, "
+            << seconds << " s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./Feedback.h"
+#include "./FeedbackMatrix.h"
+
+
+TEST(FeedbackMatrixTest, buildAndOpen) {
+  const EquationIndex& index = EquationIndex::classic();
+  const char* path = "FeedbackMatrixTest.buildAndOpen.tmp";
+  // every 20th equation as guess against the first 3000 answers
+  std::vector<uint32_t> guesses;
+  for (size_t i = 0; i < index.size(); i += 20) {
+    guesses.push_back(index.packed(i));
+  }
+  ASSERT_TRUE(FeedbackMatrix::build(guesses.data(), guesses.size(),
+                                    index.data(), 3000, path, 2, false));
+  FeedbackMatrix matrix;
+  ASSERT_TRUE(matrix.open(path));
+  ASSERT_TRUE(matrix.verify());
+  ASSERT_EQ(matrix.numGuesses(), guesses.size());
+  ASSERT_EQ(matrix.numAnswers(), 3000);
+  ASSERT_EQ(matrix.numRows(), guesses.size());
+  ASSERT_EQ(matrix.cellBytes(), 2);
+  for (size_t g = 0; g < guesses.size(); ++g) {
+    ASSERT_EQ(matrix.guesses()[g], guesses[g]);
+    for (size_t a = 0; a < 3000; a += 7) {
+      ASSERT_EQ(matrix.pattern(g, a),
+                Feedback::pattern(guesses[g], index.packed(a)));
+      ASSERT_EQ(matrix.row(g)[a], matrix.pattern(g, a));
+    }
+  }
+  unlink(path);
+}
+
+TEST(FeedbackMatrixTest, dedupeRows) {
+  const EquationIndex& index = EquationIndex::classic();
+  const char* path = "FeedbackMatrixTest.dedupeRows.tmp";
+  // the same guesses twice, against few answers so that there are few
+  // patterns and cells fit into one byte
+  std::vector<uint32_t> guesses;
+  for (int round = 0; round < 2; ++round) {
+    for (size_t i = 0; i < 100; ++i) { guesses.push_back(index.packed(i)); }
+  }
+  ASSERT_TRUE(FeedbackMatrix::build(guesses.data(), guesses.size(),
+                                    index.data(), 50, path, 3, true));
+  FeedbackMatrix matrix;
+  ASSERT_TRUE(matrix.open(path));
+  ASSERT_TRUE(matrix.verify());
+  ASSERT_LE(matrix.numRows(), 100);
+  ASSERT_EQ(matrix.cellBytes(), 1);
+  ASSERT_EQ(matrix.row(0), nullptr);
+  for (size_t g = 0; g < guesses.size(); ++g) {
+    for (size_t a = 0; a < 50; ++a) {
+      ASSERT_EQ(matrix.pattern(g, a),
+                Feedback::pattern(guesses[g], index.packed(a)));
+    }
+  }
+  unlink(path);
+}
+
+TEST(FeedbackMatrixTest, corruption) {
+  const EquationIndex& index = EquationIndex::classic();
+  const char* path = "FeedbackMatrixTest.corruption.tmp";
+  ASSERT_TRUE(FeedbackMatrix::build(index.data(), 100, index.data(), 1000,
+                                    path, 1, false));
+  FeedbackMatrix matrix;
+  ASSERT_FALSE(matrix.open("FeedbackMatrixTest.doesNotExist.tmp"));
+  // flip a byte of a cell: the file opens, but doesn't verify
+  FILE* file = fopen(path, "r+b");
+  ASSERT_EQ(fseek(file, -5, SEEK_END), 0);
+  int byte = fgetc(file);
+  ASSERT_EQ(fseek(file, -5, SEEK_END), 0);
+  fputc(byte ^ 1, file);
+  // flip a byte of the packed guesses: the file doesn't open
+  ASSERT_EQ(fseek(file, 200, SEEK_SET), 0);
+  byte = fgetc(file);
+  ASSERT_EQ(fseek(file, 200, SEEK_SET), 0);
+  fputc(byte ^ 1, file);
+  fclose(file);
+  ASSERT_FALSE(matrix.open(path));
+  // undo the second flip
+  file = fopen(path, "r+b");
+  ASSERT_EQ(fseek(file, 200, SEEK_SET), 0);
+  fputc(byte, file);
+  fclose(file);
+  ASSERT_TRUE(matrix.open(path));
+  ASSERT_FALSE(matrix.verify());
+  unlink(path);
+}
@@ -0,0 +1,71 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./Feedback.h"
+#include "./PackedEquation.h"
+#include "./Random.h"
+
+
+TEST(FeedbackTest, highlight) {
+  std::string test0 = "21113222";
+  std::string test1 = "22222222";
+  std::string test2 = "11111111";
+  ASSERT_EQ(Feedback::fromHighlight(&test0), 4427);
+  ASSERT_EQ(Feedback::fromHighlight(&test1), kAllGreen);
+  ASSERT_EQ(Feedback::fromHighlight(&test2), 0);
+  for (int pattern = 0; pattern < kNumPatterns; ++pattern) {
+    std::string highlight = Feedback::highlight(pattern);
+    ASSERT_EQ(Feedback::fromHighlight(&highlight), pattern);
+  }
+}
+
+TEST(FeedbackTest, pattern) {
+  std::string answer = "11+11=22";
+  std::string guess0 = "11+11=22";
+  std::string guess1 = "12+10=22";  // all 2 of the answer already green
+  std::string guess2 = "1+1+1=30";  // only one + left for magenta
+  std::string guess3 = "22-11=11";  // - not in the answer
+  uint32_t a = PackedEquation::pack(&answer);
+  ASSERT_EQ(Feedback::pattern(PackedEquation::pack(&guess0), a), kAllGreen);
+  ASSERT_EQ(Feedback::highlight(
+      Feedback::pattern(PackedEquation::pack(&guess1), a)), "21221222");
+  ASSERT_EQ(Feedback::highlight(
+      Feedback::pattern(PackedEquation::pack(&guess2), a)), "23312211");
+  ASSERT_EQ(Feedback::highlight(
+      Feedback::pattern(PackedEquation::pack(&guess3), a)), "33122233");
+}
+
+TEST(FeedbackTest, patterns) {
+  // every implementation gives the same result as pattern()
+  const EquationIndex& index = EquationIndex::classic();
+  std::vector<uint32_t> answers(index.size());
+  for (size_t i = 0; i < index.size(); ++i) { answers[i] = index.packed(i); }
+  std::vector<uint16_t> expected(answers.size());
+  std::vector<uint16_t> actual(answers.size());
+  Random random(42);
+  for (int round = 0; round < 50; ++round) {
+    const uint32_t guess = answers[random.uniform(answers.size())];
+    // odd number of answers to also test the scalar tail
+    const size_t numAnswers = answers.size() - random.uniform(8);
+    for (size_t i = 0; i < numAnswers; ++i) {
+      expected[i] = Feedback::pattern(guess, answers[i]);
+    }
+    Feedback::patternsScalar(guess, answers.data(), numAnswers, actual.data());
+    ASSERT_EQ(actual, expected);
+    if (Feedback::hasSse2()) {
+      Feedback::patternsSse2(guess, answers.data(), numAnswers,
+                             actual.data());
+      ASSERT_EQ(actual, expected);
+    }
+    if (Feedback::hasAvx2()) {
+      Feedback::patternsAvx2(guess, answers.data(), numAnswers,
+                             actual.data());
+      ASSERT_EQ(actual, expected);
+    }
+    Feedback::patterns(guess, answers.data(), numAnswers, actual.data());
+    ASSERT_EQ(actual, expected);
+  }
+}
@@ -0,0 +1,420 @@
+// Copyright 2022 Henrik Roth
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "./GameServer.h"
+#include "./Metrics.h"
+#include "./Variant.h"
+
+namespace {
+// Longest request; clients that send longer lines are disconnected.
+constexpr size_t kMaxLineLength = 256;
+
+// Events handled per call of epoll_wait.
+constexpr int kMaxEvents = 256;
+
+// Time a loop doesn't accept after it ran out of file descriptors.
+constexpr std::chrono::milliseconds kAcceptPause(100);
+
+// Time to answer a request, without reading and writing the socket.
+const int kRequestTime = Metrics::histogram(
+    "nerdle_server_request_ns", "Time to answer a request in ns");
+
+// Return the text in [begin, end) up to the next space, and move begin
+// behind it and the spaces that follow.
+std::string_view nextWord(const char** begin, const char* end) {
+  const char* wordEnd = *begin;
+  while (wordEnd < end && *wordEnd != ' ') { ++wordEnd; }
+  std::string_view word(*begin, wordEnd - *begin);
+  while (wordEnd < end && *wordEnd == ' ') { ++wordEnd; }
+  *begin = wordEnd;
+  return word;
+}
+}  // namespace
+
+// ____________________________________________________________________________
+GameServer::GameServer(int numThreads)
+    : numThreads_(numThreads > 0 ? numThreads
+                                 : std::thread::hardware_concurrency()),
+      listenFd_(-1), port_(0), stop_(false), numConnections_(0),
+      numGames_(0) {
+  if (numThreads_ <= 0) { numThreads_ = 1; }
+}
+
+// ____________________________________________________________________________
+GameServer::~GameServer() {
+  stop();
+  if (listenFd_ >= 0) { ::close(listenFd_); }
+  if (!unixPath_.empty()) { unlink(unixPath_.c_str()); }
+}
+
+// ____________________________________________________________________________
+size_t GameServer::raiseFileLimit(size_t numFiles) {
+  rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0) { return 0; }
+  const rlim_t wanted = numFiles == 0
+      ? limit.rlim_max : std::min<rlim_t>(numFiles, limit.rlim_max);
+  if (limit.rlim_cur < wanted) {
+    limit.rlim_cur = wanted;
+    if (setrlimit(RLIMIT_NOFILE, &limit) != 0) {
+      getrlimit(RLIMIT_NOFILE, &limit);
+    }
+  }
+  return limit.rlim_cur;
+}
+
+// ____________________________________________________________________________
+bool GameServer::listenTcp(const char* host, int port) {
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  if (inet_pton(AF_INET, host, &address.sin_addr) != 1) { return false; }
+  const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        0);
+  if (fd < 0) { return false; }
+  const int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  socklen_t length = sizeof(address);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+      || ::listen(fd, SOMAXCONN) != 0
+      || getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length)
+         != 0) {
+    ::close(fd);
+    return false;
+  }
+  listenFd_ = fd;
+  port_ = ntohs(address.sin_port);
+  return true;
+}
+
+// ____________________________________________________________________________
+bool GameServer::listenUnix(const char* path) {
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(address.sun_path)) { return false; }
+  strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+  const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        0);
+  if (fd < 0) { return false; }
+  unlink(path);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+      || ::listen(fd, SOMAXCONN) != 0) {
+    ::close(fd);
+    return false;
+  }
+  listenFd_ = fd;
+  unixPath_ = path;
+  return true;
+}
+
+// ____________________________________________________________________________
+bool GameServer::start() {
+  if (listenFd_ < 0 || !loops_.empty()) { return false; }
+  stop_ = false;
+  for (int i = 0; i < numThreads_; ++i) {
+    auto loop = std::make_unique<Loop>();
+    loop->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    loop->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    loop->accepting = false;
+    epoll_event wake = {};
+    wake.events = EPOLLIN;
+    wake.data.fd = loop->wakeFd;
+    const bool created = loop->epollFd >= 0 && loop->wakeFd >= 0
+        && epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, loop->wakeFd, &wake) == 0
+        && setAccepting(loop.get(), true);
+    if (!created) {
+      if (loop->epollFd >= 0) { ::close(loop->epollFd); }
+      if (loop->wakeFd >= 0) { ::close(loop->wakeFd); }
+      stop();
+      return false;
+    }
+    loops_.push_back(std::move(loop));
+  }
+  for (auto& loop : loops_) {
+    loop->thread = std::thread(&GameServer::run, this, loop.get());
+  }
+  return true;
+}
+
+// ____________________________________________________________________________
+void GameServer::stop() {
+  stop_ = true;
+  for (auto& loop : loops_) {
+    const uint64_t one = 1;
+    ssize_t written = ::write(loop->wakeFd, &one, sizeof(one));
+    (void)written;
+  }
+  for (auto& loop : loops_) {
+    if (loop->thread.joinable()) { loop->thread.join(); }
+    for (auto& connection : loop->connections) {
+      if (connection != nullptr) { close(loop.get(), connection.get()); }
+    }
+    ::close(loop->epollFd);
+    ::close(loop->wakeFd);
+  }
+  loops_.clear();
+}
+
+// ____________________________________________________________________________
+void GameServer::run(Loop* loop) {
+  using std::chrono::steady_clock;
+  epoll_event events[kMaxEvents];
+  while (!stop_) {
+    int timeout = -1;
+    if (!loop->accepting && steady_clock::now() >= loop->acceptAgain
+        && !setAccepting(loop, true)) {
+      loop->acceptAgain = steady_clock::now() + kAcceptPause;
+    }
+    if (!loop->accepting) {
+      timeout = std::max<int64_t>(
+          0, std::chrono::ceil<std::chrono::milliseconds>(
+                 loop->acceptAgain - steady_clock::now()).count());
+    }
+    const int numEvents = epoll_wait(loop->epollFd, events, kMaxEvents,
+                                     timeout);
+    if (numEvents < 0 && errno != EINTR) { break; }
+    for (int i = 0; i < numEvents; ++i) {
+      const int fd = events[i].data.fd;
+      if (fd == loop->wakeFd) { continue; }
+      if (fd == listenFd_) {
+        accept(loop);
+        continue;
+      }
+      Connection* connection = loop->connections[fd].get();
+      if (connection == nullptr) { continue; }
+      // Hang-ups and errors show when reading.
+      bool open = true;
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        open = read(loop, connection);
+      }
+      if (open && (events[i].events & EPOLLOUT)) {
+        open = write(loop, connection);
+      }
+      if (!open) { close(loop, connection); }
+    }
+  }
+}
+
+// ____________________________________________________________________________
+void GameServer::accept(Loop* loop) {
+  while (true) {
+    const int fd = accept4(listenFd_, nullptr, nullptr,
+                           SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) { continue; }
+      if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS
+          || errno == ENOMEM) {
+        // The connection stays pending, so the listening socket would
+        // wake this loop up right away again.
+        setAccepting(loop, false);
+        loop->acceptAgain = std::chrono::steady_clock::now() + kAcceptPause;
+      }
+      return;
+    }
+    // Answers are small and must not wait for more (fails on Unix sockets).
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+      ::close(fd);
+      continue;
+    }
+    if (loop->connections.size() <= static_cast<size_t>(fd)) {
+      loop->connections.resize(fd + 1);
+    }
+    loop->connections[fd].reset(new Connection{fd, "", "", false, false,
+                                               kNoSession});
+    ++numConnections_;
+  }
+}
+
+// ____________________________________________________________________________
+bool GameServer::setAccepting(Loop* loop, bool accepting) {
+  if (loop->accepting == accepting) { return true; }
+  // Only one of the loops wakes up for a new connection.
+  epoll_event event = {};
+  event.events = EPOLLIN | EPOLLEXCLUSIVE;
+  event.data.fd = listenFd_;
+  if (epoll_ctl(loop->epollFd, accepting ? EPOLL_CTL_ADD : EPOLL_CTL_DEL,
+                listenFd_, &event) != 0) {
+    return false;
+  }
+  loop->accepting = accepting;
+  return true;
+}
+
+// ____________________________________________________________________________
+bool GameServer::read(Loop* loop, Connection* connection) {
+  char buffer[4096];
+  const ssize_t numRead = ::read(connection->fd, buffer, sizeof(buffer));
+  if (numRead == 0) { return false; }
+  if (numRead < 0) { return errno == EAGAIN || errno == EINTR; }
+  if (connection->closing) { return true; }
+  const char* begin = buffer;
+  const char* end = buffer + numRead;
+  if (!connection->input.empty()) {
+    // the rest of a request of an earlier read
+    const char* lineEnd = static_cast<const char*>(
+        memchr(begin, '\n', end - begin));
+    connection->input.append(begin, lineEnd == nullptr ? end : lineEnd);
+    if (connection->input.size() > kMaxLineLength) { return false; }
+    if (lineEnd == nullptr) { return true; }
+    const auto start = std::chrono::steady_clock::now();
+    answer(loop, connection, connection->input.data(),
+           connection->input.size());
+    Metrics::recordSince(kRequestTime, start);
+    connection->input.clear();
+    begin = lineEnd + 1;
+  }
+  while (begin < end && !connection->closing) {
+    const char* lineEnd = static_cast<const char*>(
+        memchr(begin, '\n', end - begin));
+    if (lineEnd == nullptr) {
+      if (static_cast<size_t>(end - begin) > kMaxLineLength) { return false; }
+      connection->input.assign(begin, end);
+      break;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    answer(loop, connection, begin, lineEnd - begin);
+    Metrics::recordSince(kRequestTime, start);
+    begin = lineEnd + 1;
+  }
+  // Answers the client doesn't read would pile up without end.
+  return write(loop, connection) && connection->output.size() <= kMaxOutput;
+}
+
+// ____________________________________________________________________________
+bool GameServer::write(Loop* loop, Connection* connection) {
+  std::string& output = connection->output;
+  size_t written = 0;
+  while (written < output.size()) {
+    const ssize_t numWritten = send(connection->fd, output.data() + written,
+                                    output.size() - written, MSG_NOSIGNAL);
+    if (numWritten < 0) {
+      if (errno == EINTR) { continue; }
+      if (errno == EAGAIN) { break; }
+      return false;
+    }
+    written += numWritten;
+  }
+  output.erase(0, written);
+  if (output.empty() && connection->closing) { return false; }
+  // Wait for the socket to take more only while there is output left.
+  if (connection->writing != !output.empty()) {
+    connection->writing = !output.empty();
+    epoll_event event = {};
+    event.events = connection->writing ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.fd = connection->fd;
+    epoll_ctl(loop->epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+  }
+  return true;
+}
+
+// ____________________________________________________________________________
+void GameServer::answer(Loop* loop, Connection* connection, const char* line,
+                        size_t length) {
+  while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == ' ')) {
+    --length;
+  }
+  const char* end = line + length;
+  const std::string_view command = nextWord(&line, end);
+  std::string& output = connection->output;
+
+  if (command == "GUESS") {
+    if (connection->session == kNoSession) {
+      output += "ERROR game\n";
+      return;
+    }
+    GameSession* session = &loop->sessions[connection->session];
+    const GameSession::Result result = session->submit(line, end - line);
+    if (result != GameSession::kAccepted) {
+      output += "ERROR ";
+      output += GameSession::name(result);
+      output += '\n';
+      return;
+    }
+    char highlight[kMaxLength];
+    session->highlightOf(session->round() - 1, highlight);
+    output += "OK ";
+    output.append(highlight, session->rules()->length);
+    output += ' ';
+    output += GameSession::name(session->status());
+    if (session->status() == GameSession::kLost) {
+      output += ' ';
+      output += session->equation();
+    }
+    output += '\n';
+  } else if (command == "NEW") {
+    // The names of the variants are short, so they fit into name.
+    const std::string_view variant = nextWord(&line, end);
+    char name[16] = "classic";
+    if (!variant.empty()) {
+      name[variant.copy(name, sizeof(name) - 1)] = '\0';
+    }
+    const VariantRules* rules = VariantRules::forName(name);
+    if (rules == nullptr) {
+      output += "ERROR variant\n";
+      return;
+    }
+    uint64_t seed = 0;
+    if (line < end) {
+      const std::from_chars_result parsed = std::from_chars(line, end, seed);
+      if (parsed.ec != std::errc() || parsed.ptr != end) {
+        output += "ERROR seed\n";
+        return;
+      }
+    }
+    if (connection->session == kNoSession) {
+      connection->session = loop->sessions.allocate();
+    }
+    GameSession* session = &loop->sessions[connection->session];
+    if (line < end) {
+      Random random(seed);
+      *session = GameSession(rules, &random);
+    } else {
+      *session = GameSession(rules, &loop->random);
+    }
+    ++numGames_;
+    output += "OK ";
+    output += std::to_string(rules->length);
+    output += ' ';
+    output += std::to_string(rules->rows);
+    output += '\n';
+  } else if (command == "QUIT") {
+    output += "OK BYE\n";
+    connection->closing = true;
+  } else {
+    output += "ERROR command\n";
+  }
+}
+
+// ____________________________________________________________________________
+void GameServer::close(Loop* loop, Connection* connection) {
+  const int fd = connection->fd;
+  if (connection->session != kNoSession) {
+    loop->sessions.release(connection->session);
+  }
+  epoll_ctl(loop->epollFd, EPOLL_CTL_DEL, fd, nullptr);
+  ::close(fd);
+  loop->connections[fd].reset();
+  --numConnections_;
+}
@@ -0,0 +1,143 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef GAMESERVER_H_
+#define GAMESERVER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "./GameSession.h"
+#include "./Random.h"
+
+// Hosts games for many players at once over a TCP or Unix socket. Every
+// connection plays one game at a time with a line protocol:
+//
+//   NEW [<variant> [<seed>]]  ->  OK <length> <rows>
+//   GUESS <equation>          ->  OK <feedback> PLAYING|WON|LOST [<answer>]
+//   QUIT                      ->  OK BYE, then the server closes
+//
+// The variant is mini, classic (the default) or maxi(12), see Variant. The
+// feedback is given like by Nerdle::compareUserGuess, and the answer only
+// once the game is lost. Requests that fail get "ERROR <reason>", f.e.
+// "ERROR syntax" for a guess that isn't an equation (see GameSession).
+//
+// A few threads serve all connections, each with its own epoll event loop;
+// they take turns accepting new connections. Requests are answered in the
+// order they arrive, also if a client sends several at once. A client that
+// doesn't read its answers is disconnected once kMaxOutput bytes of them
+// are waiting. A loop that runs out of file descriptors stops accepting
+// for a moment instead of trying again and again.
+class GameServer {
+ public:
+  // Serve with the given number of threads, numThreads <= 0 means one per
+  // core.
+  explicit GameServer(int numThreads = 0);
+
+  // Stop serving.
+  ~GameServer();
+
+  GameServer(const GameServer&) = delete;
+  GameServer& operator=(const GameServer&) = delete;
+
+  // Listen on the given TCP address, f.e. "127.0.0.1", and port; port 0
+  // picks a free one (see port()). Return false if that fails.
+  bool listenTcp(const char* host, int port);
+
+  // Listen on a Unix socket at the given path, which is replaced if it
+  // exists. Return false if that fails.
+  bool listenUnix(const char* path);
+
+  // Port listened on, after listenTcp.
+  int port() const { return port_; }
+
+  // Start serving in the background. Return false if the event loops
+  // can't be created.
+  bool start();
+
+  // Stop serving and close all connections.
+  void stop();
+
+  // Number of threads that serve.
+  int numThreads() const { return numThreads_; }
+
+  // Number of open connections and of games started so far.
+  size_t numConnections() const { return numConnections_; }
+  uint64_t numGames() const { return numGames_; }
+
+  // Most bytes of answers a connection may have waiting.
+  static constexpr size_t kMaxOutput = 64 * 1024;
+
+  // Raise the limit of open file descriptors of the process to at least
+  // numFiles if the hard limit allows, and to the hard limit for numFiles
+  // 0. Return the limit that holds afterwards.
+  static size_t raiseFileLimit(size_t numFiles = 0);
+
+ private:
+  // A client, its unfinished request and answers, and its game.
+  struct Connection {
+    int fd;
+    std::string input;  // start of a request whose line break is missing
+    std::string output;  // answers the socket didn't take yet
+    bool writing;  // waiting until the socket takes more output
+    bool closing;  // close once the output is written
+    uint32_t session;  // in the pool of the loop, or kNoSession
+  };
+
+  static constexpr uint32_t kNoSession = UINT32_MAX;
+
+  // An event loop with the connections it serves, indexed by their file
+  // descriptors.
+  struct Loop {
+    int epollFd;
+    int wakeFd;  // eventfd that stop() signals
+    std::thread thread;
+    std::vector<std::unique_ptr<Connection>> connections;
+    GameSessionPool sessions;  // the games of the connections
+    Random random;  // for games without a seed
+    // Whether the listening socket is in the epoll set, and if not, when
+    // to add it again.
+    bool accepting;
+    std::chrono::steady_clock::time_point acceptAgain;
+  };
+
+  // Serve until stop() is called.
+  void run(Loop* loop);
+
+  // Accept all pending connections into the given loop.
+  void accept(Loop* loop);
+
+  // Add the listening socket to the epoll set of the given loop or remove
+  // it. Return false if that fails.
+  bool setAccepting(Loop* loop, bool accepting);
+
+  // Read the requests of a connection and answer them. Return false if the
+  // connection is to be closed.
+  bool read(Loop* loop, Connection* connection);
+
+  // Write the output of a connection, as far as the socket takes it.
+  // Return false if the connection is to be closed.
+  bool write(Loop* loop, Connection* connection);
+
+  // Append the answer to the request at line to the output of the
+  // connection.
+  void answer(Loop* loop, Connection* connection, const char* line,
+              size_t length);
+
+  void close(Loop* loop, Connection* connection);
+
+  int numThreads_;
+  int listenFd_;
+  int port_;
+  std::string unixPath_;
+  std::vector<std::unique_ptr<Loop>> loops_;
+  std::atomic<bool> stop_;
+  std::atomic<size_t> numConnections_;
+  std::atomic<uint64_t> numGames_;
+};
+
+#endif  // GAMESERVER_H_
@@ -0,0 +1,185 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "./GameServer.h"
+#include "./GameSession.h"
+#include "./Random.h"
+#include "./Variant.h"
+
+namespace {
+// Send the given requests to fd and return the next numLines answers.
+std::string request(int fd, const std::string& requests, int numLines) {
+  EXPECT_EQ(write(fd, requests.data(), requests.size()),
+            static_cast<ssize_t>(requests.size()));
+  std::string answers;
+  char c;
+  while (numLines > 0 && read(fd, &c, 1) == 1) {
+    answers += c;
+    numLines -= c == '\n';
+  }
+  return answers;
+}
+
+// Return a socket connected to the server at the given port on localhost.
+int connectTcp(int port) {
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  EXPECT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&address),
+                    sizeof(address)), 0);
+  return fd;
+}
+
+// Wait up to a second until the server has the given number of
+// connections. Return false if it doesn't.
+bool waitForConnections(const GameServer& server, size_t numConnections) {
+  for (int i = 0; i < 1000; ++i) {
+    if (server.numConnections() == numConnections) { return true; }
+    usleep(1000);
+  }
+  return false;
+}
+
+// Return the CPU time the process used so far in ms.
+int64_t cpuMs() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000
+      + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+}
+}  // namespace
+
+
+TEST(GameServerTest, play) {
+  GameServer server(2);
+  ASSERT_TRUE(server.listenTcp("127.0.0.1", 0));
+  ASSERT_TRUE(server.start());
+  const int fd = connectTcp(server.port());
+  ASSERT_EQ(request(fd, "GUESS 48-32=16\n", 1), "ERROR game\n");
+  ASSERT_EQ(request(fd, "NEW classic 42\n", 1), "OK 8 6\n");
+  // The same game as in a session with the same seed.
+  Random random(42);
+  const std::string answer =
+      GameSession(VariantRules::forName("classic"), &random).equation();
+  const std::string guess = answer == "48-32=16" ? "11+11=22" : "48-32=16";
+  GameSession session(VariantRules::forName("classic"), answer);
+  session.submit(guess.data(), guess.size());
+  std::string highlight(8, '?');
+  session.highlightOf(0, &highlight[0]);
+  ASSERT_EQ(request(fd, "GUESS " + guess + "\n", 1),
+            "OK " + highlight + " PLAYING\n");
+  // several requests at once, one of them in two parts
+  ASSERT_EQ(request(fd, "GUESS 48-32=+6\nGUESS 4", 1), "ERROR syntax\n");
+  ASSERT_EQ(request(fd, "8-32=17\r\nHELLO\nGUESS " + answer + "\n", 3),
+            "ERROR compute\nERROR command\nOK 22222222 WON\n");
+  ASSERT_EQ(request(fd, "GUESS " + answer + "\n", 1), "ERROR over\n");
+  ASSERT_EQ(request(fd, "NEW giant\nNEW mini x\nNEW mini 1\n", 3),
+            "ERROR variant\nERROR seed\nOK 6 6\n");
+  ASSERT_EQ(request(fd, "QUIT\n", 1), "OK BYE\n");
+  char c;
+  ASSERT_EQ(read(fd, &c, 1), 0);
+  close(fd);
+  ASSERT_EQ(server.numGames(), 2u);
+}
+
+TEST(GameServerTest, manyConnections) {
+  // Games that run at the same time, lost after 6 rounds.
+  const char* path = "/tmp/GameServerTest.socket";
+  GameServer server(2);
+  ASSERT_TRUE(server.listenUnix(path));
+  ASSERT_TRUE(server.start());
+  std::vector<int> fds;
+  for (int i = 0; i < 200; ++i) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+    fds.push_back(socket(AF_UNIX, SOCK_STREAM, 0));
+    ASSERT_EQ(connect(fds.back(), reinterpret_cast<sockaddr*>(&address),
+                      sizeof(address)), 0);
+    ASSERT_EQ(request(fds.back(), "NEW mini 7\n", 1), "OK 6 6\n");
+  }
+  Random random(7);
+  const std::string answer =
+      GameSession(VariantRules::forName("mini"), &random).equation();
+  const std::string guess = answer == "10-7=3" ? "10-8=2" : "10-7=3";
+  for (int round = 0; round < 6; ++round) {
+    for (int fd : fds) {
+      const std::string reply = request(fd, "GUESS " + guess + "\n", 1);
+      ASSERT_EQ(reply.substr(reply.size() - (round < 5 ? 8 : 12)),
+                round < 5 ? "PLAYING\n" : "LOST " + answer + "\n");
+    }
+  }
+  ASSERT_EQ(server.numConnections(), 200u);
+  for (int fd : fds) { close(fd); }
+  server.stop();
+  ASSERT_EQ(server.numConnections(), 0u);
+}
+
+TEST(GameServerTest, clientThatDoesntRead) {
+  GameServer server(1);
+  ASSERT_TRUE(server.listenTcp("127.0.0.1", 0));
+  ASSERT_TRUE(server.start());
+  const int fd = connectTcp(server.port());
+  // Keep the answers in the socket buffers small.
+  const int size = 4096;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+  ASSERT_TRUE(waitForConnections(server, 1));
+  // Empty lines, each answered with "ERROR command", that are never read.
+  const std::string lines(4096, '\n');
+  for (size_t sent = 0; sent < 64 * GameServer::kMaxOutput; ) {
+    const ssize_t numSent = send(fd, lines.data(), lines.size(),
+                                 MSG_NOSIGNAL);
+    if (numSent <= 0) { break; }
+    sent += numSent;
+  }
+  ASSERT_TRUE(waitForConnections(server, 0));
+  close(fd);
+}
+
+TEST(GameServerTest, outOfFiles) {
+  GameServer server(1);
+  ASSERT_TRUE(server.listenTcp("127.0.0.1", 0));
+  ASSERT_TRUE(server.start());
+  // Use up all file descriptors, then connect with a socket made before.
+  rlimit limit;
+  getrlimit(RLIMIT_NOFILE, &limit);
+  const rlimit lowered = {256, limit.rlim_max};
+  ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &lowered), 0);
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  std::vector<int> used;
+  for (int copy; (copy = dup(fd)) >= 0; ) { used.push_back(copy); }
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(server.port());
+  inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+  const bool connected = connect(fd, reinterpret_cast<sockaddr*>(&address),
+                                 sizeof(address)) == 0;
+  // The server can't accept, and doesn't keep trying meanwhile.
+  const int64_t cpuBefore = cpuMs();
+  usleep(300'000);
+  const int64_t cpuUsed = cpuMs() - cpuBefore;
+  const size_t numConnections = server.numConnections();
+  for (int copy : used) { close(copy); }
+  setrlimit(RLIMIT_NOFILE, &limit);
+  ASSERT_TRUE(connected);
+  ASSERT_EQ(numConnections, 0u);
+  ASSERT_LT(cpuUsed, 100);
+  // Once there are descriptors again, it accepts the connection.
+  ASSERT_TRUE(waitForConnections(server, 1));
+  ASSERT_EQ(request(fd, "NEW mini 1\n", 1), "OK 6 6\n");
+  close(fd);
+
+  ASSERT_GE(GameServer::raiseFileLimit(64), 64u);
+}
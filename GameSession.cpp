@@ -0,0 +1,148 @@
+// Copyright 2022 Henrik Roth
+
+#include <cstring>
+#include <string>
+#include "./GameSession.h"
+#include "./Constraints.h"
+
+// ____________________________________________________________________________
+GameSession::GameSession(const VariantRules* rules,
+                         const std::string& equation) {
+  memset(this, 0, sizeof(*this));
+  length_ = rules->length;
+  equation_ = pack(equation.data(), length_);
+  for (int i = 0; i < length_; ++i) {
+    ++symbolCounts_[PackedEquation::symbolCode(equation[i])];
+  }
+  round_ = 0;
+  status_ = kPlaying;
+}
+
+// ____________________________________________________________________________
+GameSession::GameSession(const VariantRules* rules, Random* random)
+    : GameSession(rules, rules->generate(random)) {}
+
+// ____________________________________________________________________________
+GameSession::Result GameSession::submit(const char* guess, size_t length,
+                                        const Constraints* constraints) {
+  if (status_ != kPlaying) { return kOver; }
+  if (length != length_) { return kWrongLength; }
+  const VariantRules* variant = rules();
+  if (!variant->isSyntactic(guess)) { return kNotSyntactic; }
+  if (!variant->isCorrect(guess)) { return kNotCorrect; }
+  if (constraints != nullptr && !constraints->allows(guess)) {
+    return kInconsistent;
+  }
+
+  // Green cells use up their symbol first, then magenta ones from the left
+  // take what is left of it (see Nerdle::compareUserGuess).
+  uint8_t left[kNumSymbols];
+  memcpy(left, symbolCounts_, sizeof(left));
+  uint8_t codes[kMaxLength];
+  uint8_t digits[kMaxLength];
+  for (int i = 0; i < length_; ++i) {
+    codes[i] = PackedEquation::symbolCode(guess[i]);
+    const int shift = 4 * (length_ - 1 - i);
+    const bool green = codes[i] == ((equation_ >> shift) & 0xF);
+    left[codes[i]] -= green;
+    digits[i] = 2 * green;
+  }
+  uint32_t pattern = 0;
+  for (int i = 0; i < length_; ++i) {
+    if (digits[i] == 0 && left[codes[i]] > 0) {
+      --left[codes[i]];
+      digits[i] = 1;
+    }
+    pattern = 3 * pattern + digits[i];
+  }
+
+  guesses_[round_] = pack(guess, length_);
+  patterns_[round_] = pattern;
+  ++round_;
+  uint32_t allGreen = 1;
+  for (int i = 0; i < length_; ++i) { allGreen *= 3; }
+  if (pattern == allGreen - 1) {
+    status_ = kWon;
+  } else if (round_ == variant->rows) {
+    status_ = kLost;
+  }
+  return kAccepted;
+}
+
+// ____________________________________________________________________________
+std::string GameSession::equation() const {
+  char symbols[kMaxLength];
+  unpack(equation_, length_, symbols);
+  return std::string(symbols, length_);
+}
+
+// ____________________________________________________________________________
+void GameSession::guessOf(int round, char* out) const {
+  unpack(guesses_[round], length_, out);
+}
+
+// ____________________________________________________________________________
+void GameSession::highlightOf(int round, char* out) const {
+  // '1' = black, '3' = magenta, '2' = green for the digits 0, 1, 2
+  uint32_t pattern = patterns_[round];
+  for (int i = length_ - 1; i >= 0; --i) {
+    out[i] = "132"[pattern % 3];
+    pattern /= 3;
+  }
+}
+
+// ____________________________________________________________________________
+uint64_t GameSession::pack(const char* symbols, int length) {
+  uint64_t packed = 0;
+  for (int i = 0; i < length; ++i) {
+    packed = packed << 4 | PackedEquation::symbolCode(symbols[i]);
+  }
+  return packed;
+}
+
+// ____________________________________________________________________________
+void GameSession::unpack(uint64_t packed, int length, char* out) {
+  for (int i = length - 1; i >= 0; --i) {
+    out[i] = PackedEquation::symbolChar(packed & 0xF);
+    packed >>= 4;
+  }
+}
+
+// ____________________________________________________________________________
+const char* GameSession::name(Result result) {
+  switch (result) {
+    case kAccepted: return "accepted";
+    case kWrongLength: return "length";
+    case kNotSyntactic: return "syntax";
+    case kNotCorrect: return "compute";
+    case kInconsistent: return "hard";
+    case kOver: return "over";
+  }
+  return "";
+}
+
+// ____________________________________________________________________________
+const char* GameSession::name(Status status) {
+  switch (status) {
+    case kPlaying: return "PLAYING";
+    case kWon: return "WON";
+    case kLost: return "LOST";
+  }
+  return "";
+}
+
+// ____________________________________________________________________________
+uint32_t GameSessionPool::allocate() {
+  if (!free_.empty()) {
+    const uint32_t id = free_.back();
+    free_.pop_back();
+    return id;
+  }
+  if ((next_ >> kBlockBits) == blocks_.size()) {
+    blocks_.emplace_back(new GameSession[kBlockSize]);
+  }
+  return next_++;
+}
+
+// ____________________________________________________________________________
+void GameSessionPool::release(uint32_t id) { free_.push_back(id); }
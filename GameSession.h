@@ -0,0 +1,137 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef GAMESESSION_H_
+#define GAMESESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "./PackedEquation.h"
+#include "./Random.h"
+#include "./Variant.h"
+
+// Most cells of an equation and most rounds of all variants.
+constexpr int kMaxLength = 12;
+constexpr int kMaxRows = 6;
+
+class Constraints;
+
+// State of one game, independent of how it is shown: the equation to guess
+// and the guesses so far with their feedback. Nerdle shows a session on the
+// terminal, GameServer plays sessions over sockets.
+//
+// A session is about 100 bytes without any pointers to other memory: the
+// equation and the guesses are packed with 4 bits per symbol (see
+// PackedEquation) and the feedback as pattern ids (see Feedback). So it can
+// be copied with memcpy, f.e. to save it and restore it later or to try
+// moves during a search, and many of them fit into a GameSessionPool.
+class GameSession {
+ public:
+  enum Status { kPlaying, kWon, kLost };
+
+  // What became of a submitted guess. Guesses that aren't accepted don't
+  // count as a round.
+  enum Result {
+    kAccepted,
+    kWrongLength,  // not as long as the equation
+    kNotSyntactic,  // see Nerdle::isEquationSyntactic
+    kNotCorrect,  // see Nerdle::isEquationCorrect
+    kInconsistent,  // doesn't fit the feedback so far, see Constraints
+    kOver  // the game was won or lost already
+  };
+
+  // An uninitialized session, to be assigned one of the ones below.
+  GameSession() = default;
+
+  // Start a game of the given variant in which the given equation must be
+  // guessed.
+  GameSession(const VariantRules* rules, const std::string& equation);
+
+  // Start a game of the given variant with an equation picked by the given
+  // random number generator (see Variant::generate).
+  GameSession(const VariantRules* rules, Random* random);
+
+  // Check the guess of the given length and, if it is accepted, compute its
+  // feedback and go to the next round. In the hard mode, the guess must
+  // also be allowed by the given constraints, which the caller keeps up to
+  // date.
+  Result submit(const char* guess, size_t length,
+                const Constraints* constraints = nullptr);
+
+  Status status() const { return static_cast<Status>(status_); }
+
+  // Number of accepted guesses.
+  int round() const { return round_; }
+
+  const VariantRules* rules() const {
+    return VariantRules::forLength(length_);
+  }
+  std::string equation() const;
+
+  // The feedback on the guess of the given round < round() as a base-3
+  // pattern id, like Feedback::pattern for the classic variant.
+  uint32_t pattern(int round) const { return patterns_[round]; }
+
+  // Write the guess of the given round < round() and its feedback to out,
+  // rules()->length symbols each. The feedback is given like by
+  // Nerdle::compareUserGuess: '1' = black, '2' = green, '3' = magenta.
+  void guessOf(int round, char* out) const;
+  void highlightOf(int round, char* out) const;
+
+  // Text of a result, f.e. for error messages.
+  static const char* name(Result result);
+  static const char* name(Status status);
+
+ private:
+  // Return the codes of the given symbols, the first one in the highest
+  // used nibble, like PackedEquation::pack.
+  static uint64_t pack(const char* symbols, int length);
+
+  // Write the length symbols of packed to out.
+  static void unpack(uint64_t packed, int length, char* out);
+
+  uint64_t equation_;
+  uint64_t guesses_[kMaxRows];
+  uint32_t patterns_[kMaxRows];
+  // How often each symbol (by its code) is in the equation.
+  uint8_t symbolCounts_[kNumSymbols];
+  uint8_t length_;
+  uint8_t round_ : 4;
+  uint8_t status_ : 2;
+};
+
+static_assert(std::is_trivially_copyable<GameSession>::value,
+              "sessions are copied with memcpy");
+
+// Sessions of many games in large blocks of memory. The sessions are
+// referred to by ids, which are reused once a session is released. Blocks
+// are never moved, so references to sessions stay valid.
+class GameSessionPool {
+ public:
+  // Return the id of an unused session.
+  uint32_t allocate();
+
+  // Return the session with the given id to the pool.
+  void release(uint32_t id);
+
+  GameSession& operator[](uint32_t id) {
+    return blocks_[id >> kBlockBits][id & (kBlockSize - 1)];
+  }
+
+  // Number of sessions in use.
+  size_t size() const { return next_ - free_.size(); }
+
+ private:
+  static constexpr int kBlockBits = 12;
+  static constexpr uint32_t kBlockSize = 1 << kBlockBits;
+
+  std::vector<std::unique_ptr<GameSession[]>> blocks_;
+  std::vector<uint32_t> free_;
+  // Sessions with ids below next_ were handed out at least once.
+  uint32_t next_ = 0;
+};
+
+#endif  // GAMESESSION_H_
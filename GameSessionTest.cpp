@@ -0,0 +1,105 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "./Feedback.h"
+#include "./GameSession.h"
+#include "./Random.h"
+#include "./Variant.h"
+
+namespace {
+// Return the guess of the given round and its feedback.
+std::string guessOf(const GameSession& session, int round) {
+  std::string guess(session.rules()->length, '?');
+  session.guessOf(round, &guess[0]);
+  return guess;
+}
+std::string highlightOf(const GameSession& session, int round) {
+  std::string highlight(session.rules()->length, '?');
+  session.highlightOf(round, &highlight[0]);
+  return highlight;
+}
+}  // namespace
+
+TEST(GameSessionTest, submit) {
+  GameSession session(VariantRules::forLength(8), "11+11=22");
+  ASSERT_EQ(session.submit("48-32=16", 7), GameSession::kWrongLength);
+  ASSERT_EQ(session.submit("48-32=+6", 8), GameSession::kNotSyntactic);
+  ASSERT_EQ(session.submit("48-32=17", 8), GameSession::kNotCorrect);
+  ASSERT_EQ(session.round(), 0);
+  ASSERT_EQ(session.submit("48-32=16", 8), GameSession::kAccepted);
+  ASSERT_EQ(session.round(), 1);
+  ASSERT_EQ(session.status(), GameSession::kPlaying);
+  const std::string highlight = "11113231";
+  ASSERT_EQ(session.pattern(0), Feedback::fromHighlight(&highlight));
+  ASSERT_EQ(guessOf(session, 0), "48-32=16");
+  ASSERT_EQ(highlightOf(session, 0), "11113231");
+  ASSERT_EQ(session.submit("11+11=22", 8), GameSession::kAccepted);
+  ASSERT_EQ(session.status(), GameSession::kWon);
+  ASSERT_EQ(highlightOf(session, 1), "22222222");
+  ASSERT_EQ(session.submit("11+11=22", 8), GameSession::kOver);
+  ASSERT_EQ(session.round(), 2);
+}
+
+TEST(GameSessionTest, lost) {
+  Random random(5);
+  GameSession session(VariantRules::forLength(6), &random);
+  ASSERT_EQ(session.equation().size(), 6u);
+  const std::string guess = session.equation() == "10-7=3" ? "10-8=2"
+                                                            : "10-7=3";
+  for (int round = 0; round < 6; ++round) {
+    ASSERT_EQ(session.status(), GameSession::kPlaying);
+    ASSERT_EQ(session.submit(guess.data(), guess.size()),
+              GameSession::kAccepted);
+  }
+  ASSERT_EQ(session.status(), GameSession::kLost);
+  ASSERT_EQ(session.submit(guess.data(), guess.size()), GameSession::kOver);
+}
+
+TEST(GameSessionTest, feedback) {
+  // The same feedback as the variants give, in every variant.
+  Random random(9);
+  for (int length : {6, 8, 10, 12}) {
+    const VariantRules* rules = VariantRules::forLength(length);
+    for (int i = 0; i < 200; ++i) {
+      GameSession session(rules, &random);
+      const std::string answer = session.equation();
+      const std::string guess = rules->generate(&random);
+      ASSERT_EQ(session.submit(guess.data(), guess.size()),
+                GameSession::kAccepted);
+      std::string expected(length, '?');
+      rules->compare(guess.data(), answer.data(), &expected[0]);
+      ASSERT_EQ(guessOf(session, 0), guess);
+      ASSERT_EQ(highlightOf(session, 0), expected) << guess << " " << answer;
+    }
+  }
+}
+
+TEST(GameSessionTest, snapshot) {
+  // Sessions are restored by copying their bytes.
+  GameSession session(VariantRules::forLength(8), "11+11=22");
+  ASSERT_EQ(session.submit("48-32=16", 8), GameSession::kAccepted);
+  char saved[sizeof(GameSession)];
+  memcpy(saved, &session, sizeof(session));
+  ASSERT_EQ(session.submit("11+11=22", 8), GameSession::kAccepted);
+  ASSERT_EQ(session.status(), GameSession::kWon);
+  memcpy(&session, saved, sizeof(session));
+  ASSERT_EQ(session.status(), GameSession::kPlaying);
+  ASSERT_EQ(session.round(), 1);
+  ASSERT_EQ(session.equation(), "11+11=22");
+  ASSERT_LE(sizeof(GameSession), 104u);
+
+  GameSessionPool pool;
+  std::vector<uint32_t> ids;
+  for (int i = 0; i < 10000; ++i) {
+    ids.push_back(pool.allocate());
+    pool[ids.back()] = session;
+  }
+  ASSERT_EQ(pool.size(), 10000u);
+  pool.release(ids[42]);
+  ASSERT_EQ(pool.size(), 9999u);
+  ASSERT_EQ(pool.allocate(), ids[42]);
+  ASSERT_EQ(pool[ids[9999]].round(), 1);
+}
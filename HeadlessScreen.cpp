@@ -0,0 +1,137 @@
+// Copyright 2022 Henrik Roth
+
+#include <string>
+#include "./HeadlessScreen.h"
+
+// ____________________________________________________________________________
+HeadlessScreen::HeadlessScreen(int numRows, int numCols, bool recordCalls)
+    : numRows_(numRows), numCols_(numCols), recordCalls_(recordCalls),
+      closed_(false), numReadable_(0), leaving_(false), numDrawCalls_(0),
+      numFrames_(0) {
+  drawnText_.assign(numRows * 2 * numCols, ' ');
+  drawnColors_.assign(numRows * 2 * numCols, '0');
+  shownText_ = drawnText_;
+  shownColors_ = drawnColors_;
+}
+
+// ____________________________________________________________________________
+void HeadlessScreen::type(const std::string& keys) {
+  for (char key : keys) { press(static_cast<unsigned char>(key)); }
+}
+
+// ____________________________________________________________________________
+void HeadlessScreen::paste(const std::string& keys) {
+  if (keys.empty()) { return; }
+  for (char key : keys) { script_.push_back(static_cast<unsigned char>(key)); }
+  batches_.push_back(keys.size());
+}
+
+// ____________________________________________________________________________
+void HeadlessScreen::press(int keycode) {
+  script_.push_back(keycode);
+  batches_.push_back(1);
+}
+
+// ____________________________________________________________________________
+bool HeadlessScreen::waitForInput(int /*timeoutMs*/) {
+  // The script is there at once, so waiting never takes time.
+  if (numReadable_ == 0) {
+    // the keys of the player who leaves come one by one
+    numReadable_ = 1;
+    if (!batches_.empty()) {
+      numReadable_ = batches_.front();
+      batches_.pop_front();
+    }
+  }
+  return true;
+}
+
+// ____________________________________________________________________________
+UserInput HeadlessScreen::getUserInput() {
+  UserInput userInput;
+  userInput.isMouseclick_ = false;
+  if (numReadable_ == 0) {
+    userInput.keycode_ = -1;
+    return userInput;
+  }
+  --numReadable_;
+  if (script_.empty()) {
+    userInput.keycode_ = leaving_ ? 'y' : 'q';
+    leaving_ = !leaving_;
+  } else {
+    userInput.keycode_ = script_.front();
+    script_.pop_front();
+  }
+  return userInput;
+}
+
+// ____________________________________________________________________________
+void HeadlessScreen::put(int row, int column, const char* text, int color) {
+  if (row < 0 || row >= numRows_) { return; }
+  const int width = 2 * numCols_;
+  for (; *text != '\0' && column < width; ++text, ++column) {
+    if (column >= 0) {
+      drawnText_[row * width + column] = *text;
+      drawnColors_[row * width + column] = '0' + color;
+    }
+  }
+}
+
+// ____________________________________________________________________________
+void HeadlessScreen::drawPixel(int row, int col, bool inverse, int color) {
+  ++numDrawCalls_;
+  if (recordCalls_) {
+    calls_.push_back(DrawCall{DrawCall::kPixel, row, col, color, inverse, ""});
+  }
+  put(row, 2 * col, "  ", color);
+}
+
+// ____________________________________________________________________________
+void HeadlessScreen::drawString(int row, int col, const char* output,
+                                int color, bool bold) {
+  ++numDrawCalls_;
+  if (recordCalls_) {
+    calls_.push_back(DrawCall{DrawCall::kString, row, col, color, bold,
+                              output});
+  }
+  put(row, 2 * col, output, color);
+}
+
+// ____________________________________________________________________________
+void HeadlessScreen::drawChar(int row, int col, const char* output,
+                              int color, bool bold) {
+  ++numDrawCalls_;
+  if (recordCalls_) {
+    calls_.push_back(DrawCall{DrawCall::kChar, row, col, color, bold,
+                              output});
+  }
+  put(row, 2 * col, output, color);
+}
+
+// ____________________________________________________________________________
+void HeadlessScreen::drawBox(int row, int col, int color) {
+  ++numDrawCalls_;
+  if (recordCalls_) {
+    calls_.push_back(DrawCall{DrawCall::kBox, row, col, color, false, ""});
+  }
+  for (int i = -1; i <= 1; ++i) {
+    put(row + i, 2 * (col - 1), "      ", color);
+  }
+}
+
+// ____________________________________________________________________________
+void HeadlessScreen::refresh() {
+  ++numFrames_;
+  shownText_ = drawnText_;
+  shownColors_ = drawnColors_;
+}
+
+// ____________________________________________________________________________
+std::string HeadlessScreen::text(int row) const {
+  return shownText_.substr(row * 2 * numCols_, 2 * numCols_);
+}
+
+// ____________________________________________________________________________
+std::string HeadlessScreen::colors(int row) const {
+  return shownColors_.substr(row * 2 * numCols_, 2 * numCols_);
+}
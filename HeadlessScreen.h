@@ -0,0 +1,105 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef HEADLESSSCREEN_H_
+#define HEADLESSSCREEN_H_
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+#include "./Screen.h"
+
+// A screen without a terminal: it plays keys from a script, records what is
+// drawn and counts draw calls and frames. So games can be played by tests
+// and benchmarks, f.e. "screen.type("48-32=16\n"); nerdle.play(&screen)".
+//
+// Keys arrive in batches: each waitForInput makes the next batch readable,
+// and getUserInput returns -1 once it is read. Typed keys come one by one,
+// pasted ones in one batch. Once the script is used up the player leaves:
+// the screen returns 'q' and 'y' in turns, which ends every game. Waiting
+// never sleeps.
+class HeadlessScreen : public Screen {
+ public:
+  // One call of a draw method, with its arguments.
+  struct DrawCall {
+    enum Kind { kPixel, kString, kChar, kBox };
+    Kind kind;
+    int row;
+    int col;
+    int color;
+    bool flag;  // inverse for pixels, bold for strings and chars
+    std::string text;
+  };
+
+  // A screen of the given size in pixels. If recordCalls is false, draw
+  // calls are only counted, which allocates no memory.
+  HeadlessScreen(int numRows, int numCols, bool recordCalls = true);
+
+  // Add keys to the script, each char of the string is the code of one
+  // key, f.e. '\n' for Enter. Typed keys arrive one by one, pasted keys
+  // all at once.
+  void type(const std::string& keys);
+  void paste(const std::string& keys);
+  void press(int keycode);
+
+  // Number of keys of the script that weren't read yet.
+  size_t numKeysLeft() const { return script_.size(); }
+
+  // See Screen.
+  UserInput getUserInput() override;
+  bool waitForInput(int timeoutMs) override;
+  void drawPixel(int row, int col, bool inverse, int color) override;
+  void drawString(int row, int col, const char* output, int color,
+                  bool bold = true) override;
+  void drawChar(int row, int col, const char* output, int color,
+                bool bold = true) override;
+  void drawBox(int row, int col, int color) override;
+  void refresh() override;
+  void close() override { closed_ = true; }
+  int numRows() const override { return numRows_; }
+  int numCols() const override { return numCols_; }
+
+  bool isClosed() const { return closed_; }
+
+  // The draw calls so far, if they are recorded.
+  const std::vector<DrawCall>& calls() const { return calls_; }
+
+  // Number of draw calls and of refreshes so far.
+  size_t numDrawCalls() const { return numDrawCalls_; }
+  size_t numFrames() const { return numFrames_; }
+
+  // The characters and the colors ('0' + color, '0' if nothing was drawn)
+  // of the given row of the terminal as of the last refresh, two per pixel.
+  std::string text(int row) const;
+  std::string colors(int row) const;
+
+ private:
+  // Put the given text into the given row from the given terminal column
+  // on, as far as it fits on the screen.
+  void put(int row, int column, const char* text, int color);
+
+  int numRows_;
+  int numCols_;
+  bool recordCalls_;
+  bool closed_;
+
+  std::deque<int> script_;
+  // Sizes of the batches of the script and keys left of the current one.
+  std::deque<size_t> batches_;
+  size_t numReadable_;
+  // Whether 'q' or 'y' comes next once the script is used up.
+  bool leaving_;
+
+  std::vector<DrawCall> calls_;
+  size_t numDrawCalls_;
+  size_t numFrames_;
+
+  // Characters and colors of the terminal, row by row: as of the last
+  // refresh and as drawn since.
+  std::string shownText_;
+  std::string shownColors_;
+  std::string drawnText_;
+  std::string drawnColors_;
+};
+
+#endif  // HEADLESSSCREEN_H_
@@ -0,0 +1,60 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <string>
+#include "./HeadlessScreen.h"
+
+
+TEST(HeadlessScreenTest, script) {
+  HeadlessScreen screen(10, 10);
+  screen.type("1+");
+  screen.paste("2=3\n");
+  screen.press(263);
+  ASSERT_EQ(screen.numKeysLeft(), 7u);
+  // nothing arrived yet
+  ASSERT_EQ(screen.getUserInput().keycode_, -1);
+  ASSERT_TRUE(screen.waitForInput(-1));
+  ASSERT_EQ(screen.getUserInput().keycode_, '1');
+  ASSERT_EQ(screen.getUserInput().keycode_, -1);
+  ASSERT_TRUE(screen.waitForInput(0));
+  ASSERT_EQ(screen.getUserInput().keycode_, '+');
+  ASSERT_TRUE(screen.waitForInput(0));
+  std::string pasted;
+  for (int key; (key = screen.getUserInput().keycode_) != -1;) {
+    pasted += static_cast<char>(key);
+  }
+  ASSERT_EQ(pasted, "2=3\n");
+  ASSERT_TRUE(screen.waitForInput(0));
+  ASSERT_EQ(screen.getUserInput().keycode_, 263);
+  // then the player leaves
+  for (int key : {'q', 'y', 'q'}) {
+    ASSERT_TRUE(screen.waitForInput(-1));
+    ASSERT_EQ(screen.getUserInput().keycode_, key);
+    ASSERT_EQ(screen.getUserInput().keycode_, -1);
+  }
+}
+
+TEST(HeadlessScreenTest, draw) {
+  HeadlessScreen screen(4, 5);
+  screen.drawBox(1, 1, 2);
+  screen.drawChar(1, 1, "7", 2);
+  screen.drawString(3, 3, "long text", 1, false);
+  screen.drawPixel(-1, 0, true, 3);  // off the screen
+  ASSERT_EQ(screen.numDrawCalls(), 4u);
+  ASSERT_EQ(screen.calls()[1].kind, HeadlessScreen::DrawCall::kChar);
+  ASSERT_EQ(screen.calls()[1].text, "7");
+  ASSERT_EQ(screen.calls()[2].flag, false);
+  // nothing is shown before the refresh
+  ASSERT_EQ(screen.text(1), "          ");
+  screen.refresh();
+  ASSERT_EQ(screen.numFrames(), 1u);
+  ASSERT_EQ(screen.text(1), "  7       ");
+  ASSERT_EQ(screen.colors(1), "2222220000");
+  ASSERT_EQ(screen.text(3), "      long");
+  ASSERT_EQ(screen.colors(3), "0000001111");
+  // only counted
+  HeadlessScreen counting(4, 5, false);
+  counting.drawBox(1, 1, 2);
+  ASSERT_EQ(counting.numDrawCalls(), 1u);
+  ASSERT_TRUE(counting.calls().empty());
+}
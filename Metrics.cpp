@@ -0,0 +1,276 @@
+// Copyright 2022 Henrik Roth
+
+#include <pthread.h>
+#include <signal.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "./Metrics.h"
+
+namespace {
+// The metrics recorded by one thread.
+struct Buffers {
+  std::atomic<uint64_t> counters[Metrics::kMaxCounters];
+  struct {
+    std::atomic<uint64_t> buckets[Metrics::kNumBuckets];
+    std::atomic<uint64_t> sum;
+  } histograms[Metrics::kMaxHistograms];
+};
+
+// Names and help texts of the metrics and the buffers of all threads that
+// recorded any. Buffers live as long as the process, since their totals
+// count after their thread ended.
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::pair<std::string, std::string>> counters;
+  std::vector<std::pair<std::string, std::string>> histograms;
+  std::vector<std::unique_ptr<Buffers>> buffers;
+};
+
+// Return the registry. It is never destroyed, since threads may still
+// record while the process exits.
+Registry& registry() {
+  static Registry* registry = new Registry;
+  return *registry;
+}
+
+// Return the buffers of the calling thread.
+Buffers& buffers() {
+  thread_local Buffers* buffers = nullptr;
+  if (buffers == nullptr) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    // value-initialized, so all zero
+    r.buffers.emplace_back(new Buffers());
+    buffers = r.buffers.back().get();
+  }
+  return *buffers;
+}
+
+// Add to a value that only the calling thread writes to.
+void bump(std::atomic<uint64_t>* value, uint64_t n) {
+  value->store(value->load(std::memory_order_relaxed) + n,
+               std::memory_order_relaxed);
+}
+
+// Return the id of the given name among the given metrics of the given
+// kind, registering it if it is new. Abort if there are max already.
+int registerName(std::vector<std::pair<std::string, std::string>>* metrics,
+                 const char* kind, const char* name, const char* help,
+                 int max) {
+  std::lock_guard<std::mutex> lock(registry().mutex);
+  for (size_t i = 0; i < metrics->size(); ++i) {
+    if ((*metrics)[i].first == name) { return i; }
+  }
+  if (static_cast<int>(metrics->size()) == max) {
+    // Often during static initialization, so report it right away.
+    fprintf(stderr, "Can't register the %s %s, there are %d already; raise"
+            " the limit in Metrics.h\n", kind, name, max);
+    abort();
+  }
+  metrics->emplace_back(name, help);
+  return metrics->size() - 1;
+}
+
+// A histogram added up over all threads.
+struct Snapshot {
+  std::vector<uint64_t> buckets;
+  uint64_t count = 0;
+  uint64_t sum = 0;
+};
+
+// Return the histogram with the given id over all threads. The caller
+// holds the lock of the registry.
+Snapshot snapshot(int id) {
+  Snapshot snapshot;
+  snapshot.buckets.assign(Metrics::kNumBuckets, 0);
+  for (const std::unique_ptr<Buffers>& buffers : registry().buffers) {
+    for (int i = 0; i < Metrics::kNumBuckets; ++i) {
+      const uint64_t n = buffers->histograms[id].buckets[i].load(
+          std::memory_order_relaxed);
+      snapshot.buckets[i] += n;
+      snapshot.count += n;
+    }
+    snapshot.sum += buffers->histograms[id].sum.load(
+        std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+// Return the total of the counter with the given id over all threads. The
+// caller holds the lock of the registry.
+uint64_t sum(int id) {
+  uint64_t total = 0;
+  for (const std::unique_ptr<Buffers>& buffers : registry().buffers) {
+    total += buffers->counters[id].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+// Return the largest value of the given bucket.
+uint64_t upperBound(int bucket) {
+  return bucket + 1 == Metrics::kNumBuckets
+      ? UINT64_MAX : Metrics::lowerBound(bucket + 1) - 1;
+}
+
+// Return the given quantile of the histogram.
+uint64_t quantileOf(const Snapshot& snapshot, double q) {
+  if (snapshot.count == 0) { return 0; }
+  const uint64_t rank = std::max<uint64_t>(1, std::ceil(q * snapshot.count));
+  uint64_t seen = 0;
+  for (int i = 0; i < Metrics::kNumBuckets; ++i) {
+    seen += snapshot.buckets[i];
+    if (seen >= rank) { return upperBound(i); }
+  }
+  return upperBound(Metrics::kNumBuckets - 1);
+}
+}  // namespace
+
+// ____________________________________________________________________________
+int Metrics::counter(const char* name, const char* help) {
+  return registerName(&registry().counters, "counter", name, help,
+                      kMaxCounters);
+}
+
+// ____________________________________________________________________________
+int Metrics::histogram(const char* name, const char* help) {
+  return registerName(&registry().histograms, "histogram", name, help,
+                      kMaxHistograms);
+}
+
+// ____________________________________________________________________________
+void Metrics::add(int counter, uint64_t n) {
+  bump(&buffers().counters[counter], n);
+}
+
+// ____________________________________________________________________________
+void Metrics::record(int histogram, uint64_t value) {
+  auto& buffer = buffers().histograms[histogram];
+  bump(&buffer.buckets[bucket(value)], 1);
+  bump(&buffer.sum, value);
+}
+
+// ____________________________________________________________________________
+int Metrics::bucket(uint64_t value) {
+  if (value < 16) { return value; }
+  // the highest bit and the 4 bits below it
+  const int exponent = 63 - __builtin_clzll(value);
+  return 16 * (exponent - 3) + ((value >> (exponent - 4)) & 15);
+}
+
+// ____________________________________________________________________________
+uint64_t Metrics::lowerBound(int bucket) {
+  if (bucket < 16) { return bucket; }
+  const int exponent = bucket / 16 + 3;
+  return static_cast<uint64_t>(16 + bucket % 16) << (exponent - 4);
+}
+
+// ____________________________________________________________________________
+uint64_t Metrics::total(const char* name) {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (size_t i = 0; i < r.counters.size(); ++i) {
+    if (r.counters[i].first == name) { return sum(i); }
+  }
+  return 0;
+}
+
+// ____________________________________________________________________________
+uint64_t Metrics::quantile(const char* name, double q) {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (size_t i = 0; i < r.histograms.size(); ++i) {
+    if (r.histograms[i].first == name) { return quantileOf(snapshot(i), q); }
+  }
+  return 0;
+}
+
+// ____________________________________________________________________________
+std::string Metrics::prometheus() {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  std::ostringstream out;
+  for (size_t i = 0; i < r.counters.size(); ++i) {
+    const std::string& name = r.counters[i].first;
+    out << "# HELP " << name << " " << r.counters[i].second << "\n"
+        << "# TYPE " << name << " counter\n"
+        << name << " " << sum(i) << "\n";
+  }
+  for (size_t i = 0; i < r.histograms.size(); ++i) {
+    const std::string& name = r.histograms[i].first;
+    const Snapshot s = snapshot(i);
+    out << "# HELP " << name << " " << r.histograms[i].second << "\n"
+        << "# TYPE " << name << " histogram\n";
+    uint64_t seen = 0;
+    for (int b = 0; b < kNumBuckets; ++b) {
+      if (s.buckets[b] == 0) { continue; }
+      seen += s.buckets[b];
+      out << name << "_bucket{le=\"" << upperBound(b) << "\"} " << seen
+          << "\n";
+    }
+    out << name << "_bucket{le=\"+Inf\"} " << s.count << "\n"
+        << name << "_sum " << s.sum << "\n"
+        << name << "_count " << s.count << "\n";
+  }
+  return out.str();
+}
+
+// ____________________________________________________________________________
+std::string Metrics::json() {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  std::ostringstream out;
+  out << "{\n  \"counters\": {";
+  for (size_t i = 0; i < r.counters.size(); ++i) {
+    out << (i == 0 ? "\n" : ",\n") << "    \"" << r.counters[i].first
+        << "\": " << sum(i);
+  }
+  out << "\n  },\n  \"histograms\": {";
+  for (size_t i = 0; i < r.histograms.size(); ++i) {
+    const Snapshot s = snapshot(i);
+    out << (i == 0 ? "\n" : ",\n") << "    \"" << r.histograms[i].first
+        << "\": {\"count\": " << s.count << ", \"sum\": " << s.sum;
+    for (auto [key, q] : {std::pair("p50", 0.5), std::pair("p90", 0.9),
+                          std::pair("p99", 0.99), std::pair("p999", 0.999),
+                          std::pair("max", 1.0)}) {
+      out << ", \"" << key << "\": " << quantileOf(s, q);
+    }
+    out << "}";
+  }
+  out << "\n  }\n}\n";
+  return out.str();
+}
+
+// ____________________________________________________________________________
+bool Metrics::write(const std::string& path) {
+  const bool isJson = path.size() >= 5
+      && path.compare(path.size() - 5, 5, ".json") == 0;
+  std::ofstream file(path);
+  file << (isJson ? json() : prometheus());
+  return static_cast<bool>(file);
+}
+
+// ____________________________________________________________________________
+void Metrics::writeOnSignal(const std::string& path) {
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGUSR1);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+  std::thread([path, signals]() {
+    while (true) {
+      int signal = 0;
+      sigwait(&signals, &signal);
+      write(path);
+    }
+  }).detach();
+}
@@ -0,0 +1,82 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Counters and latency histograms of the hot paths, cheap enough to stay on
+// in production. Every thread records into buffers of its own with plain
+// relaxed loads and stores, without locks or read-modify-write atomics;
+// only the first record of a thread takes a lock, to register its buffers.
+// The dumps add up the buffers of all threads.
+//
+// Metrics are registered once by name, usually into a static constant:
+//
+//   static const int kKeyTime = Metrics::histogram("nerdle_key_ns", "...");
+//   Metrics::record(kKeyTime, nanoseconds);
+//
+// Histograms keep integer values, f.e. nanoseconds, in buckets like HDR
+// histograms: exact below 16 and with 16 buckets per power of two above,
+// so percentiles are off by less than 1/16.
+class Metrics {
+ public:
+  // Most counters and histograms that can be registered. Every thread
+  // that records has buffers for all of them.
+  static constexpr int kMaxCounters = 32;
+  static constexpr int kMaxHistograms = 16;
+  // Number of buckets of a histogram: 16 exact ones and 16 for each power
+  // of two from 2^4 to 2^63.
+  static constexpr int kNumBuckets = 16 + 16 * 60;
+
+  // Register a counter or histogram with the given name and help text and
+  // return its id. Registering a name again returns the same id.
+  // Registering more than kMaxCounters or kMaxHistograms is a bug, which
+  // aborts the process with an error message.
+  static int counter(const char* name, const char* help);
+  static int histogram(const char* name, const char* help);
+
+  // Add to the counter with the given id.
+  static void add(int counter, uint64_t n = 1);
+
+  // Record a value in the histogram with the given id.
+  static void record(int histogram, uint64_t value);
+
+  // Record the time since start in nanoseconds.
+  static void recordSince(int histogram,
+                          std::chrono::steady_clock::time_point start) {
+    record(histogram, std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+  }
+
+  // Return the bucket of a value and the least value of a bucket.
+  static int bucket(uint64_t value);
+  static uint64_t lowerBound(int bucket);
+
+  // Return the total of the counter or the given quantile (0 to 1) of the
+  // histogram with the given name over all threads, 0 if it is unknown. The
+  // quantile is the largest value of the bucket it falls into.
+  static uint64_t total(const char* name);
+  static uint64_t quantile(const char* name, double q);
+
+  // Return all metrics in the text format of Prometheus, with the buckets
+  // of histograms that aren't empty, or as JSON, with the count, sum and
+  // some percentiles of histograms.
+  static std::string prometheus();
+  static std::string json();
+
+  // Write the metrics to the given file, as JSON if its name ends in
+  // ".json" and in the format of Prometheus otherwise. Return false if the
+  // file can't be written.
+  static bool write(const std::string& path);
+
+  // Write the metrics to the given file whenever the process gets SIGUSR1,
+  // from a thread of its own. Must be called before any other thread is
+  // started, which then inherit that the signal is blocked for them.
+  static void writeOnSignal(const std::string& path);
+};
+
+#endif  // METRICS_H_
@@ -0,0 +1,100 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "./Metrics.h"
+
+
+TEST(MetricsTest, buckets) {
+  // exact below 16, then 16 buckets per power of two
+  for (uint64_t value : {0, 1, 15}) {
+    ASSERT_EQ(Metrics::bucket(value), static_cast<int>(value));
+    ASSERT_EQ(Metrics::lowerBound(value), value);
+  }
+  ASSERT_EQ(Metrics::bucket(16), 16);
+  ASSERT_EQ(Metrics::bucket(31), 31);
+  ASSERT_EQ(Metrics::bucket(32), 32);
+  ASSERT_EQ(Metrics::bucket(33), 32);
+  ASSERT_EQ(Metrics::lowerBound(33), 34u);
+  ASSERT_EQ(Metrics::bucket(UINT64_MAX), Metrics::kNumBuckets - 1);
+  // every value is in the bucket whose range it is in, within 1/16
+  for (uint64_t value = 1; value < (uint64_t{1} << 62); value = value * 3 + 1) {
+    const int bucket = Metrics::bucket(value);
+    ASSERT_LE(Metrics::lowerBound(bucket), value);
+    ASSERT_GT(Metrics::lowerBound(bucket + 1), value);
+    ASSERT_LE(value - Metrics::lowerBound(bucket), value / 16);
+  }
+}
+
+TEST(MetricsTest, record) {
+  const int counter = Metrics::counter("test_events_total", "Events");
+  const int histogram = Metrics::histogram("test_latency_ns", "Latency");
+  ASSERT_EQ(Metrics::counter("test_events_total", "Events"), counter);
+  // from several threads, which all have buffers of their own
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&]() {
+      for (uint64_t i = 1; i <= 1000; ++i) {
+        Metrics::add(counter);
+        Metrics::record(histogram, i);
+      }
+    });
+  }
+  for (std::thread& thread : threads) { thread.join(); }
+  ASSERT_EQ(Metrics::total("test_events_total"), 4000u);
+  ASSERT_EQ(Metrics::quantile("test_latency_ns", 0.5), 511u);
+  ASSERT_EQ(Metrics::quantile("test_latency_ns", 1), 1023u);
+  ASSERT_EQ(Metrics::total("unknown"), 0u);
+  // Registering too many fails loudly, however many there are already.
+  ASSERT_DEATH({
+    for (int i = 0; i <= Metrics::kMaxHistograms; ++i) {
+      Metrics::histogram(("test_" + std::to_string(i)).c_str(), "");
+    }
+  }, "Can't register the histogram test_");
+  ASSERT_DEATH({
+    for (int i = 0; i <= Metrics::kMaxCounters; ++i) {
+      Metrics::counter(("test_" + std::to_string(i)).c_str(), "");
+    }
+  }, "Can't register the counter test_");
+
+  const std::string text = Metrics::prometheus();
+  ASSERT_NE(text.find("# TYPE test_events_total counter\n"
+                      "test_events_total 4000\n"), std::string::npos);
+  ASSERT_NE(text.find("test_latency_ns_bucket{le=\"15\"} 60\n"),
+            std::string::npos);
+  ASSERT_NE(text.find("test_latency_ns_bucket{le=\"+Inf\"} 4000\n"
+                      "test_latency_ns_sum 2002000\n"
+                      "test_latency_ns_count 4000\n"), std::string::npos);
+  const std::string json = Metrics::json();
+  ASSERT_NE(json.find("\"test_events_total\": 4000"), std::string::npos);
+  ASSERT_NE(json.find("\"test_latency_ns\": {\"count\": 4000, \"sum\": "
+                      "2002000, \"p50\": 511, \"p90\": 927"),
+            std::string::npos);
+}
+
+TEST(MetricsTest, writeOnSignal) {
+  const std::string path =
+      "/tmp/MetricsTest." + std::to_string(getpid()) + ".json";
+  std::remove(path.c_str());
+  Metrics::add(Metrics::counter("test_signals_total", "Signals"));
+  Metrics::writeOnSignal(path);
+  kill(getpid(), SIGUSR1);
+  std::string contents;
+  for (int i = 0; i < 100 && contents.empty(); ++i) {
+    usleep(10'000);
+    std::ifstream file(path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    contents = buffer.str();
+  }
+  std::remove(path.c_str());
+  ASSERT_NE(contents.find("\"test_signals_total\": 1"), std::string::npos);
+  ASSERT_FALSE(Metrics::write("/nonexistent/metrics.txt"));
+}
@@ -1,62 +1,137 @@
 // Copyright 2022 Henrik Roth
 
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
-#include <unordered_map>
-#include <locale>
 #include <iostream>
 #include <algorithm>
-#include <cmath>
+#include <chrono>
+#include <climits>
 #include <cstdlib>
 #include "./Nerdle.h"
-#include "./TerminalManager.h"
+#include "./EquationRules.h"
+#include "./Metrics.h"
+#include "./Screen.h"
 
+namespace {
+// How long messages like "That guess doesn't compute!" are shown.
+constexpr std::chrono::seconds kMessageTime(5);
 
-// ____________________________________________________________________________
-Nerdle::Nerdle() {
-  equation_ = generateEquation();
-  for (int i = 0; i < equation_.length(); ++i) {
-    symbolInEquation_[equation_[i]] = symbolInEquation_[equation_[i]] + 1;
+// Where the time of a game goes, see Metrics.
+const int kKeyTime = Metrics::histogram(
+    "nerdle_key_ns", "Time to handle a key and draw its effect in ns");
+const int kFrameTime = Metrics::histogram(
+    "nerdle_refresh_ns", "Time to show a frame on the screen in ns");
+const int kSleepTime = Metrics::histogram(
+    "nerdle_sleep_ns", "Time spent waiting for keys in ns");
+const int kNumGames = Metrics::counter(
+    "nerdle_games_total", "Games started");
+
+// Evaluate the parsed equation, see Nerdle::computeEquation.
+template <typename Token>
+int computeTokens(const std::vector<Token>& eq) {
+  constexpr char kSymbols[] = {' ', '+', '-', '*', '/'};
+  EquationRules::Evaluator evaluator;
+  for (Token token : eq) {
+    if (token >= 0) {
+      evaluator.number(token);
+    } else {
+      evaluator.symbol(kSymbols[-token]);
+    }
   }
+  const int64_t value = evaluator.value();
+  // A value that doesn't fit in an int is as illegal as one that overflows.
+  if (value < INT_MIN || value > INT_MAX) { return -1; }
+  return value;
+}
+}  // namespace
+
+// ____________________________________________________________________________
+Nerdle::Nerdle(Random* random, int length, bool hardMode)
+    : rules_(VariantRules::forLength(length)),
+      session_(rules_, generateEquation(random)),
+      hardMode_(hardMode), constraints_(length) {
   cursor_ = 0;
   round_ = 0;
-  userGuess_ = "????????";
-  userGuessHighlight_ = "411111111";  // cursor at the left of the first row
-  timer_ = 1;
+  userGuess_ = std::string(rules_->length, '?');
+  // cursor at the left of the first row
+  userGuessHighlight_ = "4" + std::string(rules_->length, '1');
+  textShift_ = (rules_->boardCols - ClassicVariant::kBoardCols) / 2;
+  // clear the message area right away
+  messageExpiry_ = std::chrono::steady_clock::now();
+}
+
+// ____________________________________________________________________________
+Nerdle::Nerdle() : Nerdle(&unseededRandom()) {}
+
+// ____________________________________________________________________________
+Random& Nerdle::unseededRandom() {
+  thread_local Random random;
+  return random;
 }
 
 // ____________________________________________________________________________
-bool Nerdle::play(TerminalManager* tm) {
-  if ((*tm).numRows() < 36 || (*tm).numCols() < 39) {
-    (*tm).~TerminalManager();
-    std::cout << "Terminal must be at least 36 rows and 76 columns of size!"
-                                                                  << std::endl;
+bool Nerdle::play(Screen* tm) {
+  const int boardRows = rules_->boardRows;
+  const int boardCols = rules_->boardCols;
+  if ((*tm).numRows() < boardRows || (*tm).numCols() < boardCols) {
+    (*tm).close();
+    std::cout << "Terminal must be at least " << boardRows << " rows and "
+              << boardCols << " columns of size!" << std::endl;
     return false;  // terminal to small to fit the game
   }
-  upperLeftRow_ = ((*tm).numRows() - 36) / 2;
-  upperLeftCol_ = ((*tm).numCols() - 39) / 2;
+  upperLeftRow_ = ((*tm).numRows() - boardRows) / 2;
+  upperLeftCol_ = ((*tm).numCols() - boardCols) / 2;
+  Metrics::add(kNumGames);
   drawBoard(tm);
   drawRow(tm);
   bool terminate = false;
   while (!terminate) {
-    terminate = processUserInput(tm);
-    timer_ = std::max(-1, timer_ - 1);
-    if (timer_ == 0) {  // draw over message on screen
-      for (int i = 2; i < 37; ++i) {
-        (*tm).drawPixel(upperLeftRow_ + 33, upperLeftCol_ + i, false, 1);
-        (*tm).drawPixel(upperLeftRow_ + 34, upperLeftCol_ + i, false, 4);
-        (*tm).drawPixel(upperLeftRow_ + 35, upperLeftCol_ + i, false, 1);
+    // Sleep until a key is pressed or the message on the screen expires.
+    int timeout = -1;
+    if (messageExpiry_ != kNoMessage) {
+      timeout = std::max<int64_t>(0, std::chrono::ceil<
+          std::chrono::milliseconds>(messageExpiry_
+              - std::chrono::steady_clock::now()).count());
+    }
+    auto start = std::chrono::steady_clock::now();
+    (*tm).waitForInput(timeout);
+    Metrics::recordSince(kSleepTime, start);
+    // Take all keys that arrived, f.e. a pasted guess, before redrawing.
+    while (!terminate) {
+      const UserInput ui = (*tm).getUserInput();
+      if (ui.keycode_ == -1) { break; }
+      start = std::chrono::steady_clock::now();
+      terminate = processUserInput(tm, ui.keycode_);
+      // except for q, which waits for the answer whether to quit
+      if (ui.keycode_ != 'q') { Metrics::recordSince(kKeyTime, start); }
+    }
+    if (messageExpiry_ <= std::chrono::steady_clock::now()) {
+      // draw over message on screen
+      messageExpiry_ = kNoMessage;
+      for (int i = 2; i < boardCols - 2; ++i) {
+        (*tm).drawPixel(upperLeftRow_ + boardRows - 3, upperLeftCol_ + i,
+                        false, 1);
+        (*tm).drawPixel(upperLeftRow_ + boardRows - 2, upperLeftCol_ + i,
+                        false, 4);
+        (*tm).drawPixel(upperLeftRow_ + boardRows - 1, upperLeftCol_ + i,
+                        false, 1);
       }
     }
-    usleep(50'000);  // 50 ms
+    start = std::chrono::steady_clock::now();
+    (*tm).refresh();
+    Metrics::recordSince(kFrameTime, start);
   }
-  if (round_ <= 5 && userGuessHighlight_ != "22222222") {
+  if (session_.status() == GameSession::kPlaying) {
     return false;  // game was quit via 'q'
   }
-  (*tm).drawString(upperLeftRow_ + 35, upperLeftCol_ + 8,
+  (*tm).drawString(upperLeftRow_ + boardRows - 1,
+                   upperLeftCol_ + 8 + textShift_,
                         "Press q to quit or ENTER to play another round.", 1);
+  (*tm).refresh();
   while (true) {
+    (*tm).waitForInput(-1);
     UserInput ui = (*tm).getUserInput();
     if (ui.keycode_ == 113) {
       return false;  // quit
@@ -68,289 +143,92 @@ bool Nerdle::play(TerminalManager* tm) {
 
 // ____________________________________________________________________________
 const bool Nerdle::isEquationSyntactic(const std::string* eq) const {
-  if ((*eq).length() != 8) { return false; }  // wrong length
-  bool symbolAllowed = false;
-  bool numberAllowed = true;
-  int numEq = 0;
-  // Iterating over string, each iteration determines which symbols will
-  // be legal in the next iteration via symbolAllowed, numberAllowed and numEq.
-  for (int i = 0; i < (*eq).length(); ++i) {
-    if (!std::isdigit((*eq)[i])) {
-      if (!symbolAllowed) {
-        // no arithmetic symbol is allowed because of prior character
-        return false;
-      } else if (numEq > 0) {
-        // arithmetic symbol not allowed after an equal sign has appeared
-        return false;
-      } else if ((*eq)[i] == '=') {
-        // arithmetic symbol "=" is allowed, next character must be 0-9
-        ++numEq;
-        symbolAllowed = false;
-        numberAllowed = true;
-      } else if ((*eq)[i] == '+' || (*eq)[i] == '-' || (*eq)[i] == '*'
-                                                        || (*eq)[i] == '/') {
-        // arithmetic symbol is allowed, next character must be 0-9
-        symbolAllowed = false;
-        numberAllowed = true;
-      } else {
-        // non-number that isn't an arithmetic symbol is not allowed
-        return false;
-      }
-    } else {
-      if (!numberAllowed) {
-        return false;
-      } else if ((*eq)[i] == '0') {
-        // zero allowed, next symbol may be an arithmetic one
-        symbolAllowed = true;
-        // number after zero is only allowerd when char in front of zero
-        // is also a number, else only arithmetic symbols allowed
-        if (i > 0) {
-          if (std::isdigit((*eq)[i - 1])) {
-            numberAllowed = true;
-          } else {
-            numberAllowed = false;
-          }
-        } else {
-          numberAllowed = false;
-        }
-      } else {
-        // 1-9 allowed, 0 and arithmetic symbol allowed afterwards
-        symbolAllowed = true;
-        numberAllowed = true;
-      }
-    }
-  }
-  if (numEq == 1) {
-    return true;
-  } else {
-    return false;
-  }
+  return static_cast<int>((*eq).length()) == rules_->length
+         && rules_->isSyntactic((*eq).data());
 }
 
 // ____________________________________________________________________________
 const std::pair<std::string, int>
                           Nerdle::splitEquation(const std::string* eq) const {
-  int eqPos = (*eq).find('=');
-  std::string leftSide = (*eq).substr(0, eqPos);
-  int rightSide = std::stoi((*eq).substr(eqPos + 1, (*eq).length() - eqPos));
-  return std::pair(leftSide, rightSide);
+  const std::string_view equation = *eq;
+  const size_t eqPos = equation.find('=');
+  int64_t rightSide = EquationRules::parseNumber(equation.substr(eqPos + 1));
+  // like no number if it doesn't fit in an int
+  if (rightSide > INT_MAX) { rightSide = -1; }
+  return std::pair((*eq).substr(0, eqPos), static_cast<int>(rightSide));
 }
 
 // ____________________________________________________________________________
 const std::vector<int> Nerdle::parseEquation(const std::string* eq) const {
-  std::vector<int> revEquation;
-  int numCount = 0;
-  int inputLength = (*eq).length();
-  // each iteration, arithmetic symbols will be appended to vector as negativ
-  // numbers and numbers will be eather appended (if numCount is 0) or added
-  // to the last element of the vector as multiples of powers of ten.
-  for (int i = 0; i < inputLength; ++i) {
-    int accessValue = inputLength - i - 1;
-    if (std::isdigit((*eq)[accessValue])) {
-      if (numCount == 0) {
-        revEquation.push_back(std::stoi((*eq).substr(accessValue, 1)));
-        ++numCount;
-      } else {
-        revEquation.back() = revEquation.back() +
-                (std::stoi((*eq).substr(accessValue, 1)) * pow(10, numCount));
-        ++numCount;
-      }
-    } else {
-      numCount = 0;
-      if ((*eq)[accessValue] == '+') { revEquation.push_back(PLUS); }
-      if ((*eq)[accessValue] == '-') { revEquation.push_back(MINUS); }
-      if ((*eq)[accessValue] == '*') { revEquation.push_back(TIMES); }
-      if ((*eq)[accessValue] == '/') { revEquation.push_back(DIVIDED); }
-    }
-  }
-  // Equation must be inverted so that it is the correct output.
-  std::vector<int> equation;
-  for (int j = 0; j < revEquation.size(); ++j) {
-    equation.push_back(revEquation[revEquation.size() - j - 1]);
+  std::vector<int64_t> wide;
+  parseEquation(eq, &wide);
+  std::vector<int> equation(wide.size());
+  for (size_t i = 0; i < wide.size(); ++i) {
+    equation[i] = std::min<int64_t>(wide[i], INT_MAX);
   }
   return equation;
 }
 
 // ____________________________________________________________________________
-const int Nerdle::computeEquation(const std::vector<int>* eq) const {
-  std::vector<int> simpleEquation;  // equation will only contain number, +, -
-  for (int i = 0; i < (*eq).size(); ++i) {
-    // number or +, - appeared so no computation
-    if ((*eq)[i] > -3) {
-      simpleEquation.push_back((*eq)[i]);
-    } else {
-      if ((*eq)[i] == -3) {
-        // * found
-        // x * 0 or 0 * x not allowed
-        if ((*eq)[i-1] == 0 || (*eq)[i+1] == 0) { return -1; }
-        simpleEquation.back() = simpleEquation.back() * (*eq)[i+1];
-        ++i;
-      } else {
-        // / found
-        // x / 0 or 0 / x not allowed
-        if ((*eq)[i-1] == 0 || (*eq)[i+1] == 0) { return -1; }
-        float value = 1.0 * simpleEquation.back() / (*eq)[i+1];
-        int roundValue = value;
-        // calculations leading to non-integer results not allowed
-        if (value != roundValue) { return -1; }
-        simpleEquation.back() = roundValue;
-        ++i;
+void Nerdle::parseEquation(const std::string* eq,
+                           std::vector<int64_t>* equation) const {
+  equation->clear();
+  bool inNumber = false;
+  // Digits are added to the number at the back of the vector, arithmetic
+  // symbols are appended as negative numbers.
+  for (char c : *eq) {
+    if ('0' <= c && c <= '9') {
+      if (!inNumber) { equation->push_back(0); }
+      // Numbers too big for int64 stay at its maximum.
+      int64_t& number = equation->back();
+      if (__builtin_mul_overflow(number, 10, &number)
+          || __builtin_add_overflow(number, c - '0', &number)) {
+        number = INT64_MAX;
       }
+      inNumber = true;
+      continue;
     }
+    inNumber = false;
+    if (c == '+') { equation->push_back(PLUS); }
+    if (c == '-') { equation->push_back(MINUS); }
+    if (c == '*') { equation->push_back(TIMES); }
+    if (c == '/') { equation->push_back(DIVIDED); }
   }
-  int result = 0;  // result after all arithmetic operations were carried out
-  for (int j = 0; j < simpleEquation.size(); ++j) {
-    // number appeared so no computation
-    if (simpleEquation[j] > -1) {
-      result = simpleEquation[j];
-    } else {
-      // + found
-      if (simpleEquation[j] == -1) {
-        result = result + simpleEquation[j+1];
-        ++j;
-      } else {
-        // - found
-        result = result - simpleEquation[j+1];
-        ++j;
-      }
-    }
-  }
-  return result;
+}
+
+// ____________________________________________________________________________
+const int Nerdle::computeEquation(const std::vector<int>* eq) const {
+  return computeTokens(*eq);
+}
+
+// ____________________________________________________________________________
+const int Nerdle::computeEquation(const std::vector<int64_t>* eq) const {
+  return computeTokens(*eq);
 }
 
 // ____________________________________________________________________________
 const bool Nerdle::isEquationCorrect(const std::string* eq) const {
-  const std::pair<std::string, int> splitEq = splitEquation(eq);
-  const std::vector<int> parsedEq = parseEquation(&((splitEq).first));
-  const int computedEq = computeEquation(&parsedEq);
-  return computedEq == splitEq.second;
+  return static_cast<int>((*eq).length()) == rules_->length
+         && rules_->isCorrect((*eq).data());
 }
 
 // ____________________________________________________________________________
-const std::string Nerdle::generateEquation() const {
-  std::string equation = "";
-  bool operationAppeared = false;
-  bool lastIsOperation = true;
-  bool penultimateIsOperation = false;
-  bool lastIsZero = false;
-  unsigned int currtime = (unsigned int)(time(NULL));
-  int randNum;
-  // Generate new random legal symbol or number each iteration. Legal meaning
-  // that the generated char must be compatible with the last generated char.
-  // So for example, after an * hast benn appended, the next iterations must
-  // not produce an arithmetic symbol.
-  while (true) {
-    randNum = rand_r(&currtime);
-    if (lastIsZero && penultimateIsOperation) {
-      int alsoRandNum = (randNum % 4) - 4;
-      if (alsoRandNum == PLUS) {
-        equation += "+";
-      } else if (alsoRandNum == MINUS) {
-        equation += "-";
-      } else if (alsoRandNum == TIMES) {
-        equation += "*";
-      } else {
-        equation += "/";
-      }
-      operationAppeared = true;
-      lastIsOperation = true;
-      penultimateIsOperation = false;
-      lastIsZero = false;
-    }
-    if (lastIsOperation) {
-      int alsoRandNum = randNum % 10;
-      equation += std::to_string(alsoRandNum);
-      lastIsOperation = false;
-      penultimateIsOperation = true;
-      if (alsoRandNum == 0) {
-        lastIsZero = true;
-      } else {
-        lastIsZero = false;
-      }
-    } else {
-      int alsoRandNum = (randNum % 14) - 4;
-      if (alsoRandNum >= 0) {
-        equation += std::to_string(alsoRandNum);
-        lastIsOperation = false;
-        penultimateIsOperation = false;
-        if (alsoRandNum == 0) {
-          lastIsZero = true;
-        } else {
-          lastIsZero = false;
-        }
-      } else if (alsoRandNum == PLUS) {
-        equation += "+";
-        operationAppeared = true;
-        lastIsOperation = true;
-        penultimateIsOperation = false;
-        lastIsZero = false;
-      } else if (alsoRandNum == MINUS) {
-        equation += "-";
-        operationAppeared = true;
-        lastIsOperation = true;
-        penultimateIsOperation = false;
-        lastIsZero = false;
-      } else if (alsoRandNum == TIMES) {
-        equation += "*";
-        operationAppeared = true;
-        lastIsOperation = true;
-        penultimateIsOperation = false;
-        lastIsZero = false;
-      } else {
-        equation += "/";
-        operationAppeared = true;
-        lastIsOperation = true;
-        penultimateIsOperation = false;
-        lastIsZero = false;
-      }
-    }
-    // Check wether generated equation merged with "=" and the result
-    // fits the length boundaries, if so return that equation, if it is
-    // to short, add new symbols / numbers and if its to long, discard
-    // the equation and beginn anew.
-    if (operationAppeared && std::isdigit(equation.back())) {
-      const std::vector<int> parsedEq = parseEquation(&equation);
-      const int result = computeEquation(&parsedEq);
-      std::string finalEquation = equation + "=" + std::to_string(result);
-      if (finalEquation.length() == 8 && result >= 0
-                                     && isEquationSyntactic(&finalEquation)) {
-        return finalEquation;
-      } else if (finalEquation.length() >= 8) {
-        equation = "";
-        operationAppeared = false;
-        lastIsOperation = true;
-      }
-    }
-  }
+const std::string Nerdle::generateEquation(Random* random) const {
+  return rules_->generate(random);
 }
 
 // ____________________________________________________________________________
 const std::string Nerdle::compareUserGuess(const std::string* guess) const {
-  std::unordered_map<char, int> symbolInEquationCopy = symbolInEquation_;
-  std::string userGuessHighlight = "11111111";
-  for (int i = 0; i < (*guess).length(); ++i) {
-    if ((*guess)[i] == equation_[i]) {
-      userGuessHighlight[i] = '2';  // green; symbol at right locatiom
-      symbolInEquationCopy[(*guess)[i]] -= 1;
-    }
-  }
-  for (int i = 0; i < (*guess).length(); ++i) {
-    if (userGuessHighlight[i] != '2') {
-      if (symbolInEquationCopy[(*guess)[i]] > 0) {
-        symbolInEquationCopy[(*guess)[i]] -= 1;
-        userGuessHighlight[i] = '3';  // magenta; symbol at wrong location
-      } else {
-        userGuessHighlight[i] = '1';  // black; wrong symbol
-      }
-    }
-  }
+  std::string userGuessHighlight(rules_->length, '1');
+  rules_->compare((*guess).data(), session_.equation().data(),
+                  &userGuessHighlight[0]);
   return userGuessHighlight;
 }
 
 // ____________________________________________________________________________
-void Nerdle::drawRow(TerminalManager* tm) {
+void Nerdle::drawRow(Screen* tm) {
   std::string symbol;
-  for (int i = 0; i < 8; ++i) {
+  for (int i = 0; i < rules_->length; ++i) {
     int color = userGuessHighlight_[i] - '0';
     if (userGuess_[i] != '?') {
       symbol = userGuess_.substr(i, 1);
@@ -362,31 +240,26 @@ void Nerdle::drawRow(TerminalManager* tm) {
     (*tm).drawChar(upperLeftRow_ + 5 + 5 * round_,
                               upperLeftCol_ + 5 + 4 *i, symbol.c_str(), color);
   }
-  (*tm).refresh();
 }
 
 // ____________________________________________________________________________
-void Nerdle::drawBoard(TerminalManager* tm) {
-  for (int row = upperLeftRow_; row < upperLeftRow_ + 36; ++row) {
-    for (int col = upperLeftCol_; col < upperLeftCol_ + 39; ++col) {
-      if (row == upperLeftRow_ + 1 || row == upperLeftRow_ + 34
-                   || col == upperLeftCol_ + 1 || col == upperLeftCol_ + 37) {
-        (*tm).drawPixel(row, col, false, 4);
-      }
-    }
-  }
-  for (int row = upperLeftRow_ + 3; row < upperLeftRow_ + 33; ++row) {
-    for (int col = upperLeftCol_ + 3; col < upperLeftCol_ + 36; ++col) {
+void Nerdle::drawBoard(Screen* tm) {
+  drawFrame(tm, 4);
+  for (int row = upperLeftRow_ + 3;
+       row < upperLeftRow_ + rules_->boardRows - 3; ++row) {
+    for (int col = upperLeftCol_ + 3;
+         col < upperLeftCol_ + rules_->boardCols - 3; ++col) {
       (*tm).drawPixel(row, col, true, 1);
     }
   }
-  (*tm).drawString(upperLeftRow_, upperLeftCol_ + 18, "Nerdle", 1);
-  (*tm).drawString(upperLeftRow_ + 1, upperLeftCol_ + 19, "by", 4);
-  (*tm).drawString(upperLeftRow_ + 2, upperLeftCol_ + 18, "Henrik", 1);
+  (*tm).drawString(upperLeftRow_, upperLeftCol_ + 18 + textShift_,
+                   "Nerdle", 1);
+  (*tm).drawString(upperLeftRow_ + 2, upperLeftCol_ + 18 + textShift_,
+                   "Henrik", 1);
   // (*tm).drawString(upperLeftRow_ + 33, upperLeftCol_ + 17,
   //                                                    equation_.c_str(), 1);
-  for (int i = 0; i < 6; ++i) {
-    for (int j = 0; j < 8; ++j) {
+  for (int i = 0; i < rules_->rows; ++i) {
+    for (int j = 0; j < rules_->length; ++j) {
       (*tm).drawBox(upperLeftRow_ + 5 + 5 * i, upperLeftCol_ + 5 + 4 * j, 1);
     }
   }
@@ -394,42 +267,40 @@ void Nerdle::drawBoard(TerminalManager* tm) {
 }
 
 // ____________________________________________________________________________
-void Nerdle::drawWinnerBoard(TerminalManager* tm) {
-  for (int row = upperLeftRow_; row < upperLeftRow_ + 36; ++row) {
-    for (int col = upperLeftCol_; col < upperLeftCol_ + 39; ++col) {
-      if (row == upperLeftRow_ + 1 || row == upperLeftRow_ + 34
-                   || col == upperLeftCol_ + 1 || col == upperLeftCol_ + 37) {
-        (*tm).drawPixel(row, col, false, 2);
-      }
-    }
-  }
-  (*tm).drawString(upperLeftRow_ + 1, upperLeftCol_ + 19, "by", 2);
+void Nerdle::drawWinnerBoard(Screen* tm) {
+  drawFrame(tm, 2);
   (*tm).refresh();
 }
 
 // ____________________________________________________________________________
-void Nerdle::drawLoserBoard(TerminalManager* tm) {
-  for (int row = upperLeftRow_; row < upperLeftRow_ + 36; ++row) {
-    for (int col = upperLeftCol_; col < upperLeftCol_ + 39; ++col) {
-      if (row == upperLeftRow_ + 1 || row == upperLeftRow_ + 34
-                   || col == upperLeftCol_ + 1 || col == upperLeftCol_ + 37) {
-        (*tm).drawPixel(row, col, false, 3);
+void Nerdle::drawLoserBoard(Screen* tm) {
+  drawFrame(tm, 3);
+  (*tm).refresh();
+}
+
+// ____________________________________________________________________________
+void Nerdle::drawFrame(Screen* tm, int color) {
+  const int lastRow = upperLeftRow_ + rules_->boardRows - 2;
+  const int lastCol = upperLeftCol_ + rules_->boardCols - 2;
+  for (int row = upperLeftRow_; row < upperLeftRow_ + rules_->boardRows;
+       ++row) {
+    for (int col = upperLeftCol_; col < upperLeftCol_ + rules_->boardCols;
+         ++col) {
+      if (row == upperLeftRow_ + 1 || row == lastRow
+                   || col == upperLeftCol_ + 1 || col == lastCol) {
+        (*tm).drawPixel(row, col, false, color);
       }
     }
   }
-  (*tm).drawString(upperLeftRow_ + 1, upperLeftCol_ + 19, "by", 3);
-  (*tm).refresh();
+  (*tm).drawString(upperLeftRow_ + 1, upperLeftCol_ + 19 + textShift_, "by",
+                   color);
 }
 
 // ____________________________________________________________________________
-bool Nerdle::processUserInput(TerminalManager* tm) {
-  UserInput ui = (*tm).getUserInput();
-  int key;
-  if (ui.keycode_ != -1) {
-    key = ui.keycode_;
-  } else {
-    return false;
-  }
+bool Nerdle::processUserInput(Screen* tm, int key) {
+  const int lastCell = rules_->length - 1;
+  const int messageRow = upperLeftRow_ + rules_->boardRows - 2;
+  const int messageCol = upperLeftCol_ + textShift_;
   if (key == 260) {  // Left-Arrow
     userGuessHighlight_[cursor_] = 49;  // = 1 + '0'
     cursor_ = std::max(0, cursor_ - 1);
@@ -437,53 +308,55 @@ bool Nerdle::processUserInput(TerminalManager* tm) {
     drawRow(tm);
   } else if (key == 261) {  // Right-Arrow
     userGuessHighlight_[cursor_] = 49;
-    cursor_ = std::min(cursor_ + 1, 7);
+    cursor_ = std::min(cursor_ + 1, lastCell);
     userGuessHighlight_[cursor_] = 52;
     drawRow(tm);
   } else if (47 < key && key < 58) {  // number 0-9
     userGuess_[cursor_] = key;
     userGuessHighlight_[cursor_] = 49;
-    cursor_ = std::min(cursor_ + 1, 7);
+    cursor_ = std::min(cursor_ + 1, lastCell);
     userGuessHighlight_[cursor_] = 52;
     drawRow(tm);
   } else if (key == 42) {  // arithmetic symbol *
     userGuess_[cursor_] = '*';
     userGuessHighlight_[cursor_] = 49;
-    cursor_ = std::min(cursor_ + 1, 7);
+    cursor_ = std::min(cursor_ + 1, lastCell);
     userGuessHighlight_[cursor_] = 52;
     drawRow(tm);
   } else if (key == 43) {  // arithmetic symbol +
     userGuess_[cursor_] = '+';
     userGuessHighlight_[cursor_] = 49;
-    cursor_ = std::min(cursor_ + 1, 7);
+    cursor_ = std::min(cursor_ + 1, lastCell);
     userGuessHighlight_[cursor_] = 52;
     drawRow(tm);
   } else if (key == 45) {  // arithmetic symbol -
     userGuess_[cursor_] = '-';
     userGuessHighlight_[cursor_] = 49;
-    cursor_ = std::min(cursor_ + 1, 7);
+    cursor_ = std::min(cursor_ + 1, lastCell);
     userGuessHighlight_[cursor_] = 52;
     drawRow(tm);
   } else if (key == 47) {  // arithmetic symbol /
     userGuess_[cursor_] = '/';
     userGuessHighlight_[cursor_] = 49;
-    cursor_ = std::min(cursor_ + 1, 7);
+    cursor_ = std::min(cursor_ + 1, lastCell);
     userGuessHighlight_[cursor_] = 52;
     drawRow(tm);
   } else if (key == 61) {  // arithmetic symbol =
     userGuess_[cursor_] = '=';
     userGuessHighlight_[cursor_] = 49;
-    cursor_ = std::min(cursor_ + 1, 7);
+    cursor_ = std::min(cursor_ + 1, lastCell);
     userGuessHighlight_[cursor_] = 52;
     drawRow(tm);
   } else if (key == 113) {  // q: quit
-    for (int i = 2; i < 37; ++i) {
-      (*tm).drawPixel(upperLeftRow_ + 34, upperLeftCol_ + i, false, 4);
+    for (int i = 2; i < rules_->boardCols - 2; ++i) {
+      (*tm).drawPixel(messageRow, upperLeftCol_ + i, false, 4);
     }
-    (*tm).drawString(upperLeftRow_ + 34, upperLeftCol_ + 10,
+    (*tm).drawString(messageRow, messageCol + 10,
                                   "Are you sure you want to quit?  [y/n]", 4);
-    timer_ = 1;
+    messageExpiry_ = std::chrono::steady_clock::now();
+    (*tm).refresh();
     while (true) {
+      (*tm).waitForInput(-1);
       UserInput userInput = (*tm).getUserInput();
       if (userInput.keycode_ == 121) {
         return true;
@@ -500,54 +373,61 @@ bool Nerdle::processUserInput(TerminalManager* tm) {
     }
     drawRow(tm);
   } else if (key == 10) {  // Enter
-    if (isEquationSyntactic(&userGuess_)) {
-      if (isEquationCorrect(&userGuess_)) {
-        userGuessHighlight_ = compareUserGuess(&userGuess_);
-        drawRow(tm);
-        if (userGuessHighlight_ == "22222222") {  // correct equation found
-          drawWinnerBoard(tm);
-          (*tm).drawString(upperLeftRow_ + 34, upperLeftCol_ + 15,
-                                    "Congratz! You won!", 2);
-          return true;
-        }
-        cursor_ = 0;
-        ++round_;
-        if (round_ == 6) {  // game was lost
-          drawLoserBoard(tm);
-          (*tm).drawString(upperLeftRow_ + 34, upperLeftCol_ + 16,
-                                            "Oops. You lost...", 3);
-          (*tm).drawString(upperLeftRow_ + 33, upperLeftCol_ + 13,
-                                              "Right equation:", 1);
-          (*tm).drawString(upperLeftRow_ + 33, upperLeftCol_ + 22,
-                                              equation_.c_str(), 1);
-          return true;
-        }
-        userGuess_ = "????????";
-        userGuessHighlight_ = "411111111";
-        drawRow(tm);
-      } else {  // equation is not correct content-wise
-        for (int i = 2; i < 37; ++i) {
-          (*tm).drawPixel(upperLeftRow_ + 34, upperLeftCol_ + i, false, 4);
-        }
-        (*tm).drawString(upperLeftRow_ + 34, upperLeftCol_ + 13,
-                                    "That guess doesn't compute!", 4);
-        timer_ = 100;
+    const GameSession::Result result = session_.submit(
+        userGuess_.data(), userGuess_.size(),
+        hardMode_ ? &constraints_ : nullptr);
+    if (result == GameSession::kAccepted) {
+      constraints_.add(userGuess_.data(), session_.pattern(round_));
+      userGuessHighlight_.resize(rules_->length);
+      session_.highlightOf(round_, &userGuessHighlight_[0]);
+      drawRow(tm);
+      if (session_.status() == GameSession::kWon) {  // correct equation found
+        drawWinnerBoard(tm);
+        (*tm).drawString(messageRow, messageCol + 15,
+                                  "Congratz! You won!", 2);
+        return true;
+      }
+      cursor_ = 0;
+      ++round_;
+      if (session_.status() == GameSession::kLost) {  // game was lost
+        drawLoserBoard(tm);
+        (*tm).drawString(messageRow, messageCol + 16,
+                                          "Oops. You lost...", 3);
+        (*tm).drawString(messageRow - 1, messageCol + 13,
+                                            "Right equation:", 1);
+        (*tm).drawString(messageRow - 1, messageCol + 22,
+                                  session_.equation().c_str(), 1);
+        return true;
+      }
+      userGuess_ = std::string(rules_->length, '?');
+      userGuessHighlight_ = "4" + std::string(rules_->length, '1');
+      drawRow(tm);
+    } else if (result == GameSession::kInconsistent) {  // hard mode
+      const std::string message = Constraints::message(
+          constraints_.check(userGuess_.data()));
+      for (int i = 2; i < rules_->boardCols - 2; ++i) {
+        (*tm).drawPixel(messageRow, upperLeftCol_ + i, false, 4);
       }
-    } else {  // equation is not syntactic
-      for (int i = 2; i < 37; ++i) {
-        (*tm).drawPixel(upperLeftRow_ + 34, upperLeftCol_ + i, false, 4);
+      // centered like the other messages
+      const int width = (message.size() + 3) / 4;
+      (*tm).drawString(messageRow, messageCol + 20 - width, message.c_str(),
+                       4);
+      messageExpiry_ = std::chrono::steady_clock::now() + kMessageTime;
+    } else {  // equation is not syntactic or not correct content-wise
+      for (int i = 2; i < rules_->boardCols - 2; ++i) {
+        (*tm).drawPixel(messageRow, upperLeftCol_ + i, false, 4);
       }
-      (*tm).drawString(upperLeftRow_ + 34, upperLeftCol_ + 13,
-                                    "That guess doesn't compute!", 4);
-      timer_ = 100;
+      (*tm).drawString(messageRow, messageCol + 13,
+                                  "That guess doesn't compute!", 4);
+      messageExpiry_ = std::chrono::steady_clock::now() + kMessageTime;
     }
   } else {  // no valid key was pressed
     for (int i = 12; i < 28; ++i) {
-      (*tm).drawPixel(upperLeftRow_ + 34, upperLeftCol_ + i, false, 4);
+      (*tm).drawPixel(messageRow, messageCol + i, false, 4);
     }
-    (*tm).drawString(upperLeftRow_ + 34, upperLeftCol_ + 13,
+    (*tm).drawString(messageRow, messageCol + 13,
                                     "Please press a valid key.", 4);
-      timer_ = 100;
+      messageExpiry_ = std::chrono::steady_clock::now() + kMessageTime;
   }
   return false;
 }
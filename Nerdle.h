@@ -4,11 +4,15 @@
 #define NERDLE_H_
 
 #include <gtest/gtest.h>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <utility>
-#include <unordered_map>
-#include "./TerminalManager.h"
+#include "./Constraints.h"
+#include "./GameSession.h"
+#include "./Random.h"
+#include "./Screen.h"
+#include "./Variant.h"
 
 // to make the code more readable
 #define PLUS -1
@@ -19,21 +23,37 @@
 
 class Nerdle {
  public:
-  // Initialize the game.
+  // Initialize the game with an equation picked by the given random number
+  // generator. Games created from the same seed get the same equations.
+  // The equations have the given length, which must be one of a variant
+  // (see VariantRules::forLength). In the hard mode, every guess must fit
+  // the feedback on the earlier ones (see Constraints).
+  explicit Nerdle(Random* random, int length = ClassicVariant::kLength,
+                  bool hardMode = false);
+
+  // Initialize the game with an equation that is different every time.
   Nerdle();
 
   // Play the game. Return true if another round will be played.
-  bool play(TerminalManager* terminalManager);
+  bool play(Screen* screen);
 
  private:
+  // Benchmarks of the private methods, see NerdleBench.cpp.
+  friend struct NerdleBench;
+
+  // Return the randomly seeded generator used by Nerdle(), one per thread.
+  static Random& unseededRandom();
+
   // Return true if a given string is a syntactically correct equation,
   // f.e. "42-10=32" is correct, "dr+-5=7*ea=42+4" isn't.
+  // Same as EquationRules::isSyntactic, checked with EquationValidator.
   const bool isEquationSyntactic(const std::string* eq) const;
   FRIEND_TEST(NerdleTest, isEquationSyntactic);
 
   // Split a given equation string at the equal sign into a tuple of the
   // two values left and right of the equal sign,
-  // f.e. "42-10=32" -> ("42-10", 32).
+  // f.e. "42-10=32" -> ("42-10", 32). The value is -1 if there is no
+  // number right of the equal sign or if it doesn't fit in an int.
   const std::pair<std::string, int> splitEquation(const std::string* eq) const;
   FRIEND_TEST(NerdleTest, splitEquation);
 
@@ -41,48 +61,64 @@ class Nerdle {
   // compute the equation. Arithmetic symbol will be converted into integer
   // values that won't show up in any legal equation:
   // + -> -1, - -> -2, * -> -3, / -> -4
-  // F.e. "42-10" -> [42, -2, 10].
+  // F.e. "42-10" -> [42, -2, 10]. Numbers beyond INT_MAX are INT_MAX.
   const std::vector<int> parseEquation(const std::string* eq) const;
+  // The same in 64 bits, numbers beyond INT64_MAX are INT64_MAX.
+  void parseEquation(const std::string* eq,
+                     std::vector<int64_t>* equation) const;
   FRIEND_TEST(NerdleTest, parseEquation);
 
-  // Compute result of given equation.
+  // Compute result of given equation with EquationRules::Evaluator.
   // Will return -1 if equation does "illegal" arithmetic operations like a * 0
-  // or 5 / 3.
+  // or 5 / 3, or if its value doesn't fit in an int.
   // F.e. [187, -2, 42, -3, 3, -1, 42, -4, 6, -1, 1] -> 69
   const int computeEquation(const std::vector<int>* eq) const;
+  const int computeEquation(const std::vector<int64_t>* eq) const;
   FRIEND_TEST(NerdleTest, computeEquation);
+  FRIEND_TEST(NerdleTest, evaluator);
 
   // Return true if a given equation is correct, meaning the values left and
   // right of the equal sign are equal.
   // Will only work with syntactically correct equations
   // (see isEquationSyntactic).
   // F.e. "42-10=32" is correct, "42+10=13" isn't.
+  // Same as EquationRules::isCorrect, which needs no allocations.
   const bool isEquationCorrect(const std::string* eq) const;
   FRIEND_TEST(NerdleTest, isEquationCorrect);
 
   // Generate equation that the player must guess to win the game. Generated
-  // equation will be syntactically and contentwise correct.
-  const std::string generateEquation() const;
+  // equation will be syntactically and contentwise correct. In the classic
+  // game it is picked uniformly at random from EquationIndex::classic()
+  // using the given random number generator (see Variant::generate).
+  const std::string generateEquation(Random* random) const;
   FRIEND_TEST(NerdleTest, generateEquation);
+  FRIEND_TEST(NerdleTest, equationIndex);
+  FRIEND_TEST(NerdleTest, seed);
 
   // Compare the userGuess string with the equation that is to be guessed,
   // and highlite the single symbols for their accordance
-  // (via the userGuessHighlight_ member variable).
+  // (via the userGuessHighlight_ member variable). The guess must be as long
+  // as the equation.
   const std::string compareUserGuess(const std::string* guess) const;
   FRIEND_TEST(NerdleTest, compareUserGuess);
+  FRIEND_TEST(NerdleTest, packedFeedback);
 
   // Update current row of the game drawn on the screen based on userGuess_
   // and userGuessHighlight_.
-  void drawRow(TerminalManager* tm);
+  void drawRow(Screen* tm);
 
   // Draw the "board" the game is played on at the start of the game.
-  void drawBoard(TerminalManager* tm);
+  void drawBoard(Screen* tm);
 
   // Draw a slightly modified board after the player won the game.
-  void drawWinnerBoard(TerminalManager* tm);
+  void drawWinnerBoard(Screen* tm);
 
   // Draw a slightly modified board after the player lost the game.
-  void drawLoserBoard(TerminalManager* tm);
+  void drawLoserBoard(Screen* tm);
+
+  // Draw the frame around the board and the "by" of the title in the given
+  // color.
+  void drawFrame(Screen* tm, int color);
 
   // Handle given user input and use drawRow accordingly:
   // Arrow-left or arrow-right -> move the cursor_ left / right
@@ -94,11 +130,14 @@ class Nerdle {
   // Number / arithmetic symbol -> write in userGuess at the position of the
   //                               positiom of the cursor_
   // Enter -> Check wether userGuess_ is correct (syntactically and
-  //          content-wise) and if so, use compareUserGuess and drawRow
+  //          content-wise) and, in the hard mode, fits the feedback so far.
+  //          If so, use compareUserGuess and drawRow
   //          accordingly and update cursor_, round_, userGuess_
   //          and userGuessHighlight_.
   // q ->  quit the game; return true.
-  bool processUserInput(TerminalManager* tm);
+  // The screen is refreshed by the caller, once for all keys that arrived
+  // together.
+  bool processUserInput(Screen* tm, int key);
 
   // String containing the guess currently made by user by writing on screen.
   // Parts of the string that the user didn't fill in yet are represented
@@ -111,20 +150,25 @@ class Nerdle {
   // the user guess is compared to the equation that is to be guessed.
   std::string userGuessHighlight_;
 
-  // String containing the equation the player must guess, generated by
-  // generateEquation().
-  std::string equation_;
+  // The rules of the variant that is played.
+  const VariantRules* rules_;
 
-  // Hold the numbers and arithmetic symbols that appear in the equation
-  // that the user must guess and, how often they appear for comparing
-  // that equation_ to the userGuess_.
-  std::unordered_map<char, int> symbolInEquation_;
+  // The game that is shown: the equation the player must guess, generated
+  // by generateEquation(), and the guesses so far.
+  GameSession session_;
+  FRIEND_TEST(NerdleTest, play);
+  FRIEND_TEST(NerdleTest, hardMode);
+
+  // Whether guesses must fit the feedback so far, and what it says.
+  bool hardMode_;
+  Constraints constraints_;
 
   // Integer containing the horizontal location of the "cursor" moved by
   // the player.
   int cursor_;
 
-  // Integer containing in which "round" the game currently is.
+  // Integer containing in which "round" the game currently is, which is the
+  // row of the board the player writes in.
   int round_;
 
   // Screen coordinates on which the upper left corner of the board will be
@@ -132,12 +176,16 @@ class Nerdle {
   int upperLeftRow_;
   int upperLeftCol_;
 
-  // Integer storing a certain value when a message is displayed on the screen
-  // like "That guess doesn't compute" which gets decreased by 1 (if it's
-  // not already -1) every iteration of the while loop in the play method.
-  // When the value is equal to 0, the message is deleted by drawing over
-  // the message string.
-  int timer_;
+  // Columns by which texts are moved right compared to the classic board,
+  // to keep them centered on boards of other widths.
+  int textShift_;
+
+  // Time at which a message displayed on the screen like "That guess
+  // doesn't compute" is deleted by drawing over the message string, or
+  // kNoMessage. The play method sleeps until then unless a key is pressed.
+  std::chrono::steady_clock::time_point messageExpiry_;
+  static constexpr std::chrono::steady_clock::time_point kNoMessage =
+      std::chrono::steady_clock::time_point::max();
 };
 
 
@@ -0,0 +1,533 @@
+// Copyright 2022 Henrik Roth
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+#include "./BatchChecker.h"
+#include "./CandidateSet.h"
+#include "./Constraints.h"
+#include "./EquationIndex.h"
+#include "./EquationRules.h"
+#include "./EquationValidator.h"
+#include "./Feedback.h"
+#include "./HeadlessScreen.h"
+#include "./Metrics.h"
+#include "./Nerdle.h"
+#include "./PackedEquation.h"
+#include "./Random.h"
+#include "./Solver.h"
+#include "./ThreadPool.h"
+
+// Access to the private methods of Nerdle for the benchmarks below.
+struct NerdleBench {
+  static bool isEquationSyntactic(const Nerdle& nerdle,
+                                  const std::string* eq) {
+    return nerdle.isEquationSyntactic(eq);
+  }
+  static std::pair<std::string, int> splitEquation(const Nerdle& nerdle,
+                                                   const std::string* eq) {
+    return nerdle.splitEquation(eq);
+  }
+  static std::vector<int> parseEquation(const Nerdle& nerdle,
+                                        const std::string* eq) {
+    return nerdle.parseEquation(eq);
+  }
+  static int computeEquation(const Nerdle& nerdle,
+                             const std::vector<int>* eq) {
+    return nerdle.computeEquation(eq);
+  }
+  static bool isEquationCorrect(const Nerdle& nerdle,
+                                const std::string* eq) {
+    return nerdle.isEquationCorrect(eq);
+  }
+  static std::string generateEquation(const Nerdle& nerdle, Random* random) {
+    return nerdle.generateEquation(random);
+  }
+  static std::string compareUserGuess(const Nerdle& nerdle,
+                                      const std::string* guess) {
+    return nerdle.compareUserGuess(guess);
+  }
+  static std::string equation(const Nerdle& nerdle) {
+    return nerdle.session_.equation();
+  }
+};
+
+// Number of allocations with new so far, see BM_play. All forms of new
+// and delete are replaced, so that none of them bypass the count. They
+// aren't inlined, or GCC takes the free below for a mismatched delete.
+static std::atomic<size_t> numAllocations(0);
+
+// ____________________________________________________________________________
+__attribute__((noinline)) static void* allocate(
+    size_t size, size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+  numAllocations.fetch_add(1, std::memory_order_relaxed);
+  // aligned_alloc wants a multiple of the alignment, and new never returns
+  // nullptr for a size of 0
+  size = (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+  return alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__
+      ? malloc(size) : aligned_alloc(alignment, size);
+}
+
+// ____________________________________________________________________________
+static void* allocateOrThrow(
+    size_t size, size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+  void* memory = allocate(size, alignment);
+  if (memory == nullptr) { throw std::bad_alloc(); }
+  return memory;
+}
+
+// ____________________________________________________________________________
+__attribute__((noinline)) static void deallocate(void* memory) noexcept {
+  free(memory);
+}
+
+// ____________________________________________________________________________
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+  return allocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return allocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+  return allocate(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  return allocate(size, static_cast<size_t>(alignment));
+}
+
+// ____________________________________________________________________________
+void operator delete(void* memory) noexcept { deallocate(memory); }
+void operator delete[](void* memory) noexcept { deallocate(memory); }
+void operator delete(void* memory, size_t) noexcept { deallocate(memory); }
+void operator delete[](void* memory, size_t) noexcept { deallocate(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+  deallocate(memory);
+}
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+  deallocate(memory);
+}
+void operator delete(void* memory, std::align_val_t) noexcept {
+  deallocate(memory);
+}
+void operator delete[](void* memory, std::align_val_t) noexcept {
+  deallocate(memory);
+}
+void operator delete(void* memory, size_t, std::align_val_t) noexcept {
+  deallocate(memory);
+}
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept {
+  deallocate(memory);
+}
+void operator delete(void* memory, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+  deallocate(memory);
+}
+void operator delete[](void* memory, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+  deallocate(memory);
+}
+
+namespace {
+// Number of inputs of each kind, a power of two to cycle through them.
+constexpr size_t kCorpusSize = 4096;
+
+// Inputs like those of real games, always the same (fixed seed).
+struct Corpus {
+  // Equations that can be answers.
+  std::vector<std::string> equations;
+  // What players type: half of it correct equations, the other half
+  // correct equations with one symbol replaced or two symbols swapped,
+  // which are mostly not syntactic or not correct.
+  std::vector<std::string> guesses;
+  // Left sides of the equations and their parsed form.
+  std::vector<std::string> leftSides;
+  std::vector<std::vector<int>> parsed;
+};
+
+// Return the corpus, built on first use.
+const Corpus& corpus() {
+  static const Corpus corpus = []() {
+    const std::string symbols = "0123456789+-*/=";
+    const EquationIndex& index = EquationIndex::classic();
+    Random random(2022);
+    Nerdle nerdle(&random);
+    Corpus c;
+    for (size_t i = 0; i < kCorpusSize; ++i) {
+      const std::string eq = index.equation(random.uniform(index.size()));
+      c.equations.push_back(eq);
+      std::string guess = eq;
+      if (i % 4 == 2) {
+        guess[random.uniform(8)] = symbols[random.uniform(symbols.size())];
+      } else if (i % 4 == 3) {
+        std::swap(guess[random.uniform(8)], guess[random.uniform(8)]);
+      }
+      c.guesses.push_back(guess);
+      c.leftSides.push_back(NerdleBench::splitEquation(nerdle, &eq).first);
+      c.parsed.push_back(NerdleBench::parseEquation(nerdle, &c.leftSides[i]));
+    }
+    return c;
+  }();
+  return corpus;
+}
+
+// Return the game all benchmarks on Nerdle methods use.
+const Nerdle& nerdle() {
+  static Random random(7);
+  static const Nerdle nerdle(&random);
+  return nerdle;
+}
+
+// Report the given per-call latencies in ns as percentiles.
+void reportLatencies(benchmark::State& state, std::vector<double> latencies) {
+  if (latencies.empty()) { return; }
+  std::sort(latencies.begin(), latencies.end());
+  for (auto [name, q] : {std::pair("p50_ns", 0.5), std::pair("p90_ns", 0.9),
+                         std::pair("p99_ns", 0.99),
+                         std::pair("p999_ns", 0.999)}) {
+    state.counters[name] = latencies[q * (latencies.size() - 1)];
+  }
+  state.counters["max_ns"] = latencies.back();
+}
+}  // namespace
+
+// ____________________________________________________________________________
+static void BM_isEquationSyntactic(benchmark::State& state) {
+  const Corpus& c = corpus();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        NerdleBench::isEquationSyntactic(nerdle(), &c.guesses[i]));
+    i = (i + 1) % kCorpusSize;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_isEquationSyntactic);
+
+// ____________________________________________________________________________
+static void BM_splitEquation(benchmark::State& state) {
+  const Corpus& c = corpus();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        NerdleBench::splitEquation(nerdle(), &c.equations[i]));
+    i = (i + 1) % kCorpusSize;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_splitEquation);
+
+// ____________________________________________________________________________
+static void BM_parseEquation(benchmark::State& state) {
+  const Corpus& c = corpus();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        NerdleBench::parseEquation(nerdle(), &c.leftSides[i]));
+    i = (i + 1) % kCorpusSize;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_parseEquation);
+
+// ____________________________________________________________________________
+static void BM_computeEquation(benchmark::State& state) {
+  const Corpus& c = corpus();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        NerdleBench::computeEquation(nerdle(), &c.parsed[i]));
+    i = (i + 1) % kCorpusSize;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_computeEquation);
+
+// ____________________________________________________________________________
+static void BM_isEquationCorrect(benchmark::State& state) {
+  const Corpus& c = corpus();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        NerdleBench::isEquationCorrect(nerdle(), &c.equations[i]));
+    i = (i + 1) % kCorpusSize;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_isEquationCorrect);
+
+// ____________________________________________________________________________
+static void BM_isLegal(benchmark::State& state) {
+  const Corpus& c = corpus();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(EquationRules::isLegal(c.guesses[i]));
+    i = (i + 1) % kCorpusSize;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_isLegal);
+
+// ____________________________________________________________________________
+static void BM_validate(benchmark::State& state) {
+  // all guesses of the corpus in one call
+  const Corpus& c = corpus();
+  std::string records;
+  for (const std::string& guess : c.guesses) { records += guess; }
+  std::vector<uint8_t> valid(kCorpusSize);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(EquationValidator::validate(
+        records.data(), kCorpusSize, valid.data()));
+  }
+  state.SetItemsProcessed(state.iterations() * kCorpusSize);
+}
+BENCHMARK(BM_validate);
+
+// ____________________________________________________________________________
+static void BM_generateEquation(benchmark::State& state) {
+  // Every call is timed on its own, the percentiles include the overhead
+  // of reading the clock (a few dozen ns).
+  Random random(1);
+  std::vector<double> latencies;
+  latencies.reserve(1 << 20);
+  for (auto _ : state) {
+    const auto start = std::chrono::steady_clock::now();
+    benchmark::DoNotOptimize(NerdleBench::generateEquation(nerdle(), &random));
+    const auto end = std::chrono::steady_clock::now();
+    if (latencies.size() < latencies.capacity()) {
+      latencies.push_back(
+          std::chrono::duration<double, std::nano>(end - start).count());
+    }
+  }
+  reportLatencies(state, latencies);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_generateEquation);
+
+// ____________________________________________________________________________
+static void BM_compareUserGuess(benchmark::State& state) {
+  const Corpus& c = corpus();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        NerdleBench::compareUserGuess(nerdle(), &c.equations[i]));
+    i = (i + 1) % kCorpusSize;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_compareUserGuess);
+
+// ____________________________________________________________________________
+static void BM_feedbackPattern(benchmark::State& state) {
+  const EquationIndex& index = EquationIndex::classic();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Feedback::pattern(
+        index.packed(i), index.packed(index.size() - 1 - i)));
+    i = (i + 1) % index.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_feedbackPattern);
+
+// ____________________________________________________________________________
+static void BM_feedbackPatterns(benchmark::State& state) {
+  // one guess against every answer
+  const EquationIndex& index = EquationIndex::classic();
+  std::vector<uint16_t> patterns(index.size());
+  size_t i = 0;
+  for (auto _ : state) {
+    Feedback::patterns(index.packed(i), index.data(), index.size(),
+                       patterns.data());
+    benchmark::DoNotOptimize(patterns.data());
+    i = (i + 1) % index.size();
+  }
+  state.SetItemsProcessed(state.iterations() * index.size());
+}
+BENCHMARK(BM_feedbackPatterns);
+
+// ____________________________________________________________________________
+static void BM_NerdleConstruction(benchmark::State& state) {
+  Random random(3);
+  for (auto _ : state) {
+    Nerdle game(&random);
+    benchmark::DoNotOptimize(&game);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NerdleConstruction);
+
+// ____________________________________________________________________________
+static void BM_candidateSetApply(benchmark::State& state) {
+  const EquationIndex& index = EquationIndex::classic();
+  const CandidateIndex candidateIndex(&index);
+  CandidateSet candidates(&candidateIndex);
+  const Corpus& c = corpus();
+  size_t i = 0;
+  for (auto _ : state) {
+    const uint32_t guess = PackedEquation::pack(&c.equations[i]);
+    const uint32_t answer = PackedEquation::pack(&c.equations[i ^ 1]);
+    candidates.apply(guess, Feedback::pattern(guess, answer));
+    benchmark::DoNotOptimize(candidates.size());
+    candidates.undo();
+    i = (i + 1) % kCorpusSize;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_candidateSetApply);
+
+// ____________________________________________________________________________
+static void BM_solverSuggest(benchmark::State& state) {
+  // second move of a game, after a good opening
+  const EquationIndex& index = EquationIndex::classic();
+  ThreadPool pool(1);
+  Solver solver(&index, &index, &pool);
+  const std::string opening = "48-32=16";
+  const Corpus& c = corpus();
+  size_t i = 0;
+  for (auto _ : state) {
+    const uint32_t guess = PackedEquation::pack(&opening);
+    const uint32_t answer = PackedEquation::pack(&c.equations[i]);
+    const std::vector<uint32_t> candidates =
+        solver.candidates({{guess, Feedback::pattern(guess, answer)}});
+    benchmark::DoNotOptimize(solver.suggest(candidates, 1, Solver::kEntropy));
+    i = (i + 1) % kCorpusSize;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_solverSuggest)->Unit(benchmark::kMillisecond);
+
+// ____________________________________________________________________________
+static void BM_checkConstraints(benchmark::State& state) {
+  // the feedback of three rounds against one answer, as in the hard mode
+  const Corpus& c = corpus();
+  GameSession session(VariantRules::forLength(8), c.equations[0]);
+  Constraints constraints(8);
+  for (int round = 1; round <= 3; ++round) {
+    session.submit(c.equations[round].data(), 8);
+    constraints.add(c.equations[round].data(), session.pattern(round - 1));
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(constraints.check(c.equations[i].data()));
+    i = (i + 1) % kCorpusSize;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_checkConstraints);
+
+// ____________________________________________________________________________
+static void BM_checkRecord(benchmark::State& state) {
+  // guess and answer, as submitted for checking
+  const Corpus& c = corpus();
+  std::vector<std::string> records;
+  for (size_t i = 0; i < kCorpusSize; ++i) {
+    records.push_back(c.guesses[i] + " " + c.equations[i ^ 1]);
+  }
+  char out[64];
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(BatchChecker::checkRecord(
+        records[i].data(), records[i].size(), out));
+    i = (i + 1) % kCorpusSize;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_checkRecord);
+
+// ____________________________________________________________________________
+static void BM_batchCheck(benchmark::State& state) {
+  // all records of the corpus in one block, on all threads
+  const Corpus& c = corpus();
+  std::string input;
+  for (size_t i = 0; i < kCorpusSize; ++i) {
+    input += c.guesses[i] + " " + c.equations[i ^ 1] + "\n";
+  }
+  ThreadPool pool;
+  BatchChecker checker(&pool);
+  std::vector<char> out;
+  for (auto _ : state) {
+    out.clear();
+    benchmark::DoNotOptimize(checker.check(input.data(), input.size(), &out));
+  }
+  state.SetItemsProcessed(state.iterations() * kCorpusSize);
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_batchCheck);
+
+// ____________________________________________________________________________
+static void BM_recordMetric(benchmark::State& state) {
+  // a latency like those of the game, as recorded on its hot paths
+  static const int histogram = Metrics::histogram(
+      "bench_latency_ns", "Latency recorded by BM_recordMetric");
+  uint64_t value = 1000;
+  for (auto _ : state) {
+    Metrics::record(histogram, value);
+    value = (value * 13 + 7) % 100'000;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_recordMetric);
+
+// ____________________________________________________________________________
+static void BM_play(benchmark::State& state) {
+  // Whole games on a headless screen, typed like by a player: four wrong
+  // guesses with some corrections, one that doesn't compute, then the
+  // answer. Reports the frames per game, the draw calls per frame and the
+  // allocations per key, and the time per frame as "frames" (inverted).
+  const Corpus& c = corpus();
+  Random random(3);
+  size_t numKeys = 0;
+  size_t numFrames = 0;
+  size_t numDrawCalls = 0;
+  size_t allocations = 0;
+  size_t i = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    Nerdle nerdle(&random);
+    HeadlessScreen screen(40, 50, false);
+    for (int round = 0; round < 4; ++round) {
+      screen.type(c.equations[i].substr(0, 6));
+      screen.press(263);  // Backspace
+      screen.press(260);  // Left-Arrow
+      screen.type(c.equations[i].substr(4) + "\n");
+      i = (i + 1) % kCorpusSize;
+    }
+    screen.type(c.guesses[2] + "\n");
+    screen.type(NerdleBench::equation(nerdle) + "\nq");
+    numKeys += screen.numKeysLeft();
+    const size_t allocationsBefore = numAllocations;
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(nerdle.play(&screen));
+    allocations += numAllocations - allocationsBefore;
+    numFrames += screen.numFrames();
+    numDrawCalls += screen.numDrawCalls();
+  }
+  state.counters["frames"] = benchmark::Counter(
+      numFrames, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.counters["frames_per_game"] =
+      static_cast<double>(numFrames) / state.iterations();
+  state.counters["draws_per_frame"] =
+      static_cast<double>(numDrawCalls) / numFrames;
+  state.counters["allocs_per_key"] =
+      static_cast<double>(allocations) / numKeys;
+  state.SetItemsProcessed(numKeys);
+}
+BENCHMARK(BM_play);
+
+BENCHMARK_MAIN();
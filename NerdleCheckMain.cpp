@@ -0,0 +1,59 @@
+// Copyright 2022 Henrik Roth
+
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "./BatchChecker.h"
+#include "./ThreadPool.h"
+
+
+// Check guesses submitted elsewhere, one per line and optionally followed by
+// the answer, f.e. "NerdleCheckMain guesses.txt > results.txt" or
+// "... | NerdleCheckMain". See BatchChecker for the format.
+int main(int argc, char** argv) {
+  int numThreads = 0;
+  const char* path = nullptr;
+  bool stats = false;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      numThreads = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--stats") == 0) {
+      stats = true;
+    } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+      usage = usage || path != nullptr;
+      path = argv[i];
+    } else {
+      usage = true;
+    }
+  }
+  if (usage) {
+    std::cerr << "Usage: " << argv[0] << " [--threads <n>] [--stats]"
+              << " [<file> | -]" << std::endl;
+    return 1;
+  }
+
+  ThreadPool pool(numThreads);
+  BatchChecker checker(&pool);
+  const auto start = std::chrono::steady_clock::now();
+  const bool checked = path == nullptr || strcmp(path, "-") == 0
+      ? checker.checkStream(STDIN_FILENO, STDOUT_FILENO)
+      : checker.checkFile(path, STDOUT_FILENO);
+  if (!checked) {
+    std::cerr << "Checking " << (path == nullptr ? "-" : path) << " failed: "
+              << strerror(errno) << std::endl;
+    return 1;
+  }
+  if (stats) {
+    const std::chrono::duration<double> seconds =
+        std::chrono::steady_clock::now() - start;
+    std::cerr << checker.numRecords() << " records in " << seconds.count()
+              << " s on " << pool.numThreads() << " thread(s), "
+              << checker.numRecords() / seconds.count() << " records/s"
+              << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,233 @@
+// Copyright 2022 Henrik Roth
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./GameServer.h"
+#include "./Random.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// A simulated player on its own connection.
+struct Player {
+  int fd;
+  std::string input;  // start of an answer whose line break is missing
+  bool inGame;  // a game was started and isn't over yet
+  bool guessing;  // the request in flight is a guess, not a new game
+  Clock::time_point sentAt;
+};
+
+// Return a socket connected to the server, or -1.
+int connectTo(const std::string& host, int port, const char* unixPath) {
+  int fd;
+  if (unixPath != nullptr) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, unixPath, sizeof(address.sun_path) - 1);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address),
+                           sizeof(address)) != 0) {
+      close(fd);
+      return -1;
+    }
+  } else {
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    inet_pton(AF_INET, host.c_str(), &address.sin_addr);
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address),
+                           sizeof(address)) != 0) {
+      close(fd);
+      return -1;
+    }
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+  return fd;
+}
+
+// Return the given percentile of sorted latencies in microseconds.
+double percentile(const std::vector<int64_t>& sorted, double q) {
+  return sorted.empty() ? 0 : sorted[q * (sorted.size() - 1)] / 1000.0;
+}
+}  // namespace
+
+
+// Play many games at once against a running NerdleServerMain and measure
+// how long the server takes to answer a guess, f.e.
+// "NerdleLoadMain --connections 10000 --rate 20000 --seconds 10". Every
+// player guesses random equations at random times, at the given number of
+// guesses per second over all players. Fail if the 99th percentile of the
+// latency is above --max-p99-us.
+int main(int argc, char** argv) {
+  std::string host = "127.0.0.1";
+  int port = 7000;
+  const char* unixPath = nullptr;
+  size_t numPlayers = 10'000;
+  double rate = 10'000;
+  double seconds = 10;
+  double maxP99 = 1000;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+      host = argv[++i];
+    } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+      port = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--unix") == 0 && i + 1 < argc) {
+      unixPath = argv[++i];
+    } else if (strcmp(argv[i], "--connections") == 0 && i + 1 < argc) {
+      numPlayers = std::stoull(argv[++i]);
+    } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+      rate = std::stod(argv[++i]);
+    } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+      seconds = std::stod(argv[++i]);
+    } else if (strcmp(argv[i], "--max-p99-us") == 0 && i + 1 < argc) {
+      maxP99 = std::stod(argv[++i]);
+    } else {
+      usage = true;
+    }
+  }
+  if (usage || numPlayers == 0 || rate <= 0) {
+    std::cerr << "Usage: " << argv[0] << " [--host <address>] [--port <n>]"
+              << " [--unix <path>] [--connections <n>] [--rate <guesses/s>]"
+              << " [--seconds <s>] [--max-p99-us <us>]" << std::endl;
+    return 1;
+  }
+
+  // A file descriptor per player, and a few more.
+  const size_t numFiles = numPlayers + 64;
+  const size_t fileLimit = GameServer::raiseFileLimit(numFiles);
+  if (fileLimit < numFiles) {
+    std::cerr << "Can't open " << numPlayers << " connections, at most "
+              << fileLimit << " files may be open" << std::endl;
+    return 1;
+  }
+
+  const int epollFd = epoll_create1(EPOLL_CLOEXEC);
+  // Every player starts a game first and then guesses until it is over.
+  std::vector<Player> players(numPlayers, Player{-1, "", false, false, {}});
+  for (size_t i = 0; i < numPlayers; ++i) {
+    players[i].fd = connectTo(host, port, unixPath);
+    if (players[i].fd < 0) {
+      std::cerr << "Connection " << i << " failed: " << strerror(errno)
+                << std::endl;
+      return 1;
+    }
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = i;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, players[i].fd, &event);
+  }
+  std::cout << numPlayers << " players connected" << std::endl;
+
+  // Players wait on average numPlayers / rate between their guesses, so
+  // that all of them together guess at the given rate.
+  const EquationIndex& index = EquationIndex::classic();
+  Random random(42);
+  const auto meanPause = std::chrono::duration<double>(numPlayers / rate);
+  auto pause = [&]() {
+    return std::chrono::duration_cast<Clock::duration>(
+        meanPause * (0.5 + random.uniform(1'000'000) / 1e6));
+  };
+  using Due = std::pair<Clock::time_point, size_t>;
+  std::priority_queue<Due, std::vector<Due>, std::greater<Due>> due;
+  const Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < numPlayers; ++i) { due.push({start + pause(), i}); }
+  const Clock::time_point end = start
+      + std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(seconds));
+
+  std::vector<int64_t> latencies;
+  size_t numGames = 0;
+  size_t numErrors = 0;
+  std::vector<epoll_event> events(1024);
+  char buffer[4096];
+  while (true) {
+    Clock::time_point now = Clock::now();
+    if (now >= end) { break; }
+    while (!due.empty() && due.top().first <= now) {
+      const size_t i = due.top().second;
+      due.pop();
+      Player& player = players[i];
+      std::string request = player.inGame
+          ? "GUESS " + index.equation(random.uniform(index.size())) + "\n"
+          : "NEW classic\n";
+      player.guessing = player.inGame;
+      player.sentAt = Clock::now();
+      if (send(player.fd, request.data(), request.size(), MSG_NOSIGNAL)
+          != static_cast<ssize_t>(request.size())) {
+        std::cerr << "Sending failed: " << strerror(errno) << std::endl;
+        return 1;
+      }
+    }
+    const auto wait = due.empty() ? end - now : due.top().first - now;
+    const int timeout = std::chrono::ceil<std::chrono::milliseconds>(
+        std::min<Clock::duration>(wait, end - now)).count();
+    const int numEvents = epoll_wait(epollFd, events.data(), events.size(),
+                                     std::max(0, timeout));
+    now = Clock::now();
+    for (int e = 0; e < numEvents; ++e) {
+      const size_t i = events[e].data.u64;
+      Player& player = players[i];
+      const ssize_t numRead = read(player.fd, buffer, sizeof(buffer));
+      if (numRead <= 0) {
+        std::cerr << "Connection " << i << " closed" << std::endl;
+        return 1;
+      }
+      player.input.append(buffer, numRead);
+      size_t lineEnd;
+      while ((lineEnd = player.input.find('\n')) != std::string::npos) {
+        const std::string answer = player.input.substr(0, lineEnd);
+        player.input.erase(0, lineEnd + 1);
+        if (answer.compare(0, 3, "OK ") != 0) {
+          ++numErrors;
+        } else if (player.guessing) {
+          latencies.push_back(std::chrono::duration_cast<
+              std::chrono::nanoseconds>(now - player.sentAt).count());
+          player.inGame = answer.find("PLAYING") != std::string::npos;
+        } else {
+          player.inGame = true;
+          ++numGames;
+        }
+        due.push({now + pause(), i});
+      }
+    }
+  }
+  const double elapsed =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  for (Player& player : players) { close(player.fd); }
+  close(epollFd);
+
+  std::sort(latencies.begin(), latencies.end());
+  const double p99 = percentile(latencies, 0.99);
+  std::cout << latencies.size() << " guesses in " << numGames << " games, "
+            << latencies.size() / elapsed << " guesses/s, " << numErrors
+            << " errors" << std::endl
+            << "Latency in us: p50 " << percentile(latencies, 0.5)
+            << ", p90 " << percentile(latencies, 0.9) << ", p99 " << p99
+            << ", p999 " << percentile(latencies, 0.999) << ", max "
+            << percentile(latencies, 1) << std::endl;
+  if (numErrors > 0 || p99 > maxP99) {
+    std::cout << "FAILED: p99 must be at most " << maxP99 << " us and no"
+              << " request may fail" << std::endl;
+    return 1;
+  }
+  return 0;
+}
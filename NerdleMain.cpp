@@ -1,15 +1,57 @@
 // Copyright 2022 Henrik Roth
 
-#include "./TerminalManager.h"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "./Metrics.h"
 #include "./Nerdle.h"
+#include "./TerminalManager.h"
+#include "./Random.h"
+#include "./Variant.h"
 
 
-int main() {
+int main(int argc, char** argv) {
+  // The equations are random unless a seed is given, either explicitly or
+  // via --daily for the puzzle of the day.
+  Random random;
+  int length = ClassicVariant::kLength;
+  bool hardMode = false;
+  std::string metricsPath;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      random = Random(std::stoull(argv[++i]));
+    } else if (strcmp(argv[i], "--daily") == 0) {
+      random = Random(Random::dailySeed());
+    } else if (strcmp(argv[i], "--variant") == 0 && i + 1 < argc) {
+      const VariantRules* rules = VariantRules::forName(argv[++i]);
+      if (rules == nullptr) {
+        std::cerr << "Unknown variant: " << argv[i] << std::endl;
+        return 1;
+      }
+      length = rules->length;
+    } else if (strcmp(argv[i], "--hard") == 0) {
+      hardMode = true;
+    } else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+      metricsPath = argv[++i];
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--seed <n> | --daily]"
+                << " [--variant mini|classic|maxi|maxi12] [--hard]"
+                << " [--metrics <file>[.json]]" << std::endl;
+      return 1;
+    }
+  }
+  // The metrics are written on SIGUSR1 and when the game ends.
+  if (!metricsPath.empty()) { Metrics::writeOnSignal(metricsPath); }
   TerminalManager tm;
   bool run = true;
   while (run) {
-    Nerdle nerdle;
+    Nerdle nerdle(&random, length, hardMode);
     run = nerdle.play(&tm);
   }
+  if (!metricsPath.empty() && !Metrics::write(metricsPath)) {
+    tm.close();
+    std::cerr << "Can't write the metrics to " << metricsPath << std::endl;
+    return 1;
+  }
 }
-
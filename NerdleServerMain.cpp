@@ -0,0 +1,80 @@
+// Copyright 2022 Henrik Roth
+
+#include <pthread.h>
+#include <signal.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "./GameServer.h"
+#include "./Metrics.h"
+
+
+// Host games over a socket until SIGINT or SIGTERM, f.e.
+// "NerdleServerMain --port 7000" or "NerdleServerMain --unix /tmp/nerdle".
+// See GameServer for the protocol. With --metrics, the metrics are written
+// to the given file on SIGUSR1 and when the server stops.
+int main(int argc, char** argv) {
+  std::string host = "127.0.0.1";
+  int port = 7000;
+  const char* unixPath = nullptr;
+  int numThreads = 0;
+  std::string metricsPath;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+      host = argv[++i];
+    } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+      port = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--unix") == 0 && i + 1 < argc) {
+      unixPath = argv[++i];
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      numThreads = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+      metricsPath = argv[++i];
+    } else {
+      usage = true;
+    }
+  }
+  if (usage) {
+    std::cerr << "Usage: " << argv[0] << " [--host <address>] [--port <n>]"
+              << " [--unix <path>] [--threads <n>]"
+              << " [--metrics <file>[.json]]" << std::endl;
+    return 1;
+  }
+
+  // The signals are taken below, by this thread only.
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+  if (!metricsPath.empty()) { Metrics::writeOnSignal(metricsPath); }
+
+  // Every connection takes a file descriptor, allow as many as possible.
+  const size_t fileLimit = GameServer::raiseFileLimit();
+  GameServer server(numThreads);
+  const bool listening = unixPath != nullptr
+      ? server.listenUnix(unixPath) : server.listenTcp(host.c_str(), port);
+  if (!listening || !server.start()) {
+    std::cerr << "Can't serve on "
+              << (unixPath != nullptr ? unixPath
+                                      : host + ":" + std::to_string(port))
+              << ": " << strerror(errno) << std::endl;
+    return 1;
+  }
+  std::cout << "Serving on "
+            << (unixPath != nullptr
+                ? unixPath : host + ":" + std::to_string(server.port()))
+            << " with " << server.numThreads() << " thread(s), for up to "
+            << fileLimit << " open files" << std::endl;
+  int signal = 0;
+  sigwait(&signals, &signal);
+  server.stop();
+  std::cout << server.numGames() << " games played" << std::endl;
+  if (!metricsPath.empty() && !Metrics::write(metricsPath)) {
+    std::cerr << "Can't write the metrics to " << metricsPath << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,135 @@
+// Copyright 2022 Henrik Roth
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "./DecisionTree.h"
+#include "./EquationIndex.h"
+#include "./OpeningBook.h"
+#include "./PackedEquation.h"
+#include "./Simulation.h"
+#include "./Solver.h"
+#include "./Strategy.h"
+#include "./ThreadPool.h"
+
+
+// Play many classic games without a terminal and report how they went,
+// f.e. "NerdleSimMain --games 1000000 --strategy random".
+int main(int argc, char** argv) {
+  size_t numGames = 100'000;
+  int numThreads = 0;
+  uint64_t seed = 42;
+  std::string strategyName = "random";
+  std::string opening;
+  std::string treePath = "tree.bin";
+  const char* bookPath = nullptr;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+      numGames = std::stoull(argv[++i]);
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      numThreads = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = std::stoull(argv[++i]);
+    } else if (strcmp(argv[i], "--strategy") == 0 && i + 1 < argc) {
+      strategyName = argv[++i];
+    } else if (strcmp(argv[i], "--opening") == 0 && i + 1 < argc) {
+      opening = argv[++i];
+    } else if (strcmp(argv[i], "--tree") == 0 && i + 1 < argc) {
+      treePath = argv[++i];
+    } else if (strcmp(argv[i], "--book") == 0 && i + 1 < argc) {
+      bookPath = argv[++i];
+    } else {
+      usage = true;
+    }
+  }
+  if (usage || (strategyName != "random" && strategyName != "solver"
+                && strategyName != "tree")) {
+    std::cerr << "Usage: " << argv[0] << " [--games <n>] [--threads <n>]"
+              << " [--seed <n>] [--strategy random|solver|tree]"
+              << " [--opening <equation>] [--book <file>] [--tree <file>]"
+              << std::endl;
+    return 1;
+  }
+
+  const EquationIndex& index = EquationIndex::classic();
+  ThreadPool pool(numThreads);
+  Simulation simulation(&index, &pool);
+  // Games run in parallel, so the solver scores on one thread per game.
+  ThreadPool serialPool(1);
+  Solver solver(&index, &index, &serialPool);
+  uint32_t packedOpening = 0;
+  if (strategyName == "solver") {
+    if (opening.empty()) {
+      Solver parallelSolver(&index, &index, &pool);
+      packedOpening = parallelSolver.suggest(parallelSolver.candidates({}), 1,
+                                             Solver::kEntropy)[0].packed;
+    } else if (opening.size() != kEquationLength ||
+               opening.find_first_not_of("0123456789+-*/=") !=
+                   std::string::npos ||
+               index.find(PackedEquation::pack(&opening)) < 0) {
+      std::cerr << "Invalid opening: " << opening << std::endl;
+      return 1;
+    } else {
+      packedOpening = PackedEquation::pack(&opening);
+    }
+    std::cout << "Opening: " << PackedEquation::unpack(packedOpening)
+              << std::endl;
+  }
+  OpeningBook book;
+  if (bookPath != nullptr
+      && !book.open(bookPath, &solver, Solver::kEntropy)) {
+    std::cerr << "Invalid opening book: " << bookPath << std::endl;
+    return 1;
+  }
+  DecisionTree tree;
+  if (strategyName == "tree") {
+    if (!tree.open(treePath.c_str()) || tree.numAnswers() != index.size()) {
+      std::cerr << "Invalid tree file: " << treePath
+                << " (see DecisionTreeMain)" << std::endl;
+      return 1;
+    }
+    std::cout << "Tree: " << tree.numNodes() << " nodes, "
+              << tree.expectedGuesses() << " guesses expected, at most "
+              << tree.worstCase() << std::endl;
+  }
+
+  const SimulationResult result = simulation.run(numGames, seed,
+      [&]() -> std::unique_ptr<Strategy> {
+    if (strategyName == "solver") {
+      return std::make_unique<SolverStrategy>(
+          &solver, packedOpening, Solver::kEntropy,
+          bookPath != nullptr ? &book : nullptr);
+    }
+    if (strategyName == "tree") {
+      return std::make_unique<TreeStrategy>(&tree);
+    }
+    return std::make_unique<RandomStrategy>(&index);
+  });
+
+  std::cout << result.games() << " games with strategy " << strategyName
+            << " on " << pool.numThreads() << " thread(s)" << std::endl;
+  double sumRounds = 0;
+  for (int r = 0; r < kNumRounds; ++r) {
+    sumRounds += (r + 1.0) * result.wins[r];
+    std::cout << "  won in round " << r + 1 << ": " << std::setw(10)
+              << result.wins[r] << std::endl;
+  }
+  std::cout << "  lost:           " << std::setw(10) << result.losses
+            << std::endl;
+  if (bookPath != nullptr) {
+    std::cout << "  book lookups:   " << std::setw(10) << book.numLookups()
+              << " (" << book.numHits() << " hits, " << book.size()
+              << " entries)" << std::endl;
+  }
+  if (result.invalidGuesses > 0) {
+    std::cout << "  invalid guesses: " << result.invalidGuesses << std::endl;
+  }
+  const uint64_t won = result.games() - result.losses;
+  std::cout << "Loss rate " << result.lossRate() * 100 << " %, "
+            << (won > 0 ? sumRounds / won : 0) << " rounds per win, "
+            << result.games() / result.seconds << " games/s" << std::endl;
+  return 0;
+}
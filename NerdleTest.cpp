@@ -1,9 +1,18 @@
 // Copyright 2022 Henrik Roth
 
 #include <gtest/gtest.h>
+#include <climits>
 #include <string>
+#include <utility>
 #include <vector>
 #include "./Nerdle.h"
+#include "./EquationIndex.h"
+#include "./EquationRules.h"
+#include "./PackedEquation.h"
+#include "./Constraints.h"
+#include "./Feedback.h"
+#include "./HeadlessScreen.h"
+#include "./Random.h"
 
 
 TEST(NerdleTest, isEquationSyntactic) {
@@ -66,6 +75,9 @@ TEST(NerdleTest, splitEquation) {
   ASSERT_EQ(testNerdle.splitEquation(&test4).second, 11111);
   ASSERT_EQ(testNerdle.splitEquation(&test5).first, std::string("1"));
   ASSERT_EQ(testNerdle.splitEquation(&test5).second, 101010);
+  // a right side beyond int is like no number
+  std::string test6 = "50000*50000=2500000000";
+  ASSERT_EQ(testNerdle.splitEquation(&test6).second, -1);
 }
 
 TEST(NerdleTest, parseEquation) {
@@ -81,6 +93,20 @@ TEST(NerdleTest, parseEquation) {
   ASSERT_EQ(testNerdle.parseEquation(&test0)[6], 1337);
   ASSERT_EQ(testNerdle.parseEquation(&test0)[7], DIVIDED);
   ASSERT_EQ(testNerdle.parseEquation(&test0)[8], 7);
+  // numbers beyond int stop at INT_MAX, in 64 bits at INT64_MAX
+  std::string test1 = "50000*50000";
+  std::vector<int> test2 = testNerdle.parseEquation(&test1);
+  ASSERT_EQ(test2[0], 50000);
+  ASSERT_EQ(testNerdle.computeEquation(&test2), -1);
+  std::string test3 = "2500000000+99999999999999999999999";
+  ASSERT_EQ(testNerdle.parseEquation(&test3)[0], INT_MAX);
+  std::vector<int64_t> test4;
+  testNerdle.parseEquation(&test3, &test4);
+  ASSERT_EQ(test4[0], 2500000000);
+  ASSERT_EQ(test4[2], INT64_MAX);
+  testNerdle.parseEquation(&test1, &test4);
+  ASSERT_EQ(test4.size(), 3u);
+  ASSERT_EQ(testNerdle.computeEquation(&test4), -1);
 }
 
 TEST(NerdleTest, computeEquation) {
@@ -149,14 +175,15 @@ TEST(NerdleTest, isEquationCorrect) {
 TEST(NerdleTest, generateEquation) {
   for (int i = 0; i < 1000; ++i) {
     Nerdle testNerdle;
-    ASSERT_EQ(testNerdle.isEquationSyntactic(&testNerdle.equation_), true);
-    ASSERT_EQ(testNerdle.isEquationCorrect(&testNerdle.equation_), true);
+    const std::string equation = testNerdle.session_.equation();
+    ASSERT_EQ(testNerdle.isEquationSyntactic(&equation), true);
+    ASSERT_EQ(testNerdle.isEquationCorrect(&equation), true);
   }
 }
 
 TEST(NerdleTest, compareUserGuess) {
   Nerdle testNerdle;
-  std::string test0 = testNerdle.equation_;
+  std::string test0 = testNerdle.session_.equation();
   ASSERT_EQ(testNerdle.compareUserGuess(&test0), "22222222");
   for (int i = 0; i < 8; ++i) {
     std::string test1 = test0;
@@ -186,3 +213,163 @@ TEST(NerdleTest, compareUserGuess) {
   }
 }
 
+
+TEST(NerdleTest, equationIndex) {
+  Nerdle testNerdle;
+  const EquationIndex& index = EquationIndex::classic();
+  ASSERT_EQ(index.size(), 18290);
+  for (size_t i = 0; i < index.size(); ++i) {
+    std::string eq = index.equation(i);
+    ASSERT_EQ(testNerdle.isEquationSyntactic(&eq), true);
+    ASSERT_EQ(testNerdle.isEquationCorrect(&eq), true);
+  }
+  const std::string equation = testNerdle.session_.equation();
+  ASSERT_NE(index.find(PackedEquation::pack(&equation)), -1);
+}
+
+TEST(NerdleTest, seed) {
+  // same seed, same equations
+  Random random0(42);
+  Random random1(42);
+  for (int i = 0; i < 100; ++i) {
+    Nerdle testNerdle0(&random0);
+    Nerdle testNerdle1(&random1);
+    ASSERT_EQ(testNerdle0.session_.equation(), testNerdle1.session_.equation());
+  }
+  // games created at the same time without a seed differ
+  int numEqual = 0;
+  for (int i = 0; i < 100; ++i) {
+    Nerdle testNerdle0;
+    Nerdle testNerdle1;
+    numEqual += testNerdle0.session_.equation()
+                == testNerdle1.session_.equation();
+  }
+  ASSERT_LT(numEqual, 5);
+}
+
+TEST(NerdleTest, packedFeedback) {
+  // Feedback on packed equations must be exactly the one of
+  // compareUserGuess, including duplicate symbols.
+  const EquationIndex& index = EquationIndex::classic();
+  Random random(42);
+  for (int i = 0; i < 2000; ++i) {
+    Nerdle testNerdle(&random);
+    const std::string equation = testNerdle.session_.equation();
+    const uint32_t answer = PackedEquation::pack(&equation);
+    std::string guess = index.equation(random.uniform(index.size()));
+    if (i % 2 == 0) {
+      // make duplicates of the answer's symbols more likely
+      guess = testNerdle.session_.equation();
+      std::swap(guess[random.uniform(8)], guess[random.uniform(8)]);
+      guess[random.uniform(8)] = guess[random.uniform(8)];
+    }
+    ASSERT_EQ(Feedback::highlight(
+                  Feedback::pattern(PackedEquation::pack(&guess), answer)),
+              testNerdle.compareUserGuess(&guess));
+  }
+}
+
+TEST(NerdleTest, evaluator) {
+  Nerdle testNerdle;
+  // no number right of the equal sign
+  std::string test0 = "1234567=";
+  ASSERT_EQ(testNerdle.splitEquation(&test0).second, -1);
+  ASSERT_EQ(testNerdle.isEquationCorrect(&test0), false);
+  // overflowing int64 is illegal
+  std::vector<int> test2 = {2'000'000'000, TIMES, 2'000'000'000, TIMES,
+                            2'000'000'000, TIMES, 2'000'000'000};
+  ASSERT_EQ(testNerdle.computeEquation(&test2), -1);
+  // a value that fits in int64 but not in int is illegal, terms that
+  // don't fit are fine
+  std::vector<int> test3 = {50000, TIMES, 50000};
+  ASSERT_EQ(testNerdle.computeEquation(&test3), -1);
+  std::vector<int> test4 = {50000, TIMES, 50000, MINUS, 50000, TIMES, 50000};
+  ASSERT_EQ(testNerdle.computeEquation(&test4), 0);
+  std::string test1 = "99999999999*99999999999";
+  ASSERT_EQ(EquationRules::compute(test1), -1);
+  ASSERT_EQ(EquationRules::compute("99999*99999"), 9999800001);
+  ASSERT_EQ(EquationRules::parseNumber("99999999999999999999"), -1);
+  // the wrappers agree with the single pass evaluator on every equation
+  const EquationIndex& index = EquationIndex::classic();
+  for (size_t i = 0; i < index.size(); i += 7) {
+    std::string eq = index.equation(i);
+    ASSERT_TRUE(testNerdle.isEquationSyntactic(&eq));
+    ASSERT_TRUE(testNerdle.isEquationCorrect(&eq));
+    std::pair<std::string, int> split = testNerdle.splitEquation(&eq);
+    std::vector<int> parsed = testNerdle.parseEquation(&split.first);
+    ASSERT_EQ(testNerdle.computeEquation(&parsed), split.second);
+    // the single pass check agrees with the two step one on mutations
+    for (char c : std::string("0123456789+-*/=")) {
+      eq[i % 8] = c;
+      ASSERT_EQ(EquationRules::isLegal(eq),
+                EquationRules::isSyntactic(eq) && EquationRules::isCorrect(eq))
+          << eq;
+    }
+  }
+}
+
+TEST(NerdleTest, play) {
+  // a board of 36 x 39 pixels in the middle of the screen
+  HeadlessScreen screen(40, 50);
+  Random random(42);
+  Nerdle testNerdle(&random);
+  const std::string answer = testNerdle.session_.equation();
+  const std::string guess = answer == "48-32=16" ? "11+11=22" : "48-32=16";
+  std::string highlight(8, '?');
+  GameSession session(VariantRules::forName("classic"), answer);
+  session.submit(guess.data(), guess.size());
+  session.highlightOf(0, &highlight[0]);
+  // a guess that doesn't compute, a corrected one, then the answer and quit
+  screen.type("48-32=17\n");
+  screen.press(263);  // Backspace
+  screen.type(guess.substr(7) + "\n" + answer + "\nq");
+  ASSERT_FALSE(testNerdle.play(&screen));
+  ASSERT_EQ(screen.numKeysLeft(), 0u);
+  ASSERT_EQ(testNerdle.session_.status(), GameSession::kWon);
+  ASSERT_EQ(testNerdle.session_.round(), 2);
+  // the rows of the guesses start at screen row 2 + 5, pixel column 5 + 5
+  std::string shown, colors;
+  for (int i = 0; i < 8; ++i) {
+    shown += screen.text(7)[20 + 8 * i];
+    colors += screen.colors(7)[20 + 8 * i];
+  }
+  ASSERT_EQ(shown, guess);
+  ASSERT_EQ(colors, highlight);
+  ASSERT_EQ(screen.text(12).substr(20, 1), answer.substr(0, 1));
+  ASSERT_NE(screen.text(36).find("Congratz! You won!"), std::string::npos);
+  ASSERT_NE(screen.text(37).find("Press q to quit"), std::string::npos);
+  // Once the script is used up, the player quits.
+  Nerdle quitNerdle(&random);
+  ASSERT_FALSE(quitNerdle.play(&screen));
+  ASSERT_FALSE(screen.isClosed());
+  // A screen too small for the board is closed.
+  HeadlessScreen smallScreen(20, 20);
+  ASSERT_FALSE(quitNerdle.play(&smallScreen));
+  ASSERT_TRUE(smallScreen.isClosed());
+}
+
+TEST(NerdleTest, hardMode) {
+  HeadlessScreen screen(40, 50);
+  Random random(42);
+  Nerdle testNerdle(&random, 8, true);
+  const std::string answer = testNerdle.session_.equation();
+  const std::string guess = answer == "48-32=16" ? "11+11=22" : "48-32=16";
+  // the same guess again uses the black symbols once more
+  GameSession session(VariantRules::forName("classic"), answer);
+  Constraints constraints(8);
+  session.submit(guess.data(), guess.size());
+  constraints.add(guess.data(), session.pattern(0));
+  const std::string message = Constraints::message(
+      constraints.check(guess.data()));
+  ASSERT_NE(message, "");
+  screen.type(guess + "\n" + guess + "\n");
+  ASSERT_FALSE(testNerdle.play(&screen));
+  ASSERT_EQ(testNerdle.session_.round(), 1);
+  // in the message row, before the question whether to quit
+  size_t numMessages = 0;
+  for (const HeadlessScreen::DrawCall& call : screen.calls()) {
+    numMessages += call.kind == HeadlessScreen::DrawCall::kString
+                   && call.row == 36 && call.text == message;
+  }
+  ASSERT_EQ(numMessages, 1u);
+}
@@ -0,0 +1,187 @@
+// Copyright 2022 Henrik Roth
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "./OpeningBook.h"
+#include "./Random.h"
+
+namespace {
+constexpr char kMagic[8] = {'N', 'R', 'D', 'L', 'B', 'O', 'O', 'K'};
+constexpr uint32_t kVersion = 1;
+
+// Header at the start of every book file.
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t criterion;
+  uint64_t capacity;
+  // checksums of the packed guesses and answers of the solver
+  uint64_t guessesChecksum;
+  uint64_t answersChecksum;
+  // number of claimed slots, counted up atomically
+  uint64_t numEntries;
+};
+
+// ____________________________________________________________________________
+uint64_t checksum(const EquationIndex& index) {
+  // FNV-1a over the packed equations
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < index.size(); ++i) {
+    hash = (hash ^ index.packed(i)) * 1099511628211ull;
+  }
+  return hash;
+}
+}  // namespace
+
+// ____________________________________________________________________________
+OpeningBook::OpeningBook()
+    : solver_(nullptr), criterion_(Solver::kEntropy), data_(nullptr),
+      size_(0), capacity_(0), slots_(nullptr), numLookups_(0),
+      numHits_(0) {}
+
+// ____________________________________________________________________________
+OpeningBook::~OpeningBook() { close(); }
+
+// ____________________________________________________________________________
+void OpeningBook::close() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+    data_ = nullptr;
+  }
+}
+
+// ____________________________________________________________________________
+bool OpeningBook::open(const char* path, const Solver* solver,
+                       Solver::Criterion criterion, size_t capacity) {
+  close();
+  solver_ = solver;
+  criterion_ = criterion;
+  Header expected;
+  memset(&expected, 0, sizeof(expected));
+  memcpy(expected.magic, kMagic, sizeof(kMagic));
+  expected.version = kVersion;
+  expected.criterion = criterion;
+  expected.capacity = 1;
+  while (expected.capacity < capacity) { expected.capacity *= 2; }
+  expected.guessesChecksum = checksum(*solver->guesses());
+  expected.answersChecksum = checksum(*solver->answers());
+
+  const int fd = ::open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) { return false; }
+  // Only one process at a time creates the file or checks it.
+  flock(fd, LOCK_EX);
+  struct stat status;
+  bool valid = fstat(fd, &status) == 0;
+  if (valid && status.st_size == 0) {
+    const ssize_t headerSize = sizeof(expected);
+    valid = ftruncate(fd, sizeof(Header) + 16 * expected.capacity) == 0
+        && pwrite(fd, &expected, headerSize, 0) == headerSize;
+    status.st_size = sizeof(Header) + 16 * expected.capacity;
+  }
+  if (valid && static_cast<size_t>(status.st_size) >= sizeof(Header)) {
+    size_ = status.st_size;
+    void* mapped = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        fd, 0);
+    if (mapped != MAP_FAILED) { data_ = static_cast<uint8_t*>(mapped); }
+  }
+  flock(fd, LOCK_UN);
+  ::close(fd);
+  if (data_ == nullptr) { return false; }
+
+  // The capacity is the one of the file, whatever was asked for.
+  const Header* header = reinterpret_cast<const Header*>(data_);
+  expected.capacity = header->capacity;
+  if (memcmp(header, &expected, offsetof(Header, numEntries)) != 0
+      || expected.capacity == 0
+      || (expected.capacity & (expected.capacity - 1)) != 0
+      || size_ != sizeof(Header) + 16 * expected.capacity) {
+    close();
+    return false;
+  }
+  capacity_ = expected.capacity;
+  slots_ = reinterpret_cast<uint64_t*>(data_ + sizeof(Header));
+  return true;
+}
+
+// ____________________________________________________________________________
+size_t OpeningBook::size() const {
+  const Header* header = reinterpret_cast<const Header*>(data_);
+  return __atomic_load_n(&header->numEntries, __ATOMIC_RELAXED);
+}
+
+// ____________________________________________________________________________
+uint64_t OpeningBook::key(const std::vector<Move>& history) {
+  uint64_t hash = history.size();
+  for (const Move& move : history) {
+    hash = Random::mix(hash ^ (static_cast<uint64_t>(move.guess) << 16
+                               | move.pattern));
+  }
+  return hash == 0 ? 1 : hash;
+}
+
+// ____________________________________________________________________________
+bool OpeningBook::find(const std::vector<Move>& history, uint32_t* guess,
+                       uint32_t* numCandidates) const {
+  if (history.size() > kMaxMoves) { return false; }
+  const uint64_t k = key(history);
+  for (size_t i = 0; i < capacity_; ++i) {
+    const uint64_t* slot = slots_ + 2 * ((k + i) & (capacity_ - 1));
+    const uint64_t slotKey = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+    if (slotKey == 0) { return false; }
+    if (slotKey == k) {
+      const uint64_t value = __atomic_load_n(slot + 1, __ATOMIC_ACQUIRE);
+      if (value == 0) { return false; }
+      *guess = value >> 32;
+      *numCandidates = value & 0xFFFFFFFF;
+      return true;
+    }
+  }
+  return false;
+}
+
+// ____________________________________________________________________________
+bool OpeningBook::insert(const std::vector<Move>& history, uint32_t guess,
+                         uint32_t numCandidates) {
+  if (history.size() > kMaxMoves || 4 * size() >= 3 * capacity_) {
+    return false;
+  }
+  const uint64_t k = key(history);
+  for (size_t i = 0; i < capacity_; ++i) {
+    uint64_t* slot = slots_ + 2 * ((k + i) & (capacity_ - 1));
+    uint64_t slotKey = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+    if (slotKey == 0
+        && __atomic_compare_exchange_n(slot, &slotKey, k, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      __atomic_store_n(slot + 1,
+                       static_cast<uint64_t>(guess) << 32 | numCandidates,
+                       __ATOMIC_RELEASE);
+      Header* header = reinterpret_cast<Header*>(data_);
+      __atomic_fetch_add(&header->numEntries, 1, __ATOMIC_RELAXED);
+      return true;
+    }
+    // Another thread may have claimed the slot for the same history.
+    if (slotKey == k) { return false; }
+  }
+  return false;
+}
+
+// ____________________________________________________________________________
+uint32_t OpeningBook::bestGuess(const std::vector<Move>& history,
+                                const std::vector<uint32_t>& candidates) {
+  ++numLookups_;
+  uint32_t guess;
+  uint32_t numCandidates;
+  if (find(history, &guess, &numCandidates)) {
+    ++numHits_;
+    return guess;
+  }
+  guess = solver_->suggest(candidates, 1, criterion_)[0].packed;
+  insert(history, guess, candidates.size());
+  return guess;
+}
@@ -0,0 +1,93 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef OPENINGBOOK_H_
+#define OPENINGBOOK_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "./Solver.h"
+
+// The best guesses after the first few moves of a game, which are the most
+// expensive ones to score because the most candidates are left, but are the
+// same in millions of games. The book is a hash table in a file that is
+// mapped into memory, so it outlives the program and is shared by all
+// threads and processes that open it. Guesses that aren't in the book yet
+// are scored by the solver and added, so the book grows while it is used.
+//
+// Entries are added without locks: a thread claims an empty slot by
+// writing the key of the history with a compare-and-swap and then writes
+// the value. Readers that see a claimed slot without a value yet score the
+// guess themselves. Keys are 64-bit hashes of the histories, so two
+// histories would only share an entry by a collision of the hash (with a
+// million entries, about once in 10^7 books). The table has a fixed
+// capacity and stops growing when it is 3/4 full.
+//
+// File layout (version 1), all numbers little endian:
+//   header (see OpeningBook.cpp), then capacity slots of two uint64 each:
+//   the key (0 = empty) and the value (best guess in the high 32 bits,
+//   number of candidates in the low 32 bits, 0 = not written yet).
+class OpeningBook {
+ public:
+  // Histories of at most this many moves are kept in the book, so it has
+  // the first kMaxMoves + 1 guesses of every game.
+  static constexpr size_t kMaxMoves = 3;
+
+  OpeningBook();
+  ~OpeningBook();
+
+  OpeningBook(const OpeningBook&) = delete;
+  OpeningBook& operator=(const OpeningBook&) = delete;
+
+  // Open the book at path for the given solver and criterion, or create it
+  // with room for the given number of entries (rounded up to a power of
+  // two) if there is no file yet. The solver must outlive the book. Return
+  // false if the file can't be used, f.e. because it was made for other
+  // guesses, answers or criterion.
+  bool open(const char* path, const Solver* solver,
+            Solver::Criterion criterion, size_t capacity = 1 << 20);
+
+  // Return true and set guess and numCandidates if the history is in the
+  // book.
+  bool find(const std::vector<Move>& history, uint32_t* guess,
+            uint32_t* numCandidates) const;
+
+  // Add the best guess and number of candidates after the history. Return
+  // false if the history is in the book already, the history is longer
+  // than kMaxMoves or the book is full.
+  bool insert(const std::vector<Move>& history, uint32_t guess,
+              uint32_t numCandidates);
+
+  // Return the best guess after the history, which left the given
+  // candidates (positions of answers of the solver). It is looked up, or
+  // scored by the solver and added to the book.
+  uint32_t bestGuess(const std::vector<Move>& history,
+                     const std::vector<uint32_t>& candidates);
+
+  size_t capacity() const { return capacity_; }
+  size_t size() const;
+
+  // Lookups since the book was opened and how many of them found an entry.
+  size_t numLookups() const { return numLookups_; }
+  size_t numHits() const { return numHits_; }
+
+ private:
+  // Unmap the file if one is mapped.
+  void close();
+
+  // Return the key of the history, never 0.
+  static uint64_t key(const std::vector<Move>& history);
+
+  const Solver* solver_;
+  Solver::Criterion criterion_;
+  // The mapped file and its slots.
+  uint8_t* data_;
+  size_t size_;
+  size_t capacity_;
+  uint64_t* slots_;
+  std::atomic<size_t> numLookups_;
+  std::atomic<size_t> numHits_;
+};
+
+#endif  // OPENINGBOOK_H_
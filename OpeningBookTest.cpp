@@ -0,0 +1,106 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./Feedback.h"
+#include "./OpeningBook.h"
+#include "./Solver.h"
+#include "./ThreadPool.h"
+
+
+TEST(OpeningBookTest, bestGuess) {
+  const EquationIndex answers = EquationIndex::classic().sample(50);
+  ThreadPool pool(1);
+  Solver solver(&answers, &answers, &pool);
+  const char* path = "/tmp/OpeningBookTest.book";
+  remove(path);
+  const uint32_t answer = answers.packed(7);
+  std::vector<Move> history;
+  std::vector<uint32_t> candidates = solver.candidates({});
+  std::vector<uint32_t> guesses;
+  {
+    OpeningBook book;
+    ASSERT_TRUE(book.open(path, &solver, Solver::kEntropy, 1000));
+    ASSERT_EQ(book.capacity(), 1024u);
+    for (size_t i = 0; i <= OpeningBook::kMaxMoves; ++i) {
+      const uint32_t guess = book.bestGuess(history, candidates);
+      ASSERT_EQ(guess, solver.suggest(candidates, 1,
+                                      Solver::kEntropy)[0].packed);
+      ASSERT_EQ(book.bestGuess(history, candidates), guess);
+      uint32_t found;
+      uint32_t numCandidates;
+      ASSERT_TRUE(book.find(history, &found, &numCandidates));
+      ASSERT_EQ(found, guess);
+      ASSERT_EQ(numCandidates, candidates.size());
+      guesses.push_back(guess);
+      history.push_back({guess, Feedback::pattern(guess, answer)});
+      candidates = solver.filter(candidates, history.back());
+    }
+    // Longer histories aren't kept.
+    ASSERT_FALSE(book.insert(history, guesses[0], 1));
+    ASSERT_EQ(book.size(), OpeningBook::kMaxMoves + 1);
+    ASSERT_EQ(book.numLookups(), 2 * book.size());
+    ASSERT_EQ(book.numHits(), book.size());
+  }
+
+  // The book is still there when opened again, whatever the capacity.
+  OpeningBook book;
+  ASSERT_TRUE(book.open(path, &solver, Solver::kEntropy, 16));
+  ASSERT_EQ(book.capacity(), 1024u);
+  ASSERT_EQ(book.size(), OpeningBook::kMaxMoves + 1);
+  history.resize(2);
+  uint32_t found;
+  uint32_t numCandidates;
+  ASSERT_TRUE(book.find(history, &found, &numCandidates));
+  ASSERT_EQ(found, guesses[2]);
+  history[1].pattern ^= 1;
+  ASSERT_FALSE(book.find(history, &found, &numCandidates));
+  // but not for another criterion or other answers
+  ASSERT_FALSE(book.open(path, &solver, Solver::kExpectedSize));
+  Solver classicSolver(&EquationIndex::classic(), &EquationIndex::classic(),
+                       &pool);
+  ASSERT_FALSE(book.open(path, &classicSolver, Solver::kEntropy));
+  remove(path);
+}
+
+TEST(OpeningBookTest, concurrentInserts) {
+  const EquationIndex answers = EquationIndex::classic().sample(50);
+  ThreadPool pool(1);
+  Solver solver(&answers, &answers, &pool);
+  const char* path = "/tmp/OpeningBookTest.concurrent.book";
+  remove(path);
+  // Threads with books of their own add the same histories at once; every
+  // history ends up in the book exactly once.
+  constexpr uint32_t kNumHistories = 3072;
+  std::vector<std::thread> threads;
+  std::vector<size_t> numInserted(4, 0);
+  OpeningBook first;
+  ASSERT_TRUE(first.open(path, &solver, Solver::kEntropy, 4096));
+  for (size_t t = 0; t < numInserted.size(); ++t) {
+    threads.emplace_back([&, t]() {
+      OpeningBook book;
+      ASSERT_TRUE(book.open(path, &solver, Solver::kEntropy));
+      for (uint32_t i = 0; i < kNumHistories; ++i) {
+        numInserted[t] += book.insert({{i + 1, 0}}, i + 1, t + 1);
+      }
+    });
+  }
+  for (std::thread& thread : threads) { thread.join(); }
+  size_t total = 0;
+  for (size_t n : numInserted) { total += n; }
+  ASSERT_EQ(total, kNumHistories);
+  ASSERT_EQ(first.size(), kNumHistories);
+  for (uint32_t i = 0; i < kNumHistories; ++i) {
+    uint32_t guess;
+    uint32_t numCandidates;
+    ASSERT_TRUE(first.find({{i + 1, 0}}, &guess, &numCandidates));
+    ASSERT_EQ(guess, i + 1);
+  }
+  // The book is full at 3/4 of its capacity.
+  ASSERT_FALSE(first.insert({{kNumHistories + 1, 0}}, 1, 1));
+  ASSERT_EQ(first.size(), kNumHistories);
+  remove(path);
+}
@@ -0,0 +1,46 @@
+// Copyright 2022 Henrik Roth
+
+#include <cstdint>
+#include <string>
+#include "./PackedEquation.h"
+
+namespace {
+// Symbols in the order of their 4-bit codes.
+const char kSymbols[] = "0123456789+-*/=";
+}
+
+// ____________________________________________________________________________
+int PackedEquation::symbolCode(char symbol) {
+  if ('0' <= symbol && symbol <= '9') { return symbol - '0'; }
+  switch (symbol) {
+    case '+': return 10;
+    case '-': return 11;
+    case '*': return 12;
+    case '/': return 13;
+    case '=': return 14;
+    default: return -1;
+  }
+}
+
+// ____________________________________________________________________________
+char PackedEquation::symbolChar(int code) {
+  return kSymbols[code];
+}
+
+// ____________________________________________________________________________
+uint32_t PackedEquation::pack(const std::string* eq) {
+  uint32_t packed = 0;
+  for (int i = 0; i < kEquationLength; ++i) {
+    packed = (packed << 4) | symbolCode((*eq)[i]);
+  }
+  return packed;
+}
+
+// ____________________________________________________________________________
+std::string PackedEquation::unpack(uint32_t packed) {
+  std::string eq(kEquationLength, ' ');
+  for (int i = 0; i < kEquationLength; ++i) {
+    eq[i] = symbolChar(cell(packed, i));
+  }
+  return eq;
+}
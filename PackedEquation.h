@@ -0,0 +1,44 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef PACKEDEQUATION_H_
+#define PACKEDEQUATION_H_
+
+#include <cstdint>
+#include <string>
+
+// Number of cells of an equation in the classic game.
+constexpr int kEquationLength = 8;
+
+// Number of different symbols an equation can be made of:
+// 0-9, +, -, *, / and =.
+constexpr int kNumSymbols = 15;
+
+// Compact representation of a classic equation: every symbol is stored as
+// a 4-bit code (0-9 -> 0-9, + -> 10, - -> 11, * -> 12, / -> 13, = -> 14) and
+// the eight cells are stored in one 32-bit word with the first cell in the
+// highest nibble. That way, comparing two packed equations as integers
+// compares them symbol by symbol from left to right.
+class PackedEquation {
+ public:
+  // Return the 4-bit code of the given symbol or -1 if the symbol can't
+  // appear in an equation, f.e. '7' -> 7, '*' -> 12, '?' -> -1.
+  static int symbolCode(char symbol);
+
+  // Return the symbol belonging to the given 4-bit code, f.e. 13 -> '/'.
+  static char symbolChar(int code);
+
+  // Pack the given 8-symbol equation, f.e. "42-10=32" -> 0x42B10E32.
+  // The equation must only contain legal symbols (see symbolCode).
+  static uint32_t pack(const std::string* eq);
+
+  // Unpack the given packed equation into its string representation.
+  static std::string unpack(uint32_t packed);
+
+  // Return the 4-bit code in the given cell (0 = leftmost) of a packed
+  // equation.
+  static int cell(uint32_t packed, int i) {
+    return (packed >> (4 * (kEquationLength - 1 - i))) & 0xF;
+  }
+};
+
+#endif  // PACKEDEQUATION_H_
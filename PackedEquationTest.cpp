@@ -0,0 +1,31 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <string>
+#include "./PackedEquation.h"
+
+
+TEST(PackedEquationTest, symbolCode) {
+  ASSERT_EQ(PackedEquation::symbolCode('0'), 0);
+  ASSERT_EQ(PackedEquation::symbolCode('9'), 9);
+  ASSERT_EQ(PackedEquation::symbolCode('+'), 10);
+  ASSERT_EQ(PackedEquation::symbolCode('='), 14);
+  ASSERT_EQ(PackedEquation::symbolCode('?'), -1);
+  ASSERT_EQ(PackedEquation::symbolCode('A'), -1);
+  for (int code = 0; code < kNumSymbols; ++code) {
+    ASSERT_EQ(PackedEquation::symbolCode(PackedEquation::symbolChar(code)),
+              code);
+  }
+}
+
+TEST(PackedEquationTest, pack) {
+  std::string test0 = "42-10=32";
+  std::string test1 = "9*8/6=12";
+  ASSERT_EQ(PackedEquation::pack(&test0), 0x42B10E32u);
+  ASSERT_EQ(PackedEquation::pack(&test1), 0x9C8D6E12u);
+  ASSERT_EQ(PackedEquation::unpack(0x42B10E32u), test0);
+  ASSERT_EQ(PackedEquation::unpack(PackedEquation::pack(&test1)), test1);
+  ASSERT_EQ(PackedEquation::cell(0x42B10E32u, 0), 4);
+  ASSERT_EQ(PackedEquation::cell(0x42B10E32u, 2), 11);
+  ASSERT_EQ(PackedEquation::cell(0x42B10E32u, 7), 2);
+}
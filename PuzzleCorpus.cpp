@@ -0,0 +1,218 @@
+// Copyright 2022 Henrik Roth
+
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "./EquationRules.h"
+#include "./PackedEquation.h"
+#include "./PuzzleCorpus.h"
+
+namespace {
+constexpr char kMagic[8] = {'N', 'R', 'D', 'L', 'P', 'U', 'Z', 'L'};
+constexpr uint32_t kVersion = 1;
+
+// Blocks in a row without a new puzzle after which generate() gives up.
+constexpr int kMaxFruitlessBlocks = 64;
+
+constexpr char kCsvHeader[] =
+    "equation,plus,minus,times,divided,result,digits,distinct,max_repeat\n";
+
+// Write size bytes at data to the file descriptor fd. Return false on error.
+bool writeAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) { continue; }
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+// ____________________________________________________________________________
+uint64_t pack(const std::string& equation) {
+  uint64_t packed = 0;
+  for (char c : equation) {
+    packed = packed << 4 | PackedEquation::symbolCode(c);
+  }
+  return packed;
+}
+
+// ____________________________________________________________________________
+std::string unpack(uint64_t packed, int length) {
+  std::string equation(length, ' ');
+  for (int i = length - 1; i >= 0; --i) {
+    equation[i] = PackedEquation::symbolChar(packed & 0xF);
+    packed >>= 4;
+  }
+  return equation;
+}
+}  // namespace
+
+// ____________________________________________________________________________
+PuzzleCorpus::PuzzleCorpus(const VariantRules* rules, ThreadPool* pool,
+                           uint64_t seed)
+    : rules_(rules), pool_(pool), drawn_(1024, 0), numDrawn_(0) {
+  const Random random(seed);
+  for (int k = 0; k < pool->numThreads(); ++k) {
+    streams_.push_back(random.stream(k));
+  }
+}
+
+// ____________________________________________________________________________
+PuzzleCorpus::Puzzle PuzzleCorpus::describe(const std::string& equation) {
+  Puzzle puzzle = {};
+  puzzle.packed = pack(equation);
+  const size_t eqPos = equation.find('=');
+  puzzle.result = EquationRules::parseNumber(equation.data() + eqPos + 1,
+                                             equation.size() - eqPos - 1);
+  puzzle.numDigits = equation.size() - eqPos - 1;
+  uint8_t counts[kNumSymbols] = {};
+  for (char c : equation) {
+    const char* op = strchr("+-*/", c);
+    if (op != nullptr) { ++puzzle.numOperators[op - "+-*/"]; }
+    const int code = PackedEquation::symbolCode(c);
+    puzzle.numDistinct += counts[code] == 0;
+    ++counts[code];
+    puzzle.maxRepeat = std::max(puzzle.maxRepeat, counts[code]);
+  }
+  return puzzle;
+}
+
+// ____________________________________________________________________________
+size_t PuzzleCorpus::formatCsv(const Puzzle& puzzle, int length,
+                               char* out) {
+  const std::string equation = unpack(puzzle.packed, length);
+  return snprintf(out, maxOutput(length), "%s,%d,%d,%d,%d,%u,%d,%d,%d\n",
+                  equation.c_str(), puzzle.numOperators[0],
+                  puzzle.numOperators[1], puzzle.numOperators[2],
+                  puzzle.numOperators[3], puzzle.result, puzzle.numDigits,
+                  puzzle.numDistinct, puzzle.maxRepeat);
+}
+
+// ____________________________________________________________________________
+size_t PuzzleCorpus::formatBinary(const Puzzle& puzzle, char* out) {
+  Record record;
+  record.packed = puzzle.packed;
+  record.result = puzzle.result;
+  record.operators = 0;
+  for (int i = 3; i >= 0; --i) {
+    record.operators = record.operators << 4 | puzzle.numOperators[i];
+  }
+  record.numDistinct = puzzle.numDistinct;
+  record.maxRepeat = puzzle.maxRepeat;
+  memcpy(out, &record, sizeof(record));
+  return sizeof(record);
+}
+
+// ____________________________________________________________________________
+bool PuzzleCorpus::insert(uint64_t packed) {
+  // Keep the table at most half full.
+  if (2 * (numDrawn_ + 1) > drawn_.size()) {
+    std::vector<uint64_t> old(2 * drawn_.size(), 0);
+    old.swap(drawn_);
+    numDrawn_ = 0;
+    for (uint64_t p : old) {
+      if (p != 0) { insert(p); }
+    }
+  }
+  const size_t mask = drawn_.size() - 1;
+  for (size_t i = Random::mix(packed) & mask; ; i = (i + 1) & mask) {
+    if (drawn_[i] == packed) { return false; }
+    if (drawn_[i] == 0) {
+      drawn_[i] = packed;
+      ++numDrawn_;
+      return true;
+    }
+  }
+}
+
+// ____________________________________________________________________________
+bool PuzzleCorpus::generate(size_t numPuzzles, Format format, int outFd) {
+  const int length = rules_->length;
+  if (format == kCsv) {
+    if (!writeAll(outFd, kCsvHeader, sizeof(kCsvHeader) - 1)) {
+      return false;
+    }
+  } else {
+    char header[16];
+    memcpy(header, kMagic, sizeof(kMagic));
+    memcpy(header + 8, &kVersion, 4);
+    const uint32_t length32 = length;
+    memcpy(header + 12, &length32, 4);
+    if (!writeAll(outFd, header, sizeof(header))) { return false; }
+  }
+
+  const size_t numPieces = streams_.size();
+  const size_t pieceSize = (kBlockSize + numPieces - 1) / numPieces;
+  std::vector<std::vector<uint64_t>> drawn(numPieces);
+  std::vector<uint64_t> fresh;
+  std::vector<std::vector<char>> output(numPieces);
+  std::vector<Summary> summaries(numPieces);
+  int numFruitlessBlocks = 0;
+  while (summary_.numPuzzles < numPuzzles) {
+    if (numFruitlessBlocks == kMaxFruitlessBlocks) { return false; }
+    // Draw a block, piece k from stream k.
+    pool_->parallelFor(numPieces, 1, [&](size_t begin, size_t end) {
+      for (size_t k = begin; k < end; ++k) {
+        drawn[k].resize(pieceSize);
+        for (uint64_t& packed : drawn[k]) {
+          packed = pack(rules_->generate(&streams_[k]));
+        }
+      }
+    });
+    // Keep the new puzzles, in the order of the pieces.
+    fresh.clear();
+    for (size_t k = 0; k < numPieces; ++k) {
+      for (uint64_t packed : drawn[k]) {
+        if (summary_.numPuzzles + fresh.size() == numPuzzles) { break; }
+        ++summary_.numDrawn;
+        if (insert(packed)) { fresh.push_back(packed); }
+      }
+    }
+    numFruitlessBlocks = fresh.empty() ? numFruitlessBlocks + 1 : 0;
+    // Describe and format them, in pieces as well.
+    const size_t chunk = (fresh.size() + numPieces - 1) / numPieces;
+    pool_->parallelFor(numPieces, 1, [&](size_t begin, size_t end) {
+      for (size_t k = begin; k < end; ++k) {
+        const size_t first = std::min(k * chunk, fresh.size());
+        const size_t last = std::min(first + chunk, fresh.size());
+        output[k].resize((last - first) * maxOutput(length));
+        summaries[k] = Summary();
+        size_t size = 0;
+        for (size_t i = first; i < last; ++i) {
+          const Puzzle puzzle = describe(unpack(fresh[i], length));
+          size += format == kCsv
+              ? formatCsv(puzzle, length, &output[k][size])
+              : formatBinary(puzzle, &output[k][size]);
+          for (int op = 0; op < 4; ++op) {
+            summaries[k].numOperators[op] += puzzle.numOperators[op];
+          }
+          ++summaries[k].numWithDigits[puzzle.numDigits];
+          ++summaries[k].numWithMaxRepeat[puzzle.maxRepeat];
+        }
+        output[k].resize(size);
+      }
+    });
+    for (size_t k = 0; k < numPieces; ++k) {
+      if (!writeAll(outFd, output[k].data(), output[k].size())) {
+        return false;
+      }
+      for (int op = 0; op < 4; ++op) {
+        summary_.numOperators[op] += summaries[k].numOperators[op];
+      }
+      for (int i = 0; i <= kMaxLength; ++i) {
+        summary_.numWithDigits[i] += summaries[k].numWithDigits[i];
+        summary_.numWithMaxRepeat[i] += summaries[k].numWithMaxRepeat[i];
+      }
+    }
+    summary_.numPuzzles += fresh.size();
+  }
+  return true;
+}
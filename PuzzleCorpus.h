@@ -0,0 +1,116 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef PUZZLECORPUS_H_
+#define PUZZLECORPUS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "./GameSession.h"
+#include "./Random.h"
+#include "./ThreadPool.h"
+#include "./Variant.h"
+
+// Generates many distinct puzzles of a variant, f.e. for tournaments or a
+// schedule of daily puzzles, and writes them with some facts about each as
+// CSV or in a compact binary format.
+//
+// Puzzles are drawn in blocks. Every block is split into one piece per
+// thread of the pool, and piece k always draws from stream k of the seed
+// (see Random::stream), so the output only depends on the seed and the
+// number of threads. The pieces are merged in order, dropping puzzles that
+// were drawn before, and the new ones are described and formatted in
+// parallel again. Only one block of output is held at a time; what grows
+// with the number of puzzles is the set of those drawn so far, a hash
+// table of 8 bytes per slot that is kept at most half full.
+//
+// CSV has a header line and one line per puzzle:
+//   equation,plus,minus,times,divided,result,digits,distinct,max_repeat
+// The binary format has a 16-byte header (the magic "NRDLPUZL", the
+// version and the length of the equations as uint32) and a Record per
+// puzzle, little endian.
+class PuzzleCorpus {
+ public:
+  enum Format { kCsv, kBinary };
+
+  // Facts about a puzzle.
+  struct Puzzle {
+    // Codes of the symbols (see PackedEquation), the first one in the
+    // highest used nibble.
+    uint64_t packed;
+    // Value right of the equal sign and its number of digits.
+    uint32_t result;
+    uint8_t numDigits;
+    // Number of +, -, * and / in this order.
+    uint8_t numOperators[4];
+    // Number of different symbols and most uses of one symbol.
+    uint8_t numDistinct;
+    uint8_t maxRepeat;
+  };
+
+  // A puzzle in the binary format.
+  struct Record {
+    uint64_t packed;
+    uint32_t result;
+    // numOperators, 4 bits each, + in the lowest ones
+    uint16_t operators;
+    uint8_t numDistinct;
+    uint8_t maxRepeat;
+  };
+
+  // Facts about all puzzles written so far.
+  struct Summary {
+    size_t numPuzzles = 0;
+    // Puzzles drawn, including those that were drawn before.
+    size_t numDrawn = 0;
+    uint64_t numOperators[4] = {};
+    // Puzzles by number of digits of the result and by maxRepeat.
+    uint64_t numWithDigits[kMaxLength + 1] = {};
+    uint64_t numWithMaxRepeat[kMaxLength + 1] = {};
+  };
+
+  // Generate puzzles of the given variant with the threads of the given
+  // pool, which must outlive this.
+  PuzzleCorpus(const VariantRules* rules, ThreadPool* pool, uint64_t seed);
+
+  // Return the facts about the given correct equation.
+  static Puzzle describe(const std::string& equation);
+
+  // Write a puzzle with equations of the given length to out and return
+  // the number of bytes written. out must have room for maxOutput(length)
+  // bytes.
+  static size_t formatCsv(const Puzzle& puzzle, int length, char* out);
+  static size_t formatBinary(const Puzzle& puzzle, char* out);
+  static size_t maxOutput(int length) { return length + 40; }
+
+  // Draw puzzles until numPuzzles different ones were found and write them
+  // to the file descriptor outFd in the given format. Return false if the
+  // output can't be written or the variant seems to have fewer puzzles
+  // (no new one in 64 blocks); the puzzles found until then are written.
+  bool generate(size_t numPuzzles, Format format, int outFd);
+
+  const Summary& summary() const { return summary_; }
+
+ private:
+  // Puzzles drawn per block.
+  static constexpr size_t kBlockSize = 1 << 14;
+
+  // Add packed to the set of puzzles drawn so far. Return false if it was
+  // in there already.
+  bool insert(uint64_t packed);
+
+  const VariantRules* rules_;
+  ThreadPool* pool_;
+  // One generator per piece of a block.
+  std::vector<Random> streams_;
+  // Open addressing hash set of the packed puzzles drawn so far, 0 = empty.
+  std::vector<uint64_t> drawn_;
+  size_t numDrawn_;
+  Summary summary_;
+};
+
+static_assert(sizeof(PuzzleCorpus::Record) == 16,
+              "records are written as they are");
+
+#endif  // PUZZLECORPUS_H_
@@ -0,0 +1,101 @@
+// Copyright 2022 Henrik Roth
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "./PuzzleCorpus.h"
+#include "./ThreadPool.h"
+#include "./Variant.h"
+
+
+// Write many distinct puzzles with facts about each, f.e.
+// "PuzzleCorpusMain --variant maxi --puzzles 1000000 > puzzles.csv".
+// See PuzzleCorpus for the formats.
+int main(int argc, char** argv) {
+  const char* variant = "classic";
+  size_t numPuzzles = 1000;
+  uint64_t seed = 42;
+  int numThreads = 0;
+  PuzzleCorpus::Format format = PuzzleCorpus::kCsv;
+  const char* path = nullptr;
+  bool stats = false;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--variant") == 0 && i + 1 < argc) {
+      variant = argv[++i];
+    } else if (strcmp(argv[i], "--puzzles") == 0 && i + 1 < argc) {
+      numPuzzles = std::stoull(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = std::stoull(argv[++i]);
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      numThreads = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--binary") == 0) {
+      format = PuzzleCorpus::kBinary;
+    } else if (strcmp(argv[i], "--stats") == 0) {
+      stats = true;
+    } else if (argv[i][0] != '-' && path == nullptr) {
+      path = argv[i];
+    } else {
+      usage = true;
+    }
+  }
+  const VariantRules* rules = VariantRules::forName(variant);
+  if (usage || rules == nullptr) {
+    std::cerr << "Usage: " << argv[0] << " [--variant <name>]"
+              << " [--puzzles <n>] [--seed <n>] [--threads <n>] [--binary]"
+              << " [--stats] [<file>]" << std::endl;
+    return 1;
+  }
+  const int fd = path == nullptr
+      ? STDOUT_FILENO : open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    std::cerr << "Could not open " << path << ": " << strerror(errno)
+              << std::endl;
+    return 1;
+  }
+
+  ThreadPool pool(numThreads);
+  PuzzleCorpus corpus(rules, &pool, seed);
+  const auto start = std::chrono::steady_clock::now();
+  const bool generated = corpus.generate(numPuzzles, format, fd);
+  const std::chrono::duration<double> seconds =
+      std::chrono::steady_clock::now() - start;
+  if (path != nullptr) { close(fd); }
+  const PuzzleCorpus::Summary& summary = corpus.summary();
+  if (stats || !generated) {
+    std::cerr << summary.numPuzzles << " puzzles (" << summary.numDrawn
+              << " drawn) in " << seconds.count() << " s on "
+              << pool.numThreads() << " thread(s), "
+              << summary.numPuzzles / seconds.count() << " puzzles/s"
+              << std::endl;
+  }
+  if (!generated) {
+    std::cerr << (summary.numPuzzles < numPuzzles
+                  ? "There seem to be no more different puzzles"
+                  : "Could not write the puzzles") << std::endl;
+    return 1;
+  }
+  if (stats) {
+    std::cerr << "  operators: " << summary.numOperators[0] << " +, "
+              << summary.numOperators[1] << " -, "
+              << summary.numOperators[2] << " *, "
+              << summary.numOperators[3] << " /" << std::endl;
+    for (int i = 1; i <= kMaxLength; ++i) {
+      if (summary.numWithDigits[i] > 0) {
+        std::cerr << "  results with " << i << " digit(s): "
+                  << summary.numWithDigits[i] << std::endl;
+      }
+    }
+    for (int i = 1; i <= kMaxLength; ++i) {
+      if (summary.numWithMaxRepeat[i] > 0) {
+        std::cerr << "  a symbol used at most " << i << " time(s): "
+                  << summary.numWithMaxRepeat[i] << std::endl;
+      }
+    }
+  }
+  return 0;
+}
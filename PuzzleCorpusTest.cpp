@@ -0,0 +1,87 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include "./PuzzleCorpus.h"
+#include "./ThreadPool.h"
+#include "./Variant.h"
+
+namespace {
+// Generate numPuzzles puzzles of the given variant and return the output.
+std::string generate(const char* variant, size_t numPuzzles, uint64_t seed,
+                     int numThreads, PuzzleCorpus::Format format,
+                     bool* generated = nullptr) {
+  const char* path = "/tmp/PuzzleCorpusTest.out";
+  const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  ThreadPool pool(numThreads);
+  PuzzleCorpus corpus(VariantRules::forName(variant), &pool, seed);
+  const bool ok = corpus.generate(numPuzzles, format, fd);
+  if (generated != nullptr) { *generated = ok; }
+  close(fd);
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream output;
+  output << file.rdbuf();
+  unlink(path);
+  return output.str();
+}
+}  // namespace
+
+
+TEST(PuzzleCorpusTest, describe) {
+  const PuzzleCorpus::Puzzle puzzle = PuzzleCorpus::describe("3*33-9=90");
+  ASSERT_EQ(puzzle.result, 90u);
+  ASSERT_EQ(puzzle.numDigits, 2);
+  ASSERT_EQ(puzzle.numOperators[0], 0);
+  ASSERT_EQ(puzzle.numOperators[1], 1);
+  ASSERT_EQ(puzzle.numOperators[2], 1);
+  ASSERT_EQ(puzzle.numOperators[3], 0);
+  ASSERT_EQ(puzzle.numDistinct, 6);
+  ASSERT_EQ(puzzle.maxRepeat, 3);
+  char out[64];
+  ASSERT_EQ(std::string(out, PuzzleCorpus::formatCsv(puzzle, 9, out)),
+            "3*33-9=90,0,1,1,0,90,2,6,3\n");
+  ASSERT_EQ(PuzzleCorpus::formatBinary(puzzle, out), 16u);
+  PuzzleCorpus::Record record;
+  memcpy(&record, out, sizeof(record));
+  ASSERT_EQ(record.packed, 0x3C33B9E90u);
+  ASSERT_EQ(record.operators, 0x0110);
+}
+
+TEST(PuzzleCorpusTest, generate) {
+  const std::string csv = generate("maxi", 50000, 7, 3, PuzzleCorpus::kCsv);
+  // The same for the same seed and number of threads.
+  ASSERT_EQ(generate("maxi", 50000, 7, 3, PuzzleCorpus::kCsv), csv);
+  ASSERT_NE(generate("maxi", 50000, 8, 3, PuzzleCorpus::kCsv), csv);
+  std::istringstream lines(csv);
+  std::string line;
+  std::getline(lines, line);
+  ASSERT_EQ(line, "equation,plus,minus,times,divided,result,digits,"
+                  "distinct,max_repeat");
+  const VariantRules* rules = VariantRules::forName("maxi");
+  std::set<std::string> equations;
+  while (std::getline(lines, line)) {
+    const std::string equation = line.substr(0, line.find(','));
+    ASSERT_TRUE(rules->isCorrect(equation.data()));
+    ASSERT_TRUE(equations.insert(equation).second);
+  }
+  ASSERT_EQ(equations.size(), 50000u);
+
+  const std::string binary =
+      generate("maxi", 50000, 7, 3, PuzzleCorpus::kBinary);
+  ASSERT_EQ(binary.size(), 16 + 50000 * sizeof(PuzzleCorpus::Record));
+  ASSERT_EQ(binary.substr(0, 8), "NRDLPUZL");
+
+  // There are only so many mini puzzles.
+  bool generated;
+  const std::string all = generate("mini", 1000000, 7, 2, PuzzleCorpus::kCsv,
+                                   &generated);
+  ASSERT_FALSE(generated);
+  ASSERT_LT(std::count(all.begin(), all.end(), '\n'), 1000000);
+}
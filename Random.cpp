@@ -0,0 +1,123 @@
+// Copyright 2022 Henrik Roth
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <random>
+#include "./Random.h"
+
+namespace {
+// ____________________________________________________________________________
+uint64_t splitmix64(uint64_t* x) {
+  return Random::mix(*x += 0x9E3779B97F4A7C15ull);
+}
+
+// ____________________________________________________________________________
+uint64_t rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+}  // namespace
+
+// ____________________________________________________________________________
+Random::Random(uint64_t seed) {
+  for (int i = 0; i < 4; ++i) {
+    state_[i] = splitmix64(&seed);
+  }
+}
+
+// ____________________________________________________________________________
+Random::Random() : Random(0) {
+  // Mix a hardware random number, the time and a counter, so that even
+  // generators created at the same moment differ.
+  static std::atomic<uint64_t> counter(0);
+  std::random_device device;
+  uint64_t seed = (static_cast<uint64_t>(device()) << 32) ^ device();
+  seed ^= std::chrono::steady_clock::now().time_since_epoch().count();
+  seed += counter.fetch_add(1) * 0x9E3779B97F4A7C15ull;
+  *this = Random(seed);
+}
+
+// ____________________________________________________________________________
+uint64_t Random::dailySeed(int year, int month, int day) {
+  // Number of days since 1970-01-01 in the proleptic gregorian calendar.
+  year -= month <= 2;
+  const int64_t era = (year >= 0 ? year : year - 399) / 400;
+  const int64_t yearOfEra = year - era * 400;
+  const int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5
+                            + day - 1;
+  const int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100
+                           + dayOfYear;
+  uint64_t days = era * 146097 + dayOfEra - 719468;
+  return splitmix64(&days);
+}
+
+// ____________________________________________________________________________
+uint64_t Random::dailySeed() {
+  const time_t now = time(NULL);
+  struct tm date;
+  gmtime_r(&now, &date);
+  return dailySeed(date.tm_year + 1900, date.tm_mon + 1, date.tm_mday);
+}
+
+// ____________________________________________________________________________
+uint64_t Random::next() {
+  const uint64_t result = rotl(state_[1] * 5, 7) * 9;
+  const uint64_t t = state_[1] << 17;
+  state_[2] ^= state_[0];
+  state_[3] ^= state_[1];
+  state_[1] ^= state_[2];
+  state_[0] ^= state_[3];
+  state_[2] ^= t;
+  state_[3] = rotl(state_[3], 45);
+  return result;
+}
+
+// ____________________________________________________________________________
+uint64_t Random::uniform(uint64_t bound) {
+  // Lemire's multiply and reject method, unbiased and without division in
+  // the common case.
+  unsigned __int128 product = static_cast<unsigned __int128>(next()) * bound;
+  uint64_t low = static_cast<uint64_t>(product);
+  if (low < bound) {
+    const uint64_t threshold = -bound % bound;
+    while (low < threshold) {
+      product = static_cast<unsigned __int128>(next()) * bound;
+      low = static_cast<uint64_t>(product);
+    }
+  }
+  return static_cast<uint64_t>(product >> 64);
+}
+
+// ____________________________________________________________________________
+uint64_t Random::mix(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
+
+// ____________________________________________________________________________
+Random Random::stream(uint64_t k) const {
+  Random random = *this;
+  for (uint64_t i = 0; i < k; ++i) {
+    random.jump();
+  }
+  return random;
+}
+
+// ____________________________________________________________________________
+void Random::jump() {
+  static const uint64_t kJump[] = {
+      0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+      0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+  uint64_t s[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 4; ++i) {
+    for (int b = 0; b < 64; ++b) {
+      if (kJump[i] & (1ull << b)) {
+        for (int j = 0; j < 4; ++j) { s[j] ^= state_[j]; }
+      }
+      next();
+    }
+  }
+  for (int j = 0; j < 4; ++j) { state_[j] = s[j]; }
+}
@@ -0,0 +1,53 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <cstdint>
+
+// Seedable pseudo random number generator used to pick puzzles.
+// It is xoshiro256** seeded via splitmix64, so the same seed gives the same
+// numbers on every machine. Independent streams for parallel use are
+// obtained by jumping ahead 2^128 numbers per stream, so threads never have
+// to share a generator.
+class Random {
+ public:
+  // Initialize the generator with the given seed.
+  explicit Random(uint64_t seed);
+
+  // Initialize the generator with a seed that is different for every call,
+  // for games that don't need to be reproducible.
+  Random();
+
+  // Return a seed derived from the given date, f.e. for a daily puzzle that
+  // is the same for every player.
+  static uint64_t dailySeed(int year, int month, int day);
+
+  // Return the seed of the current day (UTC).
+  static uint64_t dailySeed();
+
+  // Return the next 64 random bits.
+  uint64_t next();
+
+  // Return a uniformly distributed number in [0, bound), bound > 0.
+  uint64_t uniform(uint64_t bound);
+
+  // Return the generator of stream number k: a copy of this generator
+  // jumped ahead k * 2^128 numbers. Streams of the same generator don't
+  // overlap, so they can be handed to different threads.
+  Random stream(uint64_t k) const;
+
+  // Advance the generator by 2^128 numbers.
+  void jump();
+
+  // Return the given number with its bits mixed by the finalizer of
+  // splitmix64, a bijection where neighbouring numbers get unrelated
+  // results. Combine numbers into a seed or hash with mix(mix(a) ^ b).
+  static uint64_t mix(uint64_t x);
+
+ private:
+  // The state of xoshiro256**.
+  uint64_t state_[4];
+};
+
+#endif  // RANDOM_H_
@@ -0,0 +1,76 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <set>
+#include "./Random.h"
+
+
+TEST(RandomTest, next) {
+  // reference values of xoshiro256** seeded with splitmix64(42), these must
+  // be the same on every machine
+  Random random(42);
+  ASSERT_EQ(random.next(), 1546998764402558742ull);
+  ASSERT_EQ(random.next(), 6990951692964543102ull);
+  ASSERT_EQ(random.next(), 12544586762248559009ull);
+  Random random0(7);
+  Random random1(7);
+  Random random2(8);
+  for (int i = 0; i < 1000; ++i) {
+    uint64_t value = random0.next();
+    ASSERT_EQ(value, random1.next());
+    ASSERT_NE(value, random2.next());
+  }
+}
+
+TEST(RandomTest, uniform) {
+  Random random(42);
+  int count[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  for (int i = 0; i < 100000; ++i) {
+    uint64_t value = random.uniform(10);
+    ASSERT_LT(value, 10);
+    ++count[value];
+  }
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_GT(count[i], 9500);
+    ASSERT_LT(count[i], 10500);
+  }
+  ASSERT_EQ(random.uniform(1), 0);
+}
+
+TEST(RandomTest, stream) {
+  Random random(42);
+  Random stream1 = random.stream(1);
+  ASSERT_EQ(stream1.next(), 5766981335298035530ull);
+  Random jumped = random;
+  jumped.jump();
+  jumped.jump();
+  Random stream2 = random.stream(2);
+  std::set<uint64_t> values;
+  for (int i = 0; i < 1000; ++i) {
+    uint64_t value = stream2.next();
+    ASSERT_EQ(value, jumped.next());
+    values.insert(value);
+    values.insert(random.next());
+  }
+  ASSERT_EQ(values.size(), 2000);  // streams don't overlap
+}
+
+TEST(RandomTest, dailySeed) {
+  ASSERT_EQ(Random::dailySeed(2022, 3, 14), 13135675149741243961ull);
+  ASSERT_EQ(Random::dailySeed(1970, 1, 1), 16294208416658607535ull);
+  ASSERT_EQ(Random::dailySeed(2022, 3, 14), Random::dailySeed(2022, 3, 14));
+  ASSERT_NE(Random::dailySeed(2022, 3, 14), Random::dailySeed(2022, 3, 15));
+  ASSERT_NE(Random::dailySeed(2022, 2, 28), Random::dailySeed(2022, 3, 1));
+  ASSERT_NE(Random::dailySeed(2024, 2, 29), Random::dailySeed(2024, 3, 1));
+}
+
+TEST(RandomTest, mix) {
+  ASSERT_EQ(Random::mix(0), 0u);
+  // neighbouring numbers spread over the whole range
+  std::set<uint64_t> buckets;
+  for (uint64_t x = 1; x <= 1000; ++x) {
+    ASSERT_NE(Random::mix(x), Random::mix(x + 1));
+    buckets.insert(Random::mix(x) >> 54);
+  }
+  ASSERT_GT(buckets.size(), 500u);
+}
@@ -0,0 +1,64 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef SCREEN_H_
+#define SCREEN_H_
+
+// Class for the input from the user.
+class UserInput {
+ public:
+  // The code of the key pressed.
+  int keycode_;
+  // Was the event a mousecklick.
+  bool isMouseclick_;
+  // If the event was a mousecklick, then the coordinates
+  // of the mouseclick are stored here.
+  int mouseX_ = -1;
+  int mouseY_ = -1;
+};
+
+// Where Nerdle draws the game and reads the keys of the player from. The
+// screen is made of "pixels" of two characters each. TerminalManager shows
+// it on the terminal, HeadlessScreen plays scripted keys without a terminal,
+// f.e. for tests and benchmarks.
+class Screen {
+ public:
+  virtual ~Screen() = default;
+
+  // Get input from the user. The keycode is -1 if no key was pressed.
+  virtual UserInput getUserInput() = 0;
+
+  // Wait until the user pressed a key or the given number of milliseconds
+  // passed, forever if it is negative. Return true if there is input.
+  virtual bool waitForInput(int timeoutMs) = 0;
+
+  // Draw a "pixel" at the given position with the given color.
+  // 1 = White, 2 = Green, 3 = Magenta, 4 = Grey.
+  virtual void drawPixel(int row, int col, bool inverse, int color) = 0;
+
+  // Draw a string at the given position and with the given color.
+  // 1 = White, 2 = Green, 3 = Magenta, 4 = Grey.
+  virtual void drawString(int row, int col, const char* output, int color,
+                          bool bold = true) = 0;
+
+  // Draw a single char at the given position
+  // and with the given color. 1 = White, 2 = Green, 3 = Magenta, 4 = Grey.
+  virtual void drawChar(int row, int col, const char* output, int color,
+                        bool bold = true) = 0;
+
+  // Draw a "box" of three times three pixels around the given location
+  // with the given color.
+  virtual void drawBox(int row, int col, int color) = 0;
+
+  // Show everything drawn since the last refresh. Each refresh ends a frame.
+  virtual void refresh() = 0;
+
+  // Stop using the screen before it is destroyed, f.e. to print an error
+  // message on the terminal instead.
+  virtual void close() = 0;
+
+  // Get the dimensions of the screen in pixels.
+  virtual int numRows() const = 0;
+  virtual int numCols() const = 0;
+};
+
+#endif  // SCREEN_H_
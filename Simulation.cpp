@@ -0,0 +1,100 @@
+// Copyright 2022 Henrik Roth
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "./GameSession.h"
+#include "./PackedEquation.h"
+#include "./Random.h"
+#include "./Simulation.h"
+
+// ____________________________________________________________________________
+uint64_t SimulationResult::games() const {
+  uint64_t games = losses;
+  for (uint64_t w : wins) { games += w; }
+  return games;
+}
+
+// ____________________________________________________________________________
+double SimulationResult::lossRate() const {
+  const uint64_t n = games();
+  return n > 0 ? static_cast<double>(losses) / n : 0;
+}
+
+// ____________________________________________________________________________
+void SimulationResult::merge(const SimulationResult& other) {
+  for (int r = 0; r < kNumRounds; ++r) { wins[r] += other.wins[r]; }
+  losses += other.losses;
+  invalidGuesses += other.invalidGuesses;
+}
+
+// ____________________________________________________________________________
+Simulation::Simulation(const EquationIndex* answers, ThreadPool* pool)
+    : answers_(answers), pool_(pool),
+      rules_(VariantRules::forName("classic")) {}
+
+// ____________________________________________________________________________
+int Simulation::play(Strategy* strategy, uint32_t answer, uint64_t seed,
+                     SimulationResult* result) const {
+  strategy->newGame(seed);
+  // The guesses go through the same checks and feedback as those of a
+  // player, so that a bug in the rules shows up here as well.
+  GameSession session(rules_, PackedEquation::unpack(answer));
+  for (int round = 1; round <= kNumRounds; ++round) {
+    const uint32_t guess = strategy->nextGuess();
+    const std::string symbols = PackedEquation::unpack(guess);
+    if (session.submit(symbols.data(), symbols.size()) !=
+        GameSession::kAccepted) {
+      ++result->invalidGuesses;
+      continue;
+    }
+    if (session.status() == GameSession::kWon) { return round; }
+    strategy->feedback(guess, session.pattern(session.round() - 1));
+  }
+  return 0;
+}
+
+// ____________________________________________________________________________
+SimulationResult Simulation::run(
+    size_t numGames, uint64_t seed,
+    const std::function<std::unique_ptr<Strategy>()>& newStrategy) const {
+  const auto start = std::chrono::steady_clock::now();
+  // the same draws as Nerdle::generateEquation
+  std::vector<uint32_t> answers(numGames);
+  std::vector<uint64_t> seeds(numGames);
+  Random random(seed);
+  Random seedRandom = random.stream(1);
+  for (size_t i = 0; i < numGames; ++i) {
+    answers[i] = answers_->packed(random.uniform(answers_->size()));
+    seeds[i] = seedRandom.next();
+  }
+
+  // A few batches per thread, so that threads that are done early can
+  // steal from the others.
+  const size_t gamesPerBatch = std::max<size_t>(
+      1, numGames / (8 * pool_->numThreads()));
+  SimulationResult result;
+  std::mutex resultMutex;
+  pool_->parallelFor(numGames, gamesPerBatch, [&](size_t begin, size_t end) {
+    std::unique_ptr<Strategy> strategy = newStrategy();
+    SimulationResult batch;
+    for (size_t i = begin; i < end; ++i) {
+      const int round = play(strategy.get(), answers[i], seeds[i], &batch);
+      if (round > 0) {
+        ++batch.wins[round - 1];
+      } else {
+        ++batch.losses;
+      }
+    }
+    std::lock_guard<std::mutex> lock(resultMutex);
+    result.merge(batch);
+  });
+  result.seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  return result;
+}
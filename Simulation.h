@@ -0,0 +1,67 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef SIMULATION_H_
+#define SIMULATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./Strategy.h"
+#include "./ThreadPool.h"
+#include "./Variant.h"
+
+// Number of guesses a player has in a classic game.
+constexpr int kNumRounds = 6;
+
+// Outcome of many simulated games.
+struct SimulationResult {
+  // Number of games won in round r at position r - 1.
+  std::vector<uint64_t> wins = std::vector<uint64_t>(kNumRounds, 0);
+  uint64_t losses = 0;
+  // Guesses that aren't correct equations. They count as lost rounds.
+  uint64_t invalidGuesses = 0;
+  double seconds = 0;
+
+  // Number of games played and share of them that was lost.
+  uint64_t games() const;
+  double lossRate() const;
+
+  // Add the outcome of other games.
+  void merge(const SimulationResult& other);
+};
+
+// Plays classic games without a terminal, as fast as possible: many games
+// run in parallel, every thread with its own strategy and game.
+class Simulation {
+ public:
+  // Play games with answers from the given index on the threads of the
+  // given pool. Both must outlive the simulation.
+  Simulation(const EquationIndex* answers, ThreadPool* pool);
+
+  // Play numGames games. newStrategy is called once per batch of games
+  // and may be called from several threads at once. The answers are drawn
+  // one after the other from Random(seed), so they are the same as those
+  // of numGames games of NerdleMain --seed <seed> and don't depend on the
+  // number of threads. The seeds of the strategies come from
+  // Random(seed).stream(1).
+  SimulationResult run(
+      size_t numGames, uint64_t seed,
+      const std::function<std::unique_ptr<Strategy>()>& newStrategy) const;
+
+  // Play one game against the given packed answer and return the round it
+  // was won in, or 0 if it was lost. The seed is passed on to the strategy.
+  // Every guess is submitted to a GameSession, which checks it and gives
+  // the feedback; rejected guesses are counted in result.
+  int play(Strategy* strategy, uint32_t answer, uint64_t seed,
+           SimulationResult* result) const;
+
+ private:
+  const EquationIndex* answers_;
+  ThreadPool* pool_;
+  const VariantRules* rules_;
+};
+
+#endif  // SIMULATION_H_
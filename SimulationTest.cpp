@@ -0,0 +1,114 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./Feedback.h"
+#include "./PackedEquation.h"
+#include "./Random.h"
+#include "./Simulation.h"
+#include "./Solver.h"
+#include "./Strategy.h"
+#include "./ThreadPool.h"
+
+namespace {
+// Strategy that always makes the same guesses.
+class FixedStrategy : public Strategy {
+ public:
+  explicit FixedStrategy(std::vector<std::string> guesses)
+      : guesses_(guesses), next_(0) {}
+  void newGame(uint64_t /*seed*/) override { next_ = 0; }
+  uint32_t nextGuess() override {
+    return PackedEquation::pack(&guesses_[next_++ % guesses_.size()]);
+  }
+  void feedback(uint32_t /*guess*/, uint16_t /*pattern*/) override {}
+
+ private:
+  std::vector<std::string> guesses_;
+  size_t next_;
+};
+}  // namespace
+
+TEST(SimulationTest, play) {
+  const EquationIndex& index = EquationIndex::classic();
+  ThreadPool pool(1);
+  Simulation simulation(&index, &pool);
+  const std::string answer = "12+35=47";
+  SimulationResult result;
+  FixedStrategy winsThird({"9*8-7=65", "10+20=30", "12+35=47"});
+  ASSERT_EQ(simulation.play(&winsThird, PackedEquation::pack(&answer), 0,
+                            &result), 3);
+  // "1+1+1=33" isn't correct, so it costs a round
+  FixedStrategy invalidFirst({"1+1+1=33", "12+35=47"});
+  ASSERT_EQ(simulation.play(&invalidFirst, PackedEquation::pack(&answer), 0,
+                            &result), 2);
+  ASSERT_EQ(result.invalidGuesses, 1);
+  FixedStrategy loses({"9*8-7=65"});
+  ASSERT_EQ(simulation.play(&loses, PackedEquation::pack(&answer), 0,
+                            &result), 0);
+}
+
+TEST(SimulationTest, run) {
+  const EquationIndex& index = EquationIndex::classic();
+  ThreadPool serialPool(1);
+  ThreadPool parallelPool(4);
+  auto newStrategy = [&index]() -> std::unique_ptr<Strategy> {
+    return std::make_unique<RandomStrategy>(&index);
+  };
+  const SimulationResult serial =
+      Simulation(&index, &serialPool).run(500, 7, newStrategy);
+  const SimulationResult parallel =
+      Simulation(&index, &parallelPool).run(500, 7, newStrategy);
+  ASSERT_EQ(serial.games(), 500);
+  ASSERT_EQ(serial.wins, parallel.wins);
+  ASSERT_EQ(serial.losses, parallel.losses);
+  ASSERT_EQ(serial.invalidGuesses, 0);
+  ASSERT_GT(serial.wins[3], 0);
+  ASSERT_LT(serial.lossRate(), 0.2);
+  // the same answers as Nerdle::generateEquation with the same seed
+  Random random(7);
+  const uint32_t firstAnswer = index.packed(random.uniform(index.size()));
+  const SimulationResult won = Simulation(&index, &serialPool).run(
+      1, 7, [&]() -> std::unique_ptr<Strategy> {
+    return std::make_unique<FixedStrategy>(
+        std::vector<std::string>{PackedEquation::unpack(firstAnswer)});
+  });
+  ASSERT_EQ(won.wins[0], 1);
+}
+
+TEST(SimulationTest, solverStrategy) {
+  const EquationIndex& index = EquationIndex::classic();
+  ThreadPool pool(1);
+  Solver solver(&index, &index, &pool);
+  const std::string opening = "48-32=16";
+  SolverStrategy strategy(&solver, PackedEquation::pack(&opening),
+                          Solver::kEntropy);
+  Simulation simulation(&index, &pool);
+  SimulationResult result;
+  for (size_t a = 0; a < index.size(); a += 1801) {
+    const int round = simulation.play(&strategy, index.packed(a), 0, &result);
+    ASSERT_GE(round, 1);
+    ASSERT_LE(round, 4);
+  }
+}
+
+TEST(SimulationTest, noCandidates) {
+  // Feedback no answer gets leaves the strategies without a guess.
+  const EquationIndex answers = EquationIndex::classic().sample(50);
+  ThreadPool pool(1);
+  Solver solver(&answers, &answers, &pool);
+  const std::string opening = "48-32=16";
+  SolverStrategy solverStrategy(&solver, PackedEquation::pack(&opening),
+                                Solver::kEntropy);
+  RandomStrategy randomStrategy(&answers);
+  for (Strategy* strategy : {static_cast<Strategy*>(&solverStrategy),
+                             static_cast<Strategy*>(&randomStrategy)}) {
+    strategy->newGame(1);
+    const uint32_t guess = strategy->nextGuess();
+    strategy->feedback(guess, 0);
+    strategy->feedback(guess, kAllGreen - 1);
+    ASSERT_EQ(strategy->nextGuess(), 0u);
+  }
+}
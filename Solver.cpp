@@ -0,0 +1,146 @@
+// Copyright 2022 Henrik Roth
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "./Feedback.h"
+#include "./Solver.h"
+
+namespace {
+// Guesses scored per task. Small enough to balance the threads, large
+// enough that the scratch space of a task is cheap.
+constexpr size_t kGuessesPerTask = 256;
+
+// Return true if suggestion a is better than suggestion b.
+bool isBetter(const Solver::Suggestion& a, const Solver::Suggestion& b,
+              Solver::Criterion criterion) {
+  if (criterion == Solver::kEntropy && a.entropy != b.entropy) {
+    return a.entropy > b.entropy;
+  }
+  if (criterion == Solver::kExpectedSize && a.expectedSize != b.expectedSize) {
+    return a.expectedSize < b.expectedSize;
+  }
+  if (a.possible != b.possible) { return a.possible; }
+  return a.guess < b.guess;
+}
+}  // namespace
+
+// ____________________________________________________________________________
+Solver::Solver(const EquationIndex* guesses, const EquationIndex* answers,
+               ThreadPool* pool)
+    : guesses_(guesses), answers_(answers), candidateIndex_(answers),
+      pool_(pool), matrix_(nullptr) {}
+
+// ____________________________________________________________________________
+bool Solver::useMatrix(const FeedbackMatrix* matrix) {
+  if (matrix->numGuesses() != guesses_->size() ||
+      matrix->numAnswers() != answers_->size() ||
+      !std::equal(guesses_->data(), guesses_->data() + guesses_->size(),
+                  matrix->guesses()) ||
+      !std::equal(answers_->data(), answers_->data() + answers_->size(),
+                  matrix->answers())) {
+    return false;
+  }
+  matrix_ = matrix;
+  return true;
+}
+
+// ____________________________________________________________________________
+std::vector<uint32_t> Solver::candidates(
+    const std::vector<Move>& history) const {
+  CandidateSet candidates(&candidateIndex_);
+  for (const Move& move : history) {
+    candidates.apply(move.guess, move.pattern);
+  }
+  return candidates.positions();
+}
+
+// ____________________________________________________________________________
+std::vector<uint32_t> Solver::filter(const std::vector<uint32_t>& candidates,
+                                     const Move& move) const {
+  std::vector<uint32_t> packed(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    packed[i] = answers_->packed(candidates[i]);
+  }
+  std::vector<uint16_t> patterns(candidates.size());
+  Feedback::patterns(move.guess, packed.data(), packed.size(),
+                     patterns.data());
+  std::vector<uint32_t> result;
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    if (patterns[i] == move.pattern) { result.push_back(candidates[i]); }
+  }
+  return result;
+}
+
+// ____________________________________________________________________________
+Solver::Suggestion Solver::score(size_t guess,
+                                 const std::vector<uint32_t>& candidates,
+                                 const uint32_t* packedCandidates,
+                                 const double* xLogX, uint16_t* patterns,
+                                 uint32_t* counts) const {
+  const size_t n = candidates.size();
+  const uint16_t* row = matrix_ != nullptr ? matrix_->row(guess) : nullptr;
+  if (row != nullptr) {
+    for (size_t i = 0; i < n; ++i) { patterns[i] = row[candidates[i]]; }
+  } else if (matrix_ != nullptr) {
+    for (size_t i = 0; i < n; ++i) {
+      patterns[i] = matrix_->pattern(guess, candidates[i]);
+    }
+  } else {
+    Feedback::patterns(guesses_->packed(guess), packedCandidates, n,
+                       patterns);
+  }
+  for (size_t i = 0; i < n; ++i) { ++counts[patterns[i]]; }
+
+  Suggestion suggestion;
+  suggestion.guess = guess;
+  suggestion.packed = guesses_->packed(guess);
+  suggestion.possible = counts[kAllGreen] > 0;
+  // Sum c * log2(c) and c * c over the groups. Each counter is cleared the
+  // first time its group is seen, so later members of the group add 0.
+  double sumLog = 0;
+  uint64_t sumSquares = 0;
+  uint32_t worstCase = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const uint32_t c = counts[patterns[i]];
+    counts[patterns[i]] = 0;
+    sumLog += xLogX[c];
+    sumSquares += static_cast<uint64_t>(c) * c;
+    worstCase = std::max(worstCase, c);
+  }
+  suggestion.entropy = n > 0 ? std::log2(n) - sumLog / n : 0;
+  suggestion.expectedSize = n > 0 ? static_cast<double>(sumSquares) / n : 0;
+  suggestion.worstCase = worstCase;
+  return suggestion;
+}
+
+// ____________________________________________________________________________
+std::vector<Solver::Suggestion> Solver::suggest(
+    const std::vector<uint32_t>& candidates, size_t k,
+    Criterion criterion) const {
+  std::vector<uint32_t> packed(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    packed[i] = answers_->packed(candidates[i]);
+  }
+  std::vector<double> xLogX(candidates.size() + 1, 0);
+  for (size_t c = 2; c < xLogX.size(); ++c) { xLogX[c] = c * std::log2(c); }
+  std::vector<Suggestion> scores(guesses_->size());
+  pool_->parallelFor(guesses_->size(), kGuessesPerTask,
+                     [&](size_t begin, size_t end) {
+    std::vector<uint16_t> patterns(candidates.size());
+    std::vector<uint32_t> counts(kNumPatterns, 0);
+    for (size_t g = begin; g < end; ++g) {
+      scores[g] = score(g, candidates, packed.data(), xLogX.data(),
+                        patterns.data(), counts.data());
+    }
+  });
+  k = std::min(k, scores.size());
+  std::partial_sort(scores.begin(), scores.begin() + k, scores.end(),
+                    [criterion](const Suggestion& a, const Suggestion& b) {
+    return isBetter(a, b, criterion);
+  });
+  scores.resize(k);
+  return scores;
+}
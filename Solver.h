@@ -0,0 +1,96 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef SOLVER_H_
+#define SOLVER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "./CandidateSet.h"
+#include "./EquationIndex.h"
+#include "./FeedbackMatrix.h"
+#include "./ThreadPool.h"
+
+// A guess (packed, see PackedEquation) and the feedback pattern it got
+// (see Feedback).
+struct Move {
+  uint32_t guess;
+  uint16_t pattern;
+};
+
+// Suggests the next guess. Every possible guess is scored by how it splits
+// the answers that are still possible (the candidates) into groups with
+// the same feedback: the more and the smaller the groups, the better.
+class Solver {
+ public:
+  // How guesses are scored.
+  enum Criterion {
+    // Maximal information, the entropy of the group sizes in bits.
+    kEntropy,
+    // Minimal expected number of candidates left after the guess.
+    kExpectedSize
+  };
+
+  // A scored guess.
+  struct Suggestion {
+    // Position of the guess in the guesses of the solver and packed guess.
+    size_t guess;
+    uint32_t packed;
+    // Entropy of the feedback in bits and expected number of candidates
+    // left, the same as the expected size of the group of the answer.
+    double entropy;
+    double expectedSize;
+    // Size of the largest group.
+    uint32_t worstCase;
+    // True if the guess is a candidate itself, so it may win right away.
+    bool possible;
+  };
+
+  // Solver that picks from the given guesses for the given answers. Scoring
+  // is spread over the threads of the pool. Everything must outlive the
+  // solver.
+  Solver(const EquationIndex* guesses, const EquationIndex* answers,
+         ThreadPool* pool);
+
+  // Look feedback up in the given matrix instead of computing it. Return
+  // false (and keep computing) if the matrix wasn't built for the guesses
+  // and answers of the solver.
+  bool useMatrix(const FeedbackMatrix* matrix);
+
+  // The guesses the solver picks from and the answers the candidates are
+  // positions in.
+  const EquationIndex* guesses() const { return guesses_; }
+  const EquationIndex* answers() const { return answers_; }
+
+  // Return the positions of the answers that are consistent with every
+  // move, in ascending order. Uses a CandidateSet, so this takes a few
+  // microseconds per move.
+  std::vector<uint32_t> candidates(const std::vector<Move>& history) const;
+
+  // Return the given candidates that are consistent with the move.
+  std::vector<uint32_t> filter(const std::vector<uint32_t>& candidates,
+                               const Move& move) const;
+
+  // Score every guess against the given candidates (positions of answers)
+  // and return the k best, best first. Ties are broken in favor of guesses
+  // that are candidates, then of the lower position.
+  std::vector<Suggestion> suggest(const std::vector<uint32_t>& candidates,
+                                  size_t k, Criterion criterion) const;
+
+ private:
+  // Score the guess at the given position against the given candidates.
+  // xLogX holds c * log2(c) for every group size c. patterns and counts
+  // are scratch space for candidates.size() patterns and kNumPatterns
+  // counters, counts must be and is left zeroed.
+  Suggestion score(size_t guess, const std::vector<uint32_t>& candidates,
+                   const uint32_t* packedCandidates, const double* xLogX,
+                   uint16_t* patterns, uint32_t* counts) const;
+
+  const EquationIndex* guesses_;
+  const EquationIndex* answers_;
+  CandidateIndex candidateIndex_;
+  ThreadPool* pool_;
+  const FeedbackMatrix* matrix_;
+};
+
+#endif  // SOLVER_H_
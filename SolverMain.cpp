@@ -0,0 +1,98 @@
+// Copyright 2022 Henrik Roth
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./Feedback.h"
+#include "./FeedbackMatrix.h"
+#include "./PackedEquation.h"
+#include "./Solver.h"
+#include "./ThreadPool.h"
+
+
+// Suggest the next guess of a classic game given the guesses so far and
+// their feedback, f.e. "SolverMain 9*8-7=65 11311111".
+int main(int argc, char** argv) {
+  const EquationIndex& index = EquationIndex::classic();
+  int numThreads = 0;
+  size_t k = 5;
+  Solver::Criterion criterion = Solver::kEntropy;
+  const char* matrixPath = nullptr;
+  std::vector<Move> history;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      numThreads = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+      k = std::stoi(argv[++i]);
+    } else if (strcmp(argv[i], "--expected-size") == 0) {
+      criterion = Solver::kExpectedSize;
+    } else if (strcmp(argv[i], "--matrix") == 0 && i + 1 < argc) {
+      matrixPath = argv[++i];
+    } else if (argv[i][0] != '-' && i + 1 < argc) {
+      const std::string guess = argv[i];
+      const std::string highlight = argv[++i];
+      if (guess.size() != kEquationLength ||
+          guess.find_first_not_of("0123456789+-*/=") != std::string::npos ||
+          index.find(PackedEquation::pack(&guess)) < 0 ||
+          highlight.size() != kEquationLength ||
+          highlight.find_first_not_of("123") != std::string::npos) {
+        std::cerr << "Invalid move: " << guess << " " << highlight
+                  << std::endl;
+        return 1;
+      }
+      history.push_back({PackedEquation::pack(&guess),
+                         Feedback::fromHighlight(&highlight)});
+    } else {
+      usage = true;
+    }
+  }
+  if (usage) {
+    std::cerr << "Usage: " << argv[0] << " [--threads <n>] [--top <k>]"
+              << " [--expected-size] [--matrix <file>]"
+              << " [<guess> <highlight>]..." << std::endl
+              << "A highlight has one digit per cell: 1 = black,"
+              << " 2 = green, 3 = magenta." << std::endl;
+    return 1;
+  }
+
+  ThreadPool pool(numThreads);
+  Solver solver(&index, &index, &pool);
+  FeedbackMatrix matrix;
+  if (matrixPath != nullptr &&
+      (!matrix.open(matrixPath) || !solver.useMatrix(&matrix))) {
+    std::cerr << matrixPath << " is not a feedback matrix of the classic"
+              << " equations" << std::endl;
+    return 1;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const std::vector<uint32_t> candidates = solver.candidates(history);
+  if (candidates.empty()) {
+    std::cerr << "No equation fits this feedback" << std::endl;
+    return 1;
+  }
+  const std::vector<Solver::Suggestion> suggestions =
+      solver.suggest(candidates, k, criterion);
+  const double milliseconds = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+
+  std::cout << candidates.size() << " possible answer(s)";
+  if (candidates.size() <= 10) {
+    for (uint32_t c : candidates) { std::cout << " " << index.equation(c); }
+  }
+  std::cout << std::endl;
+  for (const Solver::Suggestion& s : suggestions) {
+    std::cout << PackedEquation::unpack(s.packed) << "  " << s.entropy
+              << " bits, " << s.expectedSize << " expected left, "
+              << s.worstCase << " at worst" << (s.possible ? ", possible" : "")
+              << std::endl;
+  }
+  std::cout << "Scored " << index.size() << " guesses with "
+            << pool.numThreads() << " thread(s) in " << milliseconds << " ms"
+            << std::endl;
+  return 0;
+}
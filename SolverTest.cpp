@@ -0,0 +1,134 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./Feedback.h"
+#include "./FeedbackMatrix.h"
+#include "./PackedEquation.h"
+#include "./Solver.h"
+#include "./ThreadPool.h"
+
+
+TEST(SolverTest, candidates) {
+  const EquationIndex& index = EquationIndex::classic();
+  ThreadPool pool(2);
+  Solver solver(&index, &index, &pool);
+  ASSERT_EQ(solver.candidates({}).size(), index.size());
+  const std::string answer = "12+35=47";
+  const uint32_t packedAnswer = PackedEquation::pack(&answer);
+  std::vector<Move> history;
+  for (const std::string guess : {"9*8-7=65", "10+20=30"}) {
+    const uint32_t packedGuess = PackedEquation::pack(&guess);
+    history.push_back({packedGuess,
+                       Feedback::pattern(packedGuess, packedAnswer)});
+  }
+  const std::vector<uint32_t> candidates = solver.candidates(history);
+  ASSERT_LT(candidates.size(), 100);
+  bool foundAnswer = false;
+  for (uint32_t c : candidates) {
+    foundAnswer |= index.packed(c) == packedAnswer;
+    for (const Move& move : history) {
+      ASSERT_EQ(Feedback::pattern(move.guess, index.packed(c)),
+                move.pattern);
+    }
+  }
+  ASSERT_TRUE(foundAnswer);
+  ASSERT_EQ(solver.filter(candidates, history[0]), candidates);
+}
+
+TEST(SolverTest, suggest) {
+  const EquationIndex& index = EquationIndex::classic();
+  ThreadPool serialPool(1);
+  ThreadPool parallelPool(4);
+  Solver serial(&index, &index, &serialPool);
+  Solver parallel(&index, &index, &parallelPool);
+  const std::string guess = "58-46=12";
+  const std::string answer = "3*8-9=15";
+  const uint32_t packedGuess = PackedEquation::pack(&guess);
+  const std::vector<uint32_t> candidates = serial.candidates(
+      {{packedGuess, Feedback::pattern(packedGuess,
+                                       PackedEquation::pack(&answer))}});
+  for (Solver::Criterion criterion : {Solver::kEntropy,
+                                      Solver::kExpectedSize}) {
+    const std::vector<Solver::Suggestion> all =
+        serial.suggest(candidates, index.size(), criterion);
+    ASSERT_EQ(all.size(), index.size());
+    const std::vector<Solver::Suggestion> top =
+        parallel.suggest(candidates, 5, criterion);
+    ASSERT_EQ(top.size(), 5);
+    for (size_t i = 0; i < top.size(); ++i) {
+      ASSERT_EQ(top[i].guess, all[i].guess);
+      ASSERT_EQ(top[i].packed, index.packed(top[i].guess));
+      ASSERT_EQ(top[i].entropy, all[i].entropy);
+      ASSERT_EQ(top[i].expectedSize, all[i].expectedSize);
+    }
+    for (size_t i = 1; i < all.size(); ++i) {
+      if (criterion == Solver::kEntropy) {
+        ASSERT_GE(all[i - 1].entropy, all[i].entropy);
+      } else {
+        ASSERT_LE(all[i - 1].expectedSize, all[i].expectedSize);
+      }
+      ASSERT_LE(all[i].worstCase, candidates.size());
+    }
+  }
+  // With one candidate left it is the best guess.
+  const std::vector<Solver::Suggestion> last =
+      serial.suggest({1234}, 1, Solver::kEntropy);
+  ASSERT_EQ(last[0].guess, 1234);
+  ASSERT_TRUE(last[0].possible);
+  ASSERT_EQ(last[0].entropy, 0);
+  ASSERT_EQ(last[0].expectedSize, 1);
+}
+
+TEST(SolverTest, matrix) {
+  std::vector<uint32_t> equations;
+  for (size_t i = 0; i < 2000; i += 3) {
+    equations.push_back(EquationIndex::classic().packed(i * 9));
+  }
+  const EquationIndex index(equations);
+  const char* path = "SolverTest.matrix.tmp";
+  ASSERT_TRUE(FeedbackMatrix::build(index.data(), index.size(), index.data(),
+                                    index.size(), path, 2, false));
+  FeedbackMatrix matrix;
+  ASSERT_TRUE(matrix.open(path));
+  ThreadPool pool(2);
+  Solver computing(&index, &index, &pool);
+  Solver lookingUp(&index, &index, &pool);
+  Solver mismatched(&EquationIndex::classic(), &index, &pool);
+  ASSERT_FALSE(mismatched.useMatrix(&matrix));
+  ASSERT_TRUE(lookingUp.useMatrix(&matrix));
+  const std::vector<uint32_t> candidates = computing.candidates({});
+  const std::vector<Solver::Suggestion> expected =
+      computing.suggest(candidates, 10, Solver::kEntropy);
+  const std::vector<Solver::Suggestion> actual =
+      lookingUp.suggest(candidates, 10, Solver::kEntropy);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(actual[i].guess, expected[i].guess);
+    ASSERT_EQ(actual[i].entropy, expected[i].entropy);
+  }
+  unlink(path);
+}
+
+TEST(SolverTest, solve) {
+  const EquationIndex& index = EquationIndex::classic();
+  ThreadPool pool(2);
+  Solver solver(&index, &index, &pool);
+  // scoring the opening takes long, start with a good one
+  const std::string openingEquation = "48-32=16";
+  const uint32_t opening = PackedEquation::pack(&openingEquation);
+  for (size_t a = 0; a < index.size(); a += 2003) {
+    std::vector<uint32_t> candidates = solver.candidates({});
+    uint32_t guess = opening;
+    int rounds = 1;
+    while (guess != index.packed(a)) {
+      const Move move = {guess, Feedback::pattern(guess, index.packed(a))};
+      candidates = solver.filter(candidates, move);
+      guess = solver.suggest(candidates, 1, Solver::kEntropy)[0].packed;
+      ++rounds;
+    }
+    ASSERT_LE(rounds, 6) << index.equation(a);
+  }
+}
@@ -0,0 +1,89 @@
+// Copyright 2022 Henrik Roth
+
+#include <cstdint>
+#include <vector>
+#include "./Strategy.h"
+
+// ____________________________________________________________________________
+RandomStrategy::RandomStrategy(const EquationIndex* answers)
+    : answers_(answers), random_(0) {}
+
+// ____________________________________________________________________________
+void RandomStrategy::newGame(uint64_t seed) {
+  random_ = Random(seed);
+  candidates_.assign(answers_->data(), answers_->data() + answers_->size());
+}
+
+// ____________________________________________________________________________
+uint32_t RandomStrategy::nextGuess() {
+  if (candidates_.empty()) { return 0; }
+  return candidates_[random_.uniform(candidates_.size())];
+}
+
+// ____________________________________________________________________________
+void RandomStrategy::feedback(uint32_t guess, uint16_t pattern) {
+  patterns_.resize(candidates_.size());
+  Feedback::patterns(guess, candidates_.data(), candidates_.size(),
+                     patterns_.data());
+  size_t kept = 0;
+  for (size_t i = 0; i < candidates_.size(); ++i) {
+    if (patterns_[i] == pattern) { candidates_[kept++] = candidates_[i]; }
+  }
+  candidates_.resize(kept);
+}
+
+// ____________________________________________________________________________
+SolverStrategy::SolverStrategy(const Solver* solver, uint32_t opening,
+                               Solver::Criterion criterion,
+                               OpeningBook* book)
+    : solver_(solver), opening_(opening), criterion_(criterion), book_(book),
+      round_(0), openingPattern_(0), secondGuess_(kNumPatterns, 0) {}
+
+// ____________________________________________________________________________
+void SolverStrategy::newGame(uint64_t /*seed*/) {
+  candidates_ = solver_->candidates({});
+  history_.clear();
+  round_ = 0;
+}
+
+// ____________________________________________________________________________
+uint32_t SolverStrategy::nextGuess() {
+  if (round_ == 0) { return opening_; }
+  if (candidates_.empty()) { return 0; }
+  if (candidates_.size() <= 2) {
+    return solver_->answers()->packed(candidates_[0]);
+  }
+  if (round_ == 1 && secondGuess_[openingPattern_] != 0) {
+    return secondGuess_[openingPattern_];
+  }
+  const uint32_t guess = book_ != nullptr
+      ? book_->bestGuess(history_, candidates_)
+      : solver_->suggest(candidates_, 1, criterion_)[0].packed;
+  if (round_ == 1) { secondGuess_[openingPattern_] = guess; }
+  return guess;
+}
+
+// ____________________________________________________________________________
+void SolverStrategy::feedback(uint32_t guess, uint16_t pattern) {
+  if (round_ == 0) { openingPattern_ = pattern; }
+  candidates_ = solver_->filter(candidates_, {guess, pattern});
+  history_.push_back({guess, pattern});
+  ++round_;
+}
+
+// ____________________________________________________________________________
+TreeStrategy::TreeStrategy(const DecisionTree* tree)
+    : tree_(tree), node_(tree->root()) {}
+
+// ____________________________________________________________________________
+void TreeStrategy::newGame(uint64_t /*seed*/) { node_ = tree_->root(); }
+
+// ____________________________________________________________________________
+uint32_t TreeStrategy::nextGuess() {
+  return node_ == DecisionTree::kNoNode ? 0 : tree_->guess(node_);
+}
+
+// ____________________________________________________________________________
+void TreeStrategy::feedback(uint32_t /*guess*/, uint16_t pattern) {
+  if (node_ != DecisionTree::kNoNode) { node_ = tree_->next(node_, pattern); }
+}
@@ -0,0 +1,113 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef STRATEGY_H_
+#define STRATEGY_H_
+
+#include <cstdint>
+#include <vector>
+#include "./DecisionTree.h"
+#include "./EquationIndex.h"
+#include "./Feedback.h"
+#include "./OpeningBook.h"
+#include "./Random.h"
+#include "./Solver.h"
+
+// A way of playing classic games without a player: it picks guesses
+// (packed, see PackedEquation) and learns from their feedback. A strategy
+// plays one game at a time, so every thread needs its own.
+class Strategy {
+ public:
+  virtual ~Strategy() = default;
+
+  // Forget the previous game and start a new one. Strategies that make
+  // random choices draw them from the given seed, so a game is played the
+  // same way on any thread.
+  virtual void newGame(uint64_t seed) = 0;
+
+  // Return the next guess, or 0 if no answer fits the feedback so far,
+  // f.e. because it came from another set of answers.
+  virtual uint32_t nextGuess() = 0;
+
+  // Learn the feedback pattern (see Feedback) of the last guess.
+  virtual void feedback(uint32_t guess, uint16_t pattern) = 0;
+};
+
+// Guess an equation picked at random among those that fit all feedback so
+// far.
+class RandomStrategy : public Strategy {
+ public:
+  // Pick from the given answers, which must outlive the strategy.
+  explicit RandomStrategy(const EquationIndex* answers);
+
+  void newGame(uint64_t seed) override;
+  uint32_t nextGuess() override;
+  void feedback(uint32_t guess, uint16_t pattern) override;
+
+  // Number of answers that fit all feedback of the current game.
+  size_t numCandidates() const { return candidates_.size(); }
+
+ private:
+  const EquationIndex* answers_;
+  Random random_;
+
+  // Packed answers that fit all feedback of the current game and scratch
+  // space for their patterns.
+  std::vector<uint32_t> candidates_;
+  std::vector<uint16_t> patterns_;
+};
+
+// Guess what the solver suggests. The opening is given, the second guess
+// only depends on the feedback of the opening, so it is remembered for
+// every feedback pattern. With one or two candidates left, the first one
+// is guessed right away, as the solver would. Given an opening book, the
+// guesses after the first moves are looked up there instead, and those
+// not in the book yet are added for other games, threads and processes.
+class SolverStrategy : public Strategy {
+ public:
+  // Follow the given solver, which must outlive the strategy, and so must
+  // the book, which must be opened for the same solver and criterion.
+  SolverStrategy(const Solver* solver, uint32_t opening,
+                 Solver::Criterion criterion, OpeningBook* book = nullptr);
+
+  void newGame(uint64_t seed) override;
+  uint32_t nextGuess() override;
+  void feedback(uint32_t guess, uint16_t pattern) override;
+
+ private:
+  const Solver* solver_;
+  uint32_t opening_;
+  Solver::Criterion criterion_;
+  OpeningBook* book_;
+
+  // Moves of the current game.
+  std::vector<Move> history_;
+
+  // Positions of the answers that fit all feedback of the current game.
+  std::vector<uint32_t> candidates_;
+
+  // Number of guesses in the current game and pattern of the opening.
+  int round_;
+  uint16_t openingPattern_;
+
+  // Second guess for every pattern of the opening, 0 if not known yet.
+  std::vector<uint32_t> secondGuess_;
+};
+
+// Guess what a precomputed decision tree says, one step down the tree per
+// move. Guesses 0 if the feedback leads out of the tree, which only happens
+// if the answer isn't one the tree was built for.
+class TreeStrategy : public Strategy {
+ public:
+  // Follow the given tree, which must outlive the strategy.
+  explicit TreeStrategy(const DecisionTree* tree);
+
+  void newGame(uint64_t seed) override;
+  uint32_t nextGuess() override;
+  void feedback(uint32_t guess, uint16_t pattern) override;
+
+ private:
+  const DecisionTree* tree_;
+  uint32_t node_;
+};
+
+#endif  // STRATEGY_H_
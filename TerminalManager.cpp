@@ -8,6 +8,8 @@
 //
 #include "./TerminalManager.h"
 #include <ncurses.h>
+#include <poll.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <cmath>
@@ -24,6 +26,10 @@ TerminalManager::TerminalManager() {
   curs_set(false);
   nodelay(stdscr, true);
   keypad(stdscr, true);
+  WINDOW* input = newwin(1, 1, 0, 0);
+  nodelay(input, true);
+  keypad(input, true);
+  input_ = input;
   // Catch mouse events
   mousemask(ALL_MOUSE_EVENTS, NULL);
   mouseinterval(0);
@@ -35,62 +41,103 @@ TerminalManager::TerminalManager() {
   init_pair(4, COLOR_WHITE, COLOR_GREY);
   numRows_ = LINES;
   numCols_ = COLS / 2;
+  width_ = COLS;
+  // The screen is blank after initscr.
+  shown_.assign(LINES * COLS, Cell{' ', 0, false, false});
+  drawn_ = shown_;
+  numCharsSent_ = 0;
 }
 
 // ____________________________________________________________________________
-TerminalManager::~TerminalManager() { endwin();}
+TerminalManager::~TerminalManager() { close(); }
+
+// ____________________________________________________________________________
+void TerminalManager::close() {
+  // play() may end the screen early, this must happen only once
+  if (input_ == nullptr) { return; }
+  delwin(static_cast<WINDOW*>(input_));
+  input_ = nullptr;
+  endwin();
+}
+
+// ____________________________________________________________________________
+void TerminalManager::put(int row, int column, const char* text,
+                          const Cell& look) {
+  if (row < 0 || row >= numRows_) { return; }
+  Cell* cells = &drawn_[row * width_];
+  for (; *text != '\0' && column < width_; ++text, ++column) {
+    if (column >= 0) {
+      cells[column] = look;
+      cells[column].symbol = *text;
+    }
+  }
+}
 
 // ____________________________________________________________________________
 void TerminalManager::drawPixel(int row, int col, bool inverse, int color) {
-  if (inverse) attron(A_REVERSE);
-  attron(COLOR_PAIR(color));
-  mvprintw(row, 2 * col, "  ");
-  attroff(COLOR_PAIR(color));
-  if (inverse) attroff(A_REVERSE);
+  put(row, 2 * col, "  ", Cell{' ', static_cast<uint8_t>(color), inverse,
+                               false});
 }
 
 // ____________________________________________________________________________
 void TerminalManager::refresh() {
+  std::vector<char> run(width_ + 1);
+  for (int row = 0; row < numRows_; ++row) {
+    const Cell* shown = &shown_[row * width_];
+    const Cell* drawn = &drawn_[row * width_];
+    int col = 0;
+    while (col < width_) {
+      if (shown[col] == drawn[col]) {
+        ++col;
+        continue;
+      }
+      // A run of changed cells that look the same is sent at once.
+      const int start = col;
+      int length = 0;
+      while (col < width_ && shown[col] != drawn[col]
+             && drawn[col].looksLike(drawn[start])) {
+        run[length++] = drawn[col++].symbol;
+      }
+      run[length] = '\0';
+      attr_t attributes = COLOR_PAIR(drawn[start].color);
+      if (drawn[start].inverse) { attributes |= A_REVERSE; }
+      if (drawn[start].bold) { attributes |= A_BOLD; }
+      attrset(attributes);
+      mvaddnstr(row, start, run.data(), length);
+      numCharsSent_ += length;
+    }
+  }
+  attrset(A_NORMAL);
+  shown_ = drawn_;
   ::refresh();
 }
 
 // ___________________________________________________________________________
 void TerminalManager::drawString(int row, int col, const char* output,
                                  int color, bool bold) {
-  attron(COLOR_PAIR(color));
-  if (bold) { attron(A_BOLD); }
-  mvaddstr(row, 2 * col, output);
-  if (bold) { attroff(A_BOLD); }
-  attroff(COLOR_PAIR(color));
+  put(row, 2 * col, output, Cell{' ', static_cast<uint8_t>(color), false,
+                                 bold});
 }
 
 // ___________________________________________________________________________
 void TerminalManager::drawChar(int row, int col, const char* output,
                                               int color, bool bold) {
-  attron(COLOR_PAIR(color));
-  if (bold) { attron(A_BOLD); }
-  mvprintw(row, 2 * col, output);
-  if (bold) { attroff(A_BOLD); }
-  attroff(COLOR_PAIR(color));
+  drawString(row, col, output, color, bold);
 }
 
 // ___________________________________________________________________________
 void TerminalManager::drawBox(int row, int col, int color) {
-  drawPixel(row - 1, col - 1, false, color);
-  drawPixel(row - 1, col, false, color);
-  drawPixel(row - 1, col + 1, false, color);
-  drawPixel(row, col - 1, false, color);
-  drawPixel(row, col, false, color);
-  drawPixel(row, col + 1, false, color);
-  drawPixel(row + 1, col - 1, false, color);
-  drawPixel(row + 1, col, false, color);
-  drawPixel(row + 1, col + 1, false, color);
+  // three pixels in each of three rows
+  const Cell look{' ', static_cast<uint8_t>(color), false, false};
+  for (int i = -1; i <= 1; ++i) {
+    put(row + i, 2 * (col - 1), "      ", look);
+  }
 }
 
 // ___________________________________________________________________________
 UserInput TerminalManager::getUserInput() {
   UserInput userInput;
-  userInput.keycode_ = getch();
+  userInput.keycode_ = wgetch(static_cast<WINDOW*>(input_));
   userInput.isMouseclick_ = false;
   if (userInput.keycode_ == KEY_MOUSE) {
     MEVENT mouseEvent;
@@ -105,3 +152,9 @@ UserInput TerminalManager::getUserInput() {
   return userInput;
 }
 
+
+// ___________________________________________________________________________
+bool TerminalManager::waitForInput(int timeoutMs) {
+  pollfd input = {STDIN_FILENO, POLLIN, 0};
+  return poll(&input, 1, timeoutMs) > 0;
+}
@@ -10,60 +10,81 @@
 #define TERMINALMANAGER_H_
 
 #include <cstddef>
-
-// Class for the input from the user.
-class UserInput {
- public:
-  // The code of the key pressed.
-  int keycode_;
-  // Was the event a mousecklick.
-  bool isMouseclick_;
-  // If the event was a mousecklick, then the coordinates
-  // of the mouseclick are stored here.
-  int mouseX_ = -1;
-  int mouseY_ = -1;
-};
+#include <cstdint>
+#include <vector>
+#include "./Screen.h"
 
 // A class managing the input and output via the terminal, using ncurses.
-class TerminalManager {
+// Drawing only changes an off-screen copy of the screen; refresh() sends the
+// characters that changed since the last refresh to the terminal, in runs
+// of equal attributes.
+class TerminalManager : public Screen {
  public:
   // Constructor: initialize the terminal for use with ncurses.
   TerminalManager();
 
   // Destructor: Clean up the screen.
-  ~TerminalManager();
+  ~TerminalManager() override;
 
-  // Get input from the user.
-  UserInput getUserInput();
+  // See Screen.
+  UserInput getUserInput() override;
+  bool waitForInput(int timeoutMs) override;
+  void drawPixel(int row, int col, bool inverse, int color) override;
+  void drawString(int row, int col, const char* output, int color,
+                  bool bold = true) override;
+  void drawChar(int row, int col, const char* output, int color,
+                bool bold = true) override;
+  void drawBox(int row, int col, int color) override;
+  void refresh() override;
 
-  // Draw a "pixel" at the given position with the given color.
-  // 1 = White, 2 = Green, 3 = Magenta.
-  void drawPixel(int row, int col, bool inverse, int color);
+  // End the use of ncurses and restore the terminal.
+  void close() override;
 
-  // Draw a string at the given position and with the given color.
-  // 1 = White, 2 = Green, 3 = Magenta.
-  void drawString(int row, int col, const char* output, int color,
-                                                  bool bold = true);
+  // Number of characters sent to the terminal by all refreshes so far.
+  size_t numCharsSent() const { return numCharsSent_; }
 
-  // Draw a single char at the given position
-  // and with the given color. 1 = White, 2 = Green, 3 = Magenta.
-  void drawChar(int row, int col, const char*, int color,
-                                                bool bold = true);
+  int numRows() const override { return numRows_; }
+  int numCols() const override { return numCols_; }
 
-  // Draw a "box" at given location with given color.
-  void drawBox(int row, int col, int color);
+ private:
+  // A character on the screen and how it looks.
+  struct Cell {
+    char symbol;
+    uint8_t color;
+    bool inverse;
+    bool bold;
 
-  // Refresh the screen.
-  void refresh();
+    bool operator==(const Cell& other) const {
+      return symbol == other.symbol && color == other.color
+             && inverse == other.inverse && bold == other.bold;
+    }
+    bool operator!=(const Cell& other) const { return !(*this == other); }
+    // Return true if the cell has the same attributes as the other one.
+    bool looksLike(const Cell& other) const {
+      return color == other.color && inverse == other.inverse
+             && bold == other.bold;
+    }
+  };
 
-  // Get the dimensions of the screen.
-  int numRows() const { return numRows_; }
-  int numCols() const { return numCols_; }
+  // Put the given text into the cells of the given row from the given
+  // terminal column on, as far as it fits on the screen.
+  void put(int row, int column, const char* text, const Cell& look);
 
- private:
   // The number of "logical" rows and columns of the screen.
   int numRows_;
   int numCols_;
+
+  // The characters of the terminal, row by row: as last sent to the
+  // terminal and as drawn since.
+  int width_;
+  std::vector<Cell> shown_;
+  std::vector<Cell> drawn_;
+  size_t numCharsSent_;
+
+  // Window that input is read from. It is never drawn on, so reading doesn't
+  // refresh the screen like reading from the standard screen would; the
+  // screen only changes on refresh().
+  void* input_;
 };
 
 #endif  // TERMINALMANAGER_H_
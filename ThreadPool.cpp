@@ -0,0 +1,118 @@
+// Copyright 2022 Henrik Roth
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "./ThreadPool.h"
+
+namespace {
+// Pool and id of the worker running on this thread, if any.
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local int currentId = 0;
+}  // namespace
+
+// ____________________________________________________________________________
+ThreadPool::ThreadPool(int numThreads) : numQueued_(0), stop_(false) {
+  if (numThreads <= 0) {
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (int i = 0; i < numThreads; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  // queue 0 belongs to the calling threads
+  for (int i = 1; i < numThreads; ++i) {
+    workers_.emplace_back(&ThreadPool::work, this, i);
+  }
+}
+
+// ____________________________________________________________________________
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    stop_ = true;
+  }
+  wakeUp_.notify_all();
+  for (std::thread& worker : workers_) { worker.join(); }
+}
+
+// ____________________________________________________________________________
+int ThreadPool::threadId() const {
+  return currentPool == this ? currentId : 0;
+}
+
+// ____________________________________________________________________________
+void ThreadPool::parallelFor(size_t n, size_t grain,
+                             const std::function<void(size_t, size_t)>& body) {
+  if (n == 0) { return; }
+  grain = std::max<size_t>(1, grain);
+  const size_t numTasks = (n + grain - 1) / grain;
+  if (numTasks == 1 || queues_.size() == 1) {
+    for (size_t begin = 0; begin < n; begin += grain) {
+      body(begin, std::min(n, begin + grain));
+    }
+    return;
+  }
+  // Deal the ranges out to all queues, the own queue gets the first ones.
+  std::atomic<size_t> pending(numTasks);
+  const int self = threadId();
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    numQueued_ += numTasks;
+  }
+  for (size_t t = 0; t < numTasks; ++t) {
+    const int q = (self + t * queues_.size() / numTasks) % queues_.size();
+    Task task = {&body, t * grain, std::min(n, (t + 1) * grain), &pending};
+    std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+    queues_[q]->tasks.push_front(task);
+  }
+  wakeUp_.notify_all();
+  // Help until every range is done, stolen ranges may still be running.
+  while (pending.load(std::memory_order_acquire) > 0) {
+    if (!runTask(self)) { std::this_thread::yield(); }
+  }
+}
+
+// ____________________________________________________________________________
+bool ThreadPool::runTask(int id) {
+  Task task;
+  bool found = false;
+  {
+    std::lock_guard<std::mutex> lock(queues_[id]->mutex);
+    if (!queues_[id]->tasks.empty()) {
+      task = queues_[id]->tasks.back();
+      queues_[id]->tasks.pop_back();
+      found = true;
+    }
+  }
+  for (size_t i = 1; !found && i < queues_.size(); ++i) {
+    Queue& victim = *queues_[(id + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = victim.tasks.front();
+      victim.tasks.pop_front();
+      found = true;
+    }
+  }
+  if (!found) { return false; }
+  --numQueued_;
+  (*task.body)(task.begin, task.end);
+  task.pending->fetch_sub(1, std::memory_order_release);
+  return true;
+}
+
+// ____________________________________________________________________________
+void ThreadPool::work(int id) {
+  currentPool = this;
+  currentId = id;
+  while (true) {
+    if (runTask(id)) { continue; }
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    wakeUp_.wait(lock, [this]() { return stop_ || numQueued_ > 0; });
+    if (stop_) { return; }
+  }
+}
@@ -0,0 +1,78 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool of worker threads with one task queue per thread. A thread takes
+// tasks from the back of its own queue and, when that is empty, steals
+// from the front of the queues of the others, so uneven work spreads
+// itself over all threads. Tasks may start parallel work themselves; a
+// thread waiting for such work runs tasks in the meantime.
+class ThreadPool {
+ public:
+  // Start a pool in which numThreads threads work, including the thread
+  // that calls parallelFor. numThreads <= 0 means one per core.
+  explicit ThreadPool(int numThreads = 0);
+
+  // Stop and join all workers.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Call body(begin, end) for consecutive ranges of at most grain indices
+  // that together cover [0, n), in parallel, and return when all calls
+  // returned.
+  void parallelFor(size_t n, size_t grain,
+                   const std::function<void(size_t, size_t)>& body);
+
+  // Number of threads that work on tasks.
+  int numThreads() const { return queues_.size(); }
+
+ private:
+  // A range of a parallelFor and the counter of its unfinished ranges.
+  struct Task {
+    const std::function<void(size_t, size_t)>* body;
+    size_t begin;
+    size_t end;
+    std::atomic<size_t>* pending;
+  };
+
+  // Task queue of one thread.
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // Loop of the worker with the given id.
+  void work(int id);
+
+  // Run one task, from the own queue or stolen from another one. Return
+  // false if there was no task.
+  bool runTask(int id);
+
+  // Id of the calling thread in this pool. Threads that don't belong to the
+  // pool use the queue of the caller (id 0).
+  int threadId() const;
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+
+  // Workers sleep on this condition while no task is queued.
+  std::mutex sleepMutex_;
+  std::condition_variable wakeUp_;
+  std::atomic<size_t> numQueued_;
+  bool stop_;
+};
+
+#endif  // THREADPOOL_H_
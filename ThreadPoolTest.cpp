@@ -0,0 +1,33 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+#include "./ThreadPool.h"
+
+
+TEST(ThreadPoolTest, parallelFor) {
+  for (int numThreads : {1, 2, 4}) {
+    ThreadPool pool(numThreads);
+    ASSERT_EQ(pool.numThreads(), numThreads);
+    std::vector<int> visits(1000, 0);
+    pool.parallelFor(visits.size(), 7, [&](size_t begin, size_t end) {
+      ASSERT_LE(end - begin, 7);
+      for (size_t i = begin; i < end; ++i) { ++visits[i]; }
+    });
+    for (int v : visits) { ASSERT_EQ(v, 1); }
+    // nothing to do
+    pool.parallelFor(0, 7, [&](size_t, size_t) { FAIL(); });
+  }
+}
+
+TEST(ThreadPoolTest, nested) {
+  ThreadPool pool(3);
+  std::atomic<int> sum(0);
+  pool.parallelFor(10, 1, [&](size_t begin, size_t end) {
+    pool.parallelFor(100, 3, [&](size_t innerBegin, size_t innerEnd) {
+      sum += (end - begin) * (innerEnd - innerBegin);
+    });
+  });
+  ASSERT_EQ(sum, 1000);
+}
@@ -0,0 +1,240 @@
+// Copyright 2022 Henrik Roth
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "./EquationIndex.h"
+#include "./EquationRules.h"
+#include "./EquationValidator.h"
+#include "./Metrics.h"
+#include "./Variant.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Time to generate an equation, and left sides that were tried and
+// rejected per generated equation.
+const int kGenerateTime = Metrics::histogram(
+    "nerdle_generate_ns", "Time to generate the equation of a game in ns");
+const int kRejections = Metrics::histogram(
+    "nerdle_generate_rejections", "Rejected tries per generated equation");
+const int kRejectionsTotal = Metrics::counter(
+    "nerdle_generate_rejections_total", "Rejected tries of all equations");
+
+#if defined(__SSE2__)
+// Return the Length symbols at eq in the lowest bytes of a register, the
+// other bytes zero. Loads them as two integers, since a 16 byte load of a
+// zero-padded copy would wait for the copy to be stored.
+template <int Length>
+__m128i loadCells(const char* eq) {
+  static_assert(Length <= 16, "an equation must fit into a register");
+  constexpr int kLow = Length < 8 ? Length : 8;
+  uint64_t low = 0;
+  uint64_t high = 0;
+  memcpy(&low, eq, kLow);
+  memcpy(&high, eq + kLow, Length - kLow);
+  return _mm_set_epi64x(high, low);
+}
+#endif
+
+// Return every legal equation of the given length with at most 4 symbols
+// left of the equal sign, by trying all such left sides. Fast enough for
+// the Mini variant only.
+template <int Length>
+std::vector<std::string> enumerateShort() {
+  static_assert(Length <= 6, "too many left sides to try");
+  const std::string symbols = "0123456789+-*/";
+  std::vector<std::string> equations;
+  for (int leftLength = 3; leftLength <= Length - 2; ++leftLength) {
+    std::string left(leftLength, '0');
+    int numLeftSides = 1;
+    for (int i = 0; i < leftLength; ++i) { numLeftSides *= symbols.size(); }
+    for (int n = 0; n < numLeftSides; ++n) {
+      for (int i = 0, rest = n; i < leftLength; ++i, rest /= symbols.size()) {
+        left[leftLength - 1 - i] = symbols[rest % symbols.size()];
+      }
+      const int64_t value = EquationRules::compute(left);
+      if (value < 0) { continue; }
+      const std::string eq = left + "=" + std::to_string(value);
+      if (EquationRules::isLegal(eq.data(), eq.size(), Length)) {
+        equations.push_back(eq);
+      }
+    }
+  }
+  return equations;
+}
+
+// Return a random legal equation of the given length: build random left
+// sides that follow the grammar until one has a legal value that fills the
+// rest of the equation.
+template <int Length>
+std::string sample(Random* random) {
+  const auto start = std::chrono::steady_clock::now();
+  const char operations[] = "+-*/";
+  char eq[Length + 1];
+  for (uint64_t numRejected = 0;; ++numRejected) {
+    // between 3 symbols and all but "=x"
+    const int leftLength = 3 + random->uniform(Length - 4);
+    bool inNumber = false;
+    bool zero = false;  // the current number is a zero, nothing may follow
+    bool ok = true;
+    for (int i = 0; ok && i < leftLength; ++i) {
+      const bool last = i == leftLength - 1;
+      if (!inNumber) {
+        eq[i] = '0' + random->uniform(10);
+        zero = eq[i] == '0';
+        inNumber = true;
+      } else if (!last && (zero || random->uniform(3) == 0)) {
+        eq[i] = operations[random->uniform(4)];
+        inNumber = false;
+      } else {
+        ok = !zero;
+        eq[i] = '0' + random->uniform(10);
+      }
+    }
+    if (!ok) { continue; }
+    const int64_t value = EquationRules::compute(eq, leftLength);
+    if (value < 0) { continue; }
+    const std::string right = std::to_string(value);
+    if (leftLength + 1 + static_cast<int>(right.size()) != Length) {
+      continue;
+    }
+    eq[leftLength] = '=';
+    right.copy(eq + leftLength + 1, right.size());
+    if (EquationRules::isLegal(eq, Length, Length)) {
+      Metrics::recordSince(kGenerateTime, start);
+      Metrics::record(kRejections, numRejected);
+      Metrics::add(kRejectionsTotal, numRejected);
+      return std::string(eq, Length);
+    }
+  }
+}
+}  // namespace
+
+// ____________________________________________________________________________
+template <int Length, int Rows>
+bool Variant<Length, Rows>::isSyntactic(const char* eq) {
+  return EquationRules::isSyntactic(eq, Length, Length);
+}
+
+// The classic automaton is faster than the generic rules.
+template <>
+bool Variant<8, 6>::isSyntactic(const char* eq) {
+  return EquationValidator::isSyntactic(eq);
+}
+
+// ____________________________________________________________________________
+template <int Length, int Rows>
+bool Variant<Length, Rows>::isCorrect(const char* eq) {
+  // The same for syntactic equations, but in a single pass.
+  return EquationRules::isLegal(eq, Length, Length);
+}
+
+// ____________________________________________________________________________
+template <int Length, int Rows>
+void Variant<Length, Rows>::compare(const char* guess, const char* answer,
+                                    char* highlight) {
+  // Cell i of the guess is magenta if it isn't green and the answer has
+  // more non-green cells with its symbol than there are non-green cells
+  // with it left of cell i in the guess, which got magenta first.
+#if defined(__SSE2__)
+  // Compare the symbol of cell i with all cells of the answer at once, as a
+  // bit mask, and mark the first matching cell as taken.
+  const __m128i guessCells = loadCells<Length>(guess);
+  const __m128i answerCells = loadCells<Length>(answer);
+  const unsigned green = _mm_movemask_epi8(_mm_cmpeq_epi8(guessCells,
+                                                          answerCells));
+  unsigned available = ~green & ((1u << Length) - 1);
+#pragma GCC unroll 16
+  for (int i = 0; i < Length; ++i) {
+    const unsigned matching = _mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_set1_epi8(guess[i]), answerCells)) & available;
+    // without branches, which random feedback would mispredict
+    const unsigned isGreen = green >> i & 1;
+    const unsigned magenta = (isGreen ^ 1) & (matching != 0);
+    available &= ~(matching & -matching & -magenta);
+    highlight[i] = '1' + isGreen + 2 * magenta;
+  }
+#else
+  bool green[Length];
+#pragma GCC unroll 12
+  for (int i = 0; i < Length; ++i) { green[i] = guess[i] == answer[i]; }
+#pragma GCC unroll 12
+  for (int i = 0; i < Length; ++i) {
+    int available = 0;
+    int taken = 0;
+#pragma GCC unroll 12
+    for (int k = 0; k < Length; ++k) {
+      available += !green[k] && answer[k] == guess[i];
+      taken += k < i && !green[k] && guess[k] == guess[i];
+    }
+    highlight[i] = green[i] ? '2' : available > taken ? '3' : '1';
+  }
+#endif
+}
+
+// ____________________________________________________________________________
+template <int Length, int Rows>
+std::string Variant<Length, Rows>::generate(Random* random) {
+  return sample<Length>(random);
+}
+
+// Mini: all equations are known after trying every left side once.
+template <>
+std::string Variant<6, 6>::generate(Random* random) {
+  const auto start = std::chrono::steady_clock::now();
+  static const std::vector<std::string> equations = enumerateShort<6>();
+  std::string equation = equations[random->uniform(equations.size())];
+  Metrics::recordSince(kGenerateTime, start);
+  Metrics::record(kRejections, 0);
+  return equation;
+}
+
+// Classic: the same draw as Nerdle::generateEquation always made.
+template <>
+std::string Variant<8, 6>::generate(Random* random) {
+  const auto start = std::chrono::steady_clock::now();
+  const EquationIndex& index = EquationIndex::classic();
+  std::string equation = index.equation(random->uniform(index.size()));
+  Metrics::recordSince(kGenerateTime, start);
+  Metrics::record(kRejections, 0);
+  return equation;
+}
+
+template class Variant<6, 6>;
+template class Variant<8, 6>;
+template class Variant<10, 6>;
+template class Variant<12, 6>;
+
+namespace {
+// Return the rules of the given variant.
+template <class V>
+constexpr VariantRules rulesOf(const char* name) {
+  return {name, V::kLength, V::kRows, V::kBoardRows, V::kBoardCols,
+          &V::isSyntactic, &V::isCorrect, &V::compare, &V::generate};
+}
+
+constexpr VariantRules kVariants[] = {
+    rulesOf<MiniVariant>("mini"), rulesOf<ClassicVariant>("classic"),
+    rulesOf<MaxiVariant>("maxi"), rulesOf<Maxi12Variant>("maxi12")};
+}  // namespace
+
+// ____________________________________________________________________________
+const VariantRules* VariantRules::forLength(int length) {
+  for (const VariantRules& rules : kVariants) {
+    if (rules.length == length) { return &rules; }
+  }
+  return nullptr;
+}
+
+// ____________________________________________________________________________
+const VariantRules* VariantRules::forName(const char* name) {
+  for (const VariantRules& rules : kVariants) {
+    if (strcmp(rules.name, name) == 0) { return &rules; }
+  }
+  return nullptr;
+}
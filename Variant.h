@@ -0,0 +1,84 @@
+// Copyright 2022 Henrik Roth
+
+#ifndef VARIANT_H_
+#define VARIANT_H_
+
+#include <cstdint>
+#include <string>
+#include "./Random.h"
+
+// The rules of a game variant with equations of Length symbols and Rows
+// guesses: Mini (6), Classic (8) and Maxi (10 and 12). Every variant is its
+// own instantiation, so loops over the symbols of an equation have a fixed
+// number of iterations and are unrolled, and all storage has a fixed size.
+// Values are computed in 64 bits, which the longer variants need.
+template <int Length, int Rows>
+class Variant {
+ public:
+  static constexpr int kLength = Length;
+  static constexpr int kRows = Rows;
+
+  // Size of the board on the screen, see Nerdle::drawBoard: a box every 4
+  // columns and every 5 rows, framed and with room for messages below.
+  static constexpr int kBoardRows = 5 * Rows + 6;
+  static constexpr int kBoardCols = 4 * Length + 7;
+
+  // Return true if the Length symbols at eq are a syntactically correct
+  // equation (see EquationRules::isSyntactic).
+  static bool isSyntactic(const char* eq);
+
+  // Return true if the values left and right of the equal sign of a
+  // syntactically correct equation of Length symbols are equal.
+  static bool isCorrect(const char* eq);
+
+  // Write the feedback on the guess to highlight, one symbol per cell like
+  // Nerdle::compareUserGuess: '1' = black, '2' = green, '3' = magenta.
+  // Guess and answer may consist of any characters.
+  static void compare(const char* guess, const char* answer,
+                      char* highlight);
+
+  // Return an equation the player must guess. Variants with few equations
+  // pick uniformly from all of them, the longer ones sample random left
+  // sides until one has a result of the right length.
+  static std::string generate(Random* random);
+};
+
+// Variants that differ from the generic rules, see Variant.cpp.
+template <> bool Variant<8, 6>::isSyntactic(const char* eq);
+template <> std::string Variant<6, 6>::generate(Random* random);
+template <> std::string Variant<8, 6>::generate(Random* random);
+
+// The variants are instantiated once, in Variant.cpp.
+extern template class Variant<6, 6>;
+extern template class Variant<8, 6>;
+extern template class Variant<10, 6>;
+extern template class Variant<12, 6>;
+
+using MiniVariant = Variant<6, 6>;
+using ClassicVariant = Variant<8, 6>;
+using MaxiVariant = Variant<10, 6>;
+using Maxi12Variant = Variant<12, 6>;
+
+// The rules of a variant as plain values and functions, so that the game
+// can pick one at runtime.
+struct VariantRules {
+  const char* name;  // f.e. "classic"
+  int length;
+  int rows;
+  int boardRows;
+  int boardCols;
+  bool (*isSyntactic)(const char* eq);
+  bool (*isCorrect)(const char* eq);
+  void (*compare)(const char* guess, const char* answer, char* highlight);
+  std::string (*generate)(Random* random);
+
+  // Return the rules of the variant with equations of the given length or
+  // nullptr if there is none.
+  static const VariantRules* forLength(int length);
+
+  // Return the rules of the variant with the given name: mini, classic,
+  // maxi or maxi12. Return nullptr if there is none.
+  static const VariantRules* forName(const char* name);
+};
+
+#endif  // VARIANT_H_
@@ -0,0 +1,69 @@
+// Copyright 2022 Henrik Roth
+
+#include <gtest/gtest.h>
+#include <string>
+#include "./EquationIndex.h"
+#include "./EquationRules.h"
+#include "./Feedback.h"
+#include "./Metrics.h"
+#include "./PackedEquation.h"
+#include "./Random.h"
+#include "./Variant.h"
+
+
+TEST(VariantTest, rules) {
+  ASSERT_EQ(ClassicVariant::kBoardRows, 36);
+  ASSERT_EQ(ClassicVariant::kBoardCols, 39);
+  ASSERT_EQ(VariantRules::forLength(6)->length, 6);
+  ASSERT_EQ(VariantRules::forLength(8)->boardCols, 39);
+  ASSERT_EQ(VariantRules::forLength(12)->boardCols, 55);
+  ASSERT_EQ(VariantRules::forLength(7), nullptr);
+  ASSERT_EQ(VariantRules::forName("maxi")->length, 10);
+  ASSERT_EQ(VariantRules::forName("giant"), nullptr);
+  ASSERT_TRUE(MiniVariant::isSyntactic("4*3=12"));
+  ASSERT_TRUE(MiniVariant::isCorrect("4*3=12"));
+  ASSERT_FALSE(MiniVariant::isCorrect("4*3=13"));
+  ASSERT_FALSE(MiniVariant::isSyntactic("4*3=012"));
+  ASSERT_TRUE(MaxiVariant::isSyntactic("9*45+5=410"));
+  ASSERT_TRUE(MaxiVariant::isCorrect("9*45+5=410"));
+  ASSERT_FALSE(MaxiVariant::isSyntactic("12*34=408+"));
+}
+
+TEST(VariantTest, generate) {
+  Random random(7);
+  for (int length : {6, 8, 10, 12}) {
+    const VariantRules* rules = VariantRules::forLength(length);
+    for (int i = 0; i < 100; ++i) {
+      std::string eq = rules->generate(&random);
+      ASSERT_EQ(eq.length(), static_cast<size_t>(length));
+      ASSERT_TRUE(EquationRules::isLegal(eq.data(), eq.length(), length))
+          << eq;
+      ASSERT_TRUE(rules->isSyntactic(eq.data()) && rules->isCorrect(eq.data()))
+          << eq;
+    }
+  }
+  // The long variants reject most random left sides; the metrics tell how
+  // many per equation.
+  ASSERT_GT(Metrics::total("nerdle_generate_rejections_total"), 200u);
+  ASSERT_GT(Metrics::quantile("nerdle_generate_rejections", 0.9), 0u);
+  ASSERT_GT(Metrics::quantile("nerdle_generate_ns", 0.5), 0u);
+}
+
+TEST(VariantTest, compare) {
+  // The feedback of the classic variant matches the packed one.
+  const EquationIndex& index = EquationIndex::classic();
+  Random random(11);
+  char highlight[ClassicVariant::kLength];
+  for (int i = 0; i < 10000; ++i) {
+    std::string guess = index.equation(random.uniform(index.size()));
+    std::string answer = index.equation(random.uniform(index.size()));
+    ClassicVariant::compare(guess.data(), answer.data(), highlight);
+    ASSERT_EQ(std::string(highlight, ClassicVariant::kLength),
+              Feedback::highlight(Feedback::pattern(
+                  PackedEquation::pack(&guess), PackedEquation::pack(&answer))))
+        << guess << " " << answer;
+  }
+  char mini[MiniVariant::kLength];
+  MiniVariant::compare("1+1=2+", "2+2=4+", mini);
+  ASSERT_EQ(std::string(mini, MiniVariant::kLength), "121232");
+}